@@ -0,0 +1,39 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef PUGL_EGL_HPP
+#define PUGL_EGL_HPP
+
+#include "pugl/egl.h"
+#include "pugl/pugl.h"
+
+namespace pugl {
+
+/**
+   @defgroup eglpp EGL
+   OpenGL graphics support via EGL.
+   @ingroup puglpp
+   @{
+*/
+
+/// @copydoc puglEglBackend
+inline const PuglBackend*
+eglBackend() noexcept
+{
+  return puglEglBackend();
+}
+
+/// @copydoc puglEglOffscreenBackend
+inline const PuglBackend*
+eglOffscreenBackend() noexcept
+{
+  return puglEglOffscreenBackend();
+}
+
+/**
+   @}
+*/
+
+} // namespace pugl
+
+#endif // PUGL_EGL_HPP
@@ -27,6 +27,40 @@ getProcAddress(const char* name) noexcept
   return puglGetProcAddress(name);
 }
 
+/// @copydoc puglGetBufferAge
+inline unsigned
+getBufferAge(View& view) noexcept
+{
+  return puglGetBufferAge(view.cobj());
+}
+
+/// @copydoc PuglFrameTiming
+using FrameTiming = PuglFrameTiming;
+
+/// @copydoc puglGetFrameTiming
+inline Status
+getFrameTiming(View& view, FrameTiming& timing) noexcept
+{
+  return static_cast<Status>(puglGetFrameTiming(view.cobj(), &timing));
+}
+
+/// @copydoc PuglDrawTiming
+using DrawTiming = PuglDrawTiming;
+
+/// @copydoc puglGetDrawTiming
+inline Status
+getDrawTiming(View& view, DrawTiming& timing) noexcept
+{
+  return static_cast<Status>(puglGetDrawTiming(view.cobj(), &timing));
+}
+
+/// @copydoc puglSetShareView
+inline Status
+setShareView(View& view, View& shareView) noexcept
+{
+  return static_cast<Status>(puglSetShareView(view.cobj(), shareView.cobj()));
+}
+
 /// @copydoc puglEnterContext
 inline Status
 enterContext(View& view) noexcept
@@ -0,0 +1,34 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef PUGL_PIXELS_HPP
+#define PUGL_PIXELS_HPP
+
+#include "pugl/pixels.h"
+#include "pugl/pugl.h"
+
+namespace pugl {
+
+/**
+   @defgroup pixelspp Pixels
+   Raw pixel buffer support.
+   @ingroup puglpp
+   @{
+*/
+
+using PixelBuffer = PuglPixelBuffer; ///< @copydoc PuglPixelBuffer
+
+/// @copydoc puglPixelsBackend
+inline const PuglBackend*
+pixelsBackend() noexcept
+{
+  return puglPixelsBackend();
+}
+
+/**
+   @}
+*/
+
+} // namespace pugl
+
+#endif // PUGL_PIXELS_HPP
@@ -237,6 +237,20 @@ static_assert(WorldFlag(PUGL_WORLD_THREADS) == WorldFlag::threads, "");
 
 using WorldFlags = PuglWorldFlags; ///< @copydoc PuglWorldFlags
 
+using Allocator = PuglAllocator; ///< @copydoc PuglAllocator
+
+/// @copydoc PuglLogLevel
+enum class LogLevel {
+  err     = PUGL_LOG_LEVEL_ERR,     ///< @copydoc PUGL_LOG_LEVEL_ERR
+  warning = PUGL_LOG_LEVEL_WARNING, ///< @copydoc PUGL_LOG_LEVEL_WARNING
+  info    = PUGL_LOG_LEVEL_INFO,    ///< @copydoc PUGL_LOG_LEVEL_INFO
+  debug   = PUGL_LOG_LEVEL_DEBUG,   ///< @copydoc PUGL_LOG_LEVEL_DEBUG
+};
+
+static_assert(LogLevel(PUGL_LOG_LEVEL_DEBUG) == LogLevel::debug, "");
+
+using LogFunc = PuglLogFunc; ///< @copydoc PuglLogFunc
+
 #if defined(PUGL_HPP_THROW_FAILED_CONSTRUCTION)
 
 /// An exception thrown when construction fails
@@ -302,6 +316,15 @@ public:
     PUGL_CHECK_CONSTRUCTION(cobj(), "Failed to create pugl::World");
   }
 
+  /// @copydoc puglNewWorldWithAllocator
+  World(WorldType type, WorldFlags flags, const Allocator& allocator)
+    : Wrapper{puglNewWorldWithAllocator(static_cast<PuglWorldType>(type),
+                                        flags,
+                                        &allocator)}
+  {
+    PUGL_CHECK_CONSTRUCTION(cobj(), "Failed to create pugl::World");
+  }
+
   explicit World(WorldType type)
     : World{type, WorldFlags{}}
   {}
@@ -315,6 +338,12 @@ public:
     return static_cast<Status>(puglSetClassName(cobj(), name));
   }
 
+  /// @copydoc puglSetLogFunc
+  void setLogFunc(const LogFunc logFunc) noexcept
+  {
+    puglSetLogFunc(cobj(), logFunc);
+  }
+
   /// @copydoc puglGetTime
   double time() const noexcept { return puglGetTime(cobj()); }
 
@@ -323,6 +352,27 @@ public:
   {
     return static_cast<Status>(puglUpdate(cobj(), timeout));
   }
+
+  /// @copydoc puglPrepareUpdate
+  Status prepareUpdate(double& timeout) noexcept
+  {
+    return static_cast<Status>(puglPrepareUpdate(cobj(), &timeout));
+  }
+
+  /// @copydoc puglGetUpdateFds
+  size_t updateFds(int* const fds, const size_t maxFds) const noexcept
+  {
+    return puglGetUpdateFds(cobj(), fds, maxFds);
+  }
+
+  /// @copydoc puglCheckUpdate
+  bool checkUpdate() noexcept { return puglCheckUpdate(cobj()); }
+
+  /// @copydoc puglDispatchUpdate
+  Status dispatchUpdate() noexcept
+  {
+    return static_cast<Status>(puglDispatchUpdate(cobj()));
+  }
 };
 
 /**
@@ -361,9 +411,13 @@ enum class ViewHint {
   resizable,           ///< @copydoc PUGL_RESIZABLE
   ignoreKeyRepeat,     ///< @copydoc PUGL_IGNORE_KEY_REPEAT
   refreshRate,         ///< @copydoc PUGL_REFRESH_RATE
+  prefetchClipboard,   ///< @copydoc PUGL_PREFETCH_CLIPBOARD
+  adaptiveSwap,        ///< @copydoc PUGL_ADAPTIVE_SWAP
+  renderThread,        ///< @copydoc PUGL_RENDER_THREAD
+  drawTiming,          ///< @copydoc PUGL_DRAW_TIMING
 };
 
-static_assert(ViewHint(PUGL_REFRESH_RATE) == ViewHint::refreshRate, "");
+static_assert(ViewHint(PUGL_DRAW_TIMING) == ViewHint::drawTiming, "");
 
 using ViewHintValue = PuglViewHintValue; ///< @copydoc PuglViewHintValue
 
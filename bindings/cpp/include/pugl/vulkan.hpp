@@ -34,6 +34,12 @@ namespace pugl {
    @{
 */
 
+using VulkanInstanceFunctions =
+  PuglVulkanInstanceFunctions; ///< @copydoc PuglVulkanInstanceFunctions
+
+using VulkanDeviceFunctions =
+  PuglVulkanDeviceFunctions; ///< @copydoc PuglVulkanDeviceFunctions
+
 /// @copydoc PuglVulkanLoader
 class VulkanLoader final
   : public detail::Wrapper<PuglVulkanLoader, puglFreeVulkanLoader>
@@ -76,6 +82,24 @@ public:
     return cobj() ? puglGetDeviceProcAddrFunc(cobj()) : nullptr;
   }
 
+  /// @copydoc puglLoadVulkanInstanceFunctions
+  VkResult loadInstanceFunctions(
+    const VkInstance               instance,
+    VulkanInstanceFunctions* const functions) const noexcept
+  {
+    return cobj() ? puglLoadVulkanInstanceFunctions(cobj(), instance, functions)
+                  : VK_ERROR_INITIALIZATION_FAILED;
+  }
+
+  /// @copydoc puglLoadVulkanDeviceFunctions
+  VkResult loadDeviceFunctions(
+    const VkDevice               device,
+    VulkanDeviceFunctions* const functions) const noexcept
+  {
+    return cobj() ? puglLoadVulkanDeviceFunctions(cobj(), device, functions)
+                  : VK_ERROR_INITIALIZATION_FAILED;
+  }
+
   /// Return true if this loader is valid to use
   explicit operator bool() const noexcept { return cobj(); }
 };
@@ -139,6 +163,58 @@ createSurface(PFN_vkGetInstanceProcAddr          vkGetInstanceProcAddr,
   return (!r && !surface) ? VK_ERROR_INITIALIZATION_FAILED : r;
 }
 
+using SwapchainInfo  = PuglSwapchainInfo;  ///< @copydoc PuglSwapchainInfo
+using SwapchainImage = PuglSwapchainImage; ///< @copydoc PuglSwapchainImage
+
+/// @copydoc PuglSwapchain
+class Swapchain final
+  : public detail::Wrapper<PuglSwapchain, puglDestroySwapchain>
+{
+public:
+  /**
+     Create a swapchain for a view.
+
+     Note that this constructor does not throw exceptions, though failure is
+     possible.  The result of creation is written to `result`, and a failed
+     swapchain is explicitly convertible to `false`.
+  */
+  Swapchain(View& view, const SwapchainInfo& info, VkResult& result) noexcept
+    : Wrapper{create(view, info, result)}
+  {}
+
+  /// @copydoc puglGetSwapchainFormat
+  VkSurfaceFormatKHR format() const noexcept
+  {
+    return puglGetSwapchainFormat(cobj());
+  }
+
+  /// @copydoc puglAcquireSwapchainImage
+  VkResult acquire(SwapchainImage& image) noexcept
+  {
+    return puglAcquireSwapchainImage(cobj(), &image);
+  }
+
+  /// @copydoc puglPresentSwapchainImage
+  VkResult present(const SwapchainImage& image) noexcept
+  {
+    return puglPresentSwapchainImage(cobj(), &image);
+  }
+
+  /// Return true if this swapchain is valid to use
+  explicit operator bool() const noexcept { return cobj(); }
+
+private:
+  static PuglSwapchain* create(View&                view,
+                               const SwapchainInfo& info,
+                               VkResult&            result) noexcept
+  {
+    PuglSwapchain* swapchain = nullptr;
+
+    result = puglCreateSwapchain(view.cobj(), &info, &swapchain);
+    return swapchain;
+  }
+};
+
 /// @copydoc puglVulkanBackend
 inline const PuglBackend*
 vulkanBackend() noexcept
@@ -0,0 +1,192 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  A benchmark for drawing a Cairo view in tiles on several threads.
+
+  This draws a heavy scene, a dense grid of cells with many anti-aliased
+  curves over it, to a large view.  The scene is drawn for a fixed number of
+  frames with 1, 2, 4, and 8 threads, and the average time to draw a frame is
+  reported for each.
+
+  The number of frames to draw for each thread count can be given on the
+  command line.
+*/
+
+#include "test/test_utils.h"
+
+#include "pugl/cairo.h"
+#include "pugl/pugl.h"
+
+#include <cairo.h>
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const unsigned threadCounts[] = {1u, 2u, 4u, 8u};
+static const double   cellSize       = 4.0;
+static const unsigned numCurves      = 96u;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  unsigned        numFrames;
+  unsigned        framesDrawn;
+  bool            quit;
+} PuglTestApp;
+
+static void
+onDrawTile(PuglView* const              view,
+           void* const                  context,
+           const PuglExposeEvent* const tile)
+{
+  const PuglRect frame = puglGetFrame(view);
+  cairo_t* const cr    = (cairo_t*)context;
+
+  // Fill every cell in the tile with a colour, like a spectrogram
+  const int col0 = (int)(tile->x / cellSize);
+  const int row0 = (int)(tile->y / cellSize);
+  const int col1 = (int)ceil((tile->x + tile->width) / cellSize);
+  const int row1 = (int)ceil((tile->y + tile->height) / cellSize);
+  for (int row = row0; row < row1; ++row) {
+    for (int col = col0; col < col1; ++col) {
+      const double v = 0.5 + 0.5 * sin(col * 0.05) * cos(row * 0.07);
+
+      cairo_rectangle(cr, col * cellSize, row * cellSize, cellSize, cellSize);
+      cairo_set_source_rgb(cr, v, v * v, 1.0 - v);
+      cairo_fill(cr);
+    }
+  }
+
+  // Stroke curves across the whole view, which are clipped to the tile
+  cairo_set_line_width(cr, 1.5);
+  for (unsigned i = 0u; i < numCurves; ++i) {
+    const double y     = frame.height * (i + 0.5) / numCurves;
+    const double phase = i * 0.3;
+
+    cairo_move_to(cr, 0.0, y);
+    for (double x = 8.0; x < frame.width; x += 8.0) {
+      cairo_line_to(cr, x, y + 12.0 * sin(x * 0.02 + phase));
+    }
+
+    cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 0.5);
+    cairo_stroke(cr);
+  }
+}
+
+static PuglStatus
+onEvent(PuglView* view, const PuglEvent* event)
+{
+  PuglTestApp* const app = (PuglTestApp*)puglGetHandle(view);
+
+  printEvent(event, "Event: ", app->opts.verbose);
+
+  switch (event->type) {
+  case PUGL_EXPOSE:
+    ++app->framesDrawn;
+    break;
+  case PUGL_KEY_PRESS:
+    if (event->key.key == 'q' || event->key.key == PUGL_KEY_ESCAPE) {
+      app->quit = true;
+    }
+    break;
+  case PUGL_CLOSE:
+    app->quit = true;
+    break;
+  default:
+    break;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static int
+parseOptions(PuglTestApp* app, int argc, char** argv)
+{
+  char* endptr = NULL;
+
+  // Parse command line options
+  app->opts      = puglParseTestOptions(&argc, &argv);
+  app->numFrames = 60u;
+  if (app->opts.help) {
+    return 1;
+  }
+
+  // Parse number of frames, if given
+  if (argc >= 1) {
+    app->numFrames = (unsigned)strtoul(argv[0], &endptr, 10);
+    if (endptr != argv[0] + strlen(argv[0]) || !app->numFrames) {
+      logError("Invalid number of frames: %s\n", argv[0]);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTestApp app;
+  memset(&app, 0, sizeof(app));
+
+  if (parseOptions(&app, argc, argv)) {
+    puglPrintTestUsage("pugl_cairo_tile_benchmark", "[NUM_FRAMES]");
+    return 1;
+  }
+
+  app.world = puglNewWorld(PUGL_PROGRAM, 0);
+  app.view  = puglNewView(app.world);
+
+  puglSetClassName(app.world, "PuglCairoTileBenchmark");
+  puglSetWindowTitle(app.view, "Pugl Cairo Tile Benchmark");
+  puglSetSizeHint(app.view, PUGL_DEFAULT_SIZE, 1920, 1080);
+  puglSetBackend(app.view, puglCairoBackend());
+  puglSetHandle(app.view, &app);
+  puglSetEventFunc(app.view, onEvent);
+
+  PuglStatus st = PUGL_SUCCESS;
+  if ((st = puglRealize(app.view))) {
+    return logError("Failed to create window (%s)\n", puglStrerror(st));
+  }
+
+  puglShow(app.view);
+
+  // Draw the scene for a fixed number of frames with each number of threads
+  const size_t numCounts = sizeof(threadCounts) / sizeof(threadCounts[0]);
+  double       baseTime  = 0.0;
+  for (size_t i = 0u; i < numCounts && !app.quit; ++i) {
+    const unsigned numThreads = threadCounts[i];
+    if ((st = puglSetCairoTileFunc(app.view, onDrawTile, numThreads, 0u))) {
+      return logError("Failed to enable tiling (%s)\n", puglStrerror(st));
+    }
+
+    app.framesDrawn        = 0u;
+    const double startTime = puglGetTime(app.world);
+    while (app.framesDrawn < app.numFrames && !app.quit) {
+      puglPostRedisplay(app.view);
+      puglUpdate(app.world, 0.0);
+    }
+
+    const double elapsed    = puglGetTime(app.world) - startTime;
+    const double msPerFrame =1000.0 * elapsed / app.framesDrawn;
+    if (i == 0u) {
+      baseTime = msPerFrame;
+    }
+
+    fprintf(stderr,
+            "%u threads: %.2f ms per frame (%.2fx)\n",
+            numThreads,
+            msPerFrame,
+            baseTime / msPerFrame);
+  }
+
+  puglFreeView(app.view);
+  puglFreeWorld(app.world);
+
+  return 0;
+}
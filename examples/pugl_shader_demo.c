@@ -19,6 +19,10 @@
   rectangles can be given on the command line.  For reference, it begins to
   struggle to maintain 60 FPS on my machine (1950x + Vega64) with more than
   about 100000 rectangles.
+
+  If the environment variable PUGL_SHADER_CACHE is set to an existing
+  directory, linked program binaries are cached there, so that the program
+  can be loaded without compiling the shaders when the demo is next run.
 */
 
 #include "demo_utils.h"
@@ -307,8 +311,21 @@ setupGl(PuglTestApp* app)
     return PUGL_FAILURE;
   }
 
-  // Compile rectangle shaders and program
-  app->drawRect = compileProgram(headerSource, vertexSource, fragmentSource);
+  // Set up a program binary cache if a directory is given
+  const ProgramCache cache = initProgramCache(
+    getenv("PUGL_SHADER_CACHE"), (GLADloadproc)&puglGetProcAddress);
+
+  // Compile rectangle shaders and program (or load them from the cache)
+  const double compileStartTime = puglGetTime(app->world);
+  app->drawRect =
+    compileCachedProgram(&cache, headerSource, vertexSource, fragmentSource);
+  if (app->opts.verbose) {
+    fprintf(stderr,
+            "Set up program in %.2f ms (%s)\n",
+            (puglGetTime(app->world) - compileStartTime) * 1000.0,
+            cache.programBinary ? "with cache" : "without cache");
+  }
+
   free(fragmentSource);
   free(vertexSource);
   free(headerSource);
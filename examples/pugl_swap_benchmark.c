@@ -0,0 +1,192 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  A benchmark for presenting several OpenGL views at once.
+
+  This opens a number of top-level windows that are all redrawn continuously,
+  and reports the rate that frames are presented at.  With vertical sync
+  enabled (the default), this should stay close to the refresh rate of the
+  display regardless of the number of views, since only one swap per frame
+  waits for a refresh.
+
+  The number of views and the duration of the benchmark in seconds can be
+  given on the command line.  Without a duration, it runs until all windows
+  are closed and periodically prints the frame rate.
+*/
+
+#include "demo_utils.h"
+#include "test/test_utils.h"
+
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const unsigned maxViews = 64u;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView**      views;
+  PuglTestOptions opts;
+  unsigned        numViews;
+  unsigned        numOpenViews;
+  unsigned        numExposures;
+  double          duration;
+} PuglTestApp;
+
+static PuglStatus
+onEvent(PuglView* view, const PuglEvent* event)
+{
+  PuglWorld*   world = puglGetWorld(view);
+  PuglTestApp* app   = (PuglTestApp*)puglGetWorldHandle(world);
+
+  printEvent(event, "Event: ", app->opts.verbose);
+
+  switch (event->type) {
+  case PUGL_UPDATE:
+    puglPostRedisplay(view);
+    break;
+  case PUGL_EXPOSE:
+    // Draw a colour that changes every frame, so tearing or stalls are visible
+    glClearColor((float)(app->numExposures % 60u) / 60.0f, 0.2f, 0.4f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    ++app->numExposures;
+    break;
+  case PUGL_KEY_PRESS:
+    if (event->key.key == 'q' || event->key.key == PUGL_KEY_ESCAPE) {
+      app->numOpenViews = 0u;
+    }
+    break;
+  case PUGL_CLOSE:
+    puglHide(view);
+    --app->numOpenViews;
+    break;
+  default:
+    break;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static int
+parseOptions(PuglTestApp* app, int argc, char** argv)
+{
+  char* endptr = NULL;
+
+  // Parse command line options
+  app->opts     = puglParseTestOptions(&argc, &argv);
+  app->numViews = 3u;
+  if (app->opts.help) {
+    return 1;
+  }
+
+  // Enable vertical sync unless it was explicitly disabled
+  if (app->opts.sync == PUGL_DONT_CARE) {
+    app->opts.sync = 1;
+  }
+
+  // Parse number of views and duration, if given
+  if (argc >= 1) {
+    app->numViews = (unsigned)strtoul(argv[0], &endptr, 10);
+    if (endptr != argv[0] + strlen(argv[0]) || !app->numViews ||
+        app->numViews > maxViews) {
+      logError("Invalid number of views: %s\n", argv[0]);
+      return 1;
+    }
+  }
+
+  if (argc >= 2) {
+    app->duration = strtod(argv[1], &endptr);
+    if (endptr != argv[1] + strlen(argv[1]) || app->duration <= 0.0) {
+      logError("Invalid duration: %s\n", argv[1]);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTestApp app;
+  memset(&app, 0, sizeof(app));
+
+  if (parseOptions(&app, argc, argv)) {
+    puglPrintTestUsage("pugl_swap_benchmark", "[NUM_VIEWS] [SECONDS]");
+    return 1;
+  }
+
+  app.world = puglNewWorld(PUGL_PROGRAM, 0);
+  app.views = (PuglView**)calloc(app.numViews, sizeof(PuglView*));
+
+  puglSetWorldHandle(app.world, &app);
+  puglSetClassName(app.world, "PuglSwapBenchmark");
+
+  // Create and show all views
+  PuglStatus st = PUGL_SUCCESS;
+  for (unsigned i = 0u; i < app.numViews; ++i) {
+    PuglView* const view = puglNewView(app.world);
+
+    app.views[i] = view;
+    puglSetWindowTitle(view, "Pugl Swap Benchmark");
+    puglSetPosition(
+      view, (PuglCoord)(64u + 32u * i), (PuglCoord)(64u + 32u * i));
+    puglSetSizeHint(view, PUGL_DEFAULT_SIZE, 256, 256);
+    puglSetBackend(view, puglGlBackend());
+    puglSetViewHint(view, PUGL_USE_DEBUG_CONTEXT, app.opts.errorChecking);
+    puglSetViewHint(view, PUGL_SAMPLES, app.opts.samples);
+    puglSetViewHint(view, PUGL_DOUBLE_BUFFER, app.opts.doubleBuffer);
+    puglSetViewHint(view, PUGL_SWAP_INTERVAL, app.opts.sync);
+    puglSetEventFunc(view, onEvent);
+
+    if ((st = puglRealize(view))) {
+      return logError("Failed to create window (%s)\n", puglStrerror(st));
+    }
+
+    puglShow(view);
+  }
+
+  // Redraw continuously and measure how many frames are presented
+  app.numOpenViews = app.numViews;
+
+  const double   startTime   = puglGetTime(app.world);
+  PuglFpsPrinter fpsPrinter  = {startTime};
+  unsigned       framesDrawn = 0u;
+  unsigned       totalFrames = 0u;
+  while (app.numOpenViews) {
+    puglUpdate(app.world, 0.0);
+    ++framesDrawn;
+    ++totalFrames;
+
+    const double elapsed = puglGetTime(app.world) - startTime;
+    if (app.duration > 0.0 && elapsed >= app.duration) {
+      break;
+    }
+
+    puglPrintFps(app.world, &fpsPrinter, &framesDrawn);
+  }
+
+  // Print the overall average rate
+  const double elapsed = puglGetTime(app.world) - startTime;
+  fprintf(stderr,
+          "%u views: %.2f FPS (%u frames, %u exposures in %.2f seconds)\n",
+          app.numViews,
+          totalFrames / elapsed,
+          totalFrames,
+          app.numExposures,
+          elapsed);
+
+  for (unsigned i = 0u; i < app.numViews; ++i) {
+    puglFreeView(app.views[i]);
+  }
+
+  free(app.views);
+  puglFreeWorld(app.world);
+
+  return 0;
+}
@@ -1,4 +1,4 @@
-// Copyright 2019-2020 David Robillard <d@drobilla.net>
+// Copyright 2019-2022 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #ifndef EXAMPLES_SHADER_UTILS_H
@@ -6,16 +6,77 @@
 
 #include "glad/glad.h"
 
+#include <inttypes.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// From GL_ARB_get_program_binary (core since OpenGL 4.1)
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#  define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#  define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#  define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void(APIENTRYP GetProgramBinaryFunc)(GLuint   program,
+                                             GLsizei  bufSize,
+                                             GLsizei* length,
+                                             GLenum*  binaryFormat,
+                                             void*    binary);
+
+typedef void(APIENTRYP ProgramBinaryFunc)(GLuint      program,
+                                          GLenum      binaryFormat,
+                                          const void* binary,
+                                          GLsizei     length);
+
+typedef void(APIENTRYP ProgramParameteriFunc)(GLuint program,
+                                              GLenum pname,
+                                              GLint  value);
+
 typedef struct {
   GLuint vertexShader;
   GLuint fragmentShader;
   GLuint program;
 } Program;
 
+/**
+   A cache of linked program binaries in a directory.
+
+   Programs are stored in files named by a hash of their sources and the GL
+   vendor, renderer, and version strings, so a changed driver or shader will
+   never load a stale binary.
+*/
+typedef struct {
+  const char*           directory;
+  GetProgramBinaryFunc  getProgramBinary;
+  ProgramBinaryFunc     programBinary;
+  ProgramParameteriFunc programParameteri;
+  uint64_t              driverHash;
+} ProgramCache;
+
+/// Header of a program binary file
+typedef struct {
+  uint32_t format;
+  uint32_t length;
+} ProgramBinaryHeader;
+
+/// Update a 64-bit FNV-1a hash with a string, including its terminator
+static uint64_t
+hashString(uint64_t hash, const char* const string)
+{
+  const char* s = string ? string : "";
+  do {
+    hash = (hash ^ (uint8_t)*s) * 1099511628211u;
+  } while (*s++);
+
+  return hash;
+}
+
 static GLuint
 compileShader(const char* header, const char* source, const GLenum type)
 {
@@ -51,9 +112,10 @@ deleteProgram(Program program)
 }
 
 static Program
-compileProgram(const char* headerSource,
-               const char* vertexSource,
-               const char* fragmentSource)
+linkProgram(const ProgramCache* cache,
+            const char*         headerSource,
+            const char*         vertexSource,
+            const char*         fragmentSource)
 {
   static const Program nullProgram = {0, 0, 0};
 
@@ -68,6 +130,12 @@ compileProgram(const char* headerSource,
     return nullProgram;
   }
 
+  // Some drivers only keep the binary if this hint is set before linking
+  if (cache && cache->programParameteri) {
+    cache->programParameteri(
+      program.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+
   glAttachShader(program.program, program.vertexShader);
   glAttachShader(program.program, program.fragmentShader);
   glLinkProgram(program.program);
@@ -90,4 +158,192 @@ compileProgram(const char* headerSource,
   return program;
 }
 
+static Program
+compileProgram(const char* headerSource,
+               const char* vertexSource,
+               const char* fragmentSource)
+{
+  return linkProgram(NULL, headerSource, vertexSource, fragmentSource);
+}
+
+/**
+   Set up a program binary cache in an existing directory.
+
+   This must be called with the GL context current.  If the driver doesn't
+   support program binaries, the cache is disabled and programs are simply
+   compiled as usual.
+*/
+static ProgramCache
+initProgramCache(const char* directory, GLADloadproc load)
+{
+  ProgramCache cache = {
+    directory,
+    (GetProgramBinaryFunc)load("glGetProgramBinary"),
+    (ProgramBinaryFunc)load("glProgramBinary"),
+    (ProgramParameteriFunc)load("glProgramParameteri"),
+    14695981039346656037u,
+  };
+
+  // Check that at least one binary format is supported
+  GLint numFormats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+  while (glGetError() != GL_NO_ERROR) {
+  }
+
+  if (!directory || !cache.getProgramBinary || !cache.programBinary ||
+      numFormats <= 0) {
+    cache.getProgramBinary = NULL;
+    cache.programBinary    = NULL;
+    return cache;
+  }
+
+  // Hash the driver strings so a driver update invalidates the cache
+  cache.driverHash =
+    hashString(cache.driverHash, (const char*)glGetString(GL_VENDOR));
+  cache.driverHash =
+    hashString(cache.driverHash, (const char*)glGetString(GL_RENDERER));
+  cache.driverHash =
+    hashString(cache.driverHash, (const char*)glGetString(GL_VERSION));
+
+  return cache;
+}
+
+/// Return the path of the cache file for some program sources
+static char*
+programCachePath(const ProgramCache* cache,
+                 const char*         headerSource,
+                 const char*         vertexSource,
+                 const char*         fragmentSource)
+{
+  uint64_t hash = cache->driverHash;
+  hash          = hashString(hash, headerSource);
+  hash          = hashString(hash, vertexSource);
+  hash          = hashString(hash, fragmentSource);
+
+  const char* const dir = cache->directory;
+  const int         len =
+    snprintf(NULL, 0, "%s/%016" PRIx64 ".bin", dir, hash);
+
+  const size_t size = len > 0 ? (size_t)len + 1u : 0u;
+  char* const  path = size ? (char*)calloc(1, size) : NULL;
+  if (path) {
+    snprintf(path, size, "%s/%016" PRIx64 ".bin", dir, hash);
+  }
+
+  return path;
+}
+
+/// Load a program from a cached binary, or return a null program
+static Program
+loadProgramBinary(const ProgramCache* cache, const char* path)
+{
+  static const Program nullProgram = {0, 0, 0};
+
+  FILE* const file = fopen(path, "rb");
+  if (!file) {
+    return nullProgram;
+  }
+
+  // Read the header and binary data
+  ProgramBinaryHeader header = {0u, 0u};
+  void*               binary = NULL;
+  if (fread(&header, sizeof(header), 1, file) != 1 || !header.length ||
+      !(binary = malloc(header.length)) ||
+      fread(binary, 1, header.length, file) != header.length) {
+    free(binary);
+    fclose(file);
+    return nullProgram;
+  }
+
+  fclose(file);
+
+  // Load the binary, which may fail if the driver has changed in some way
+  Program program = {0, 0, glCreateProgram()};
+  cache->programBinary(
+    program.program, header.format, binary, (GLsizei)header.length);
+  free(binary);
+
+  GLint status = 0;
+  glGetProgramiv(program.program, GL_LINK_STATUS, &status);
+  if (status == GL_FALSE) {
+    while (glGetError() != GL_NO_ERROR) {
+    }
+
+    deleteProgram(program);
+    return nullProgram;
+  }
+
+  return program;
+}
+
+/// Save the binary of a linked program to the cache
+static void
+saveProgramBinary(const ProgramCache* cache, const char* path, GLuint program)
+{
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) {
+    return;
+  }
+
+  ProgramBinaryHeader header = {0u, (uint32_t)length};
+  void* const         binary = malloc((size_t)length);
+  GLsizei             size   = 0;
+  GLenum              format = 0;
+  if (!binary) {
+    return;
+  }
+
+  cache->getProgramBinary(program, length, &size, &format, binary);
+  header.format = format;
+  header.length = (uint32_t)size;
+
+  FILE* const file = size > 0 ? fopen(path, "wb") : NULL;
+  if (file) {
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        fwrite(binary, 1, (size_t)size, file) != (size_t)size) {
+      fprintf(stderr, "warning: Failed to write program cache %s\n", path);
+    }
+
+    fclose(file);
+  }
+
+  free(binary);
+}
+
+/**
+   Compile a program, or load it from a cache if it has been compiled before.
+
+   Newly compiled programs are added to the cache, so they can be quickly
+   loaded the next time the program runs.  If the cache is disabled, this is
+   the same as compileProgram().
+*/
+static Program
+compileCachedProgram(const ProgramCache* cache,
+                     const char*         headerSource,
+                     const char*         vertexSource,
+                     const char*         fragmentSource)
+{
+  if (!cache->programBinary) {
+    return compileProgram(headerSource, vertexSource, fragmentSource);
+  }
+
+  char* const path =
+    programCachePath(cache, headerSource, vertexSource, fragmentSource);
+  if (!path) {
+    return compileProgram(headerSource, vertexSource, fragmentSource);
+  }
+
+  Program program = loadProgramBinary(cache, path);
+  if (!program.program) {
+    program = linkProgram(cache, headerSource, vertexSource, fragmentSource);
+    if (program.program) {
+      saveProgramBinary(cache, path, program.program);
+    }
+  }
+
+  free(path);
+  return program;
+}
+
 #endif // EXAMPLES_SHADER_UTILS_H
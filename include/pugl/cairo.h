@@ -15,6 +15,113 @@ PUGL_BEGIN_DECLS
    @{
 */
 
+/**
+   A function called to draw one tile of an exposed region with Cairo.
+
+   This is called on a worker thread, so it must be safe to call concurrently
+   for different tiles, and must not call any Pugl functions other than
+   puglGetHandle().
+
+   @param view The view being drawn.
+   @param context The Cairo context (a `cairo_t*`) to draw the tile with.  This
+   uses view coordinates, and is clipped to the tile.
+   @param tile The region of the view covered by the tile.
+*/
+typedef void (*PuglCairoTileFunc)(PuglView*              view,
+                                  void*                  context,
+                                  const PuglExposeEvent* tile);
+
+/**
+   Draw exposed regions of a view in tiles on several threads.
+
+   When set, exposed regions are split into square tiles, which are drawn into
+   separate image surfaces by calling `drawTile` on a pool of worker threads,
+   then composited into the view.  This happens before the #PUGL_EXPOSE event
+   is dispatched, which can still draw on top of the result with the usual
+   context returned by puglGetContext().
+
+   This allows software rendering of large views to scale across cores.  It is
+   currently only supported on X11.
+
+   @param view The view to draw in tiles.
+   @param drawTile The function to draw one tile, or null to disable tiling.
+   @param numThreads The number of threads to draw with, including the thread
+   that handles the expose, or zero to use one per processor.
+   @param tileSize The width and height of tiles, or zero for a default.
+   @return #PUGL_BAD_BACKEND if the view doesn't use the Cairo backend,
+   #PUGL_UNSUPPORTED if tiling isn't supported, or #PUGL_SUCCESS.
+*/
+PUGL_API
+PuglStatus
+puglSetCairoTileFunc(PuglView*         view,
+                     PuglCairoTileFunc drawTile,
+                     unsigned          numThreads,
+                     PuglSpan          tileSize);
+
+/**
+   A function called to draw a retained layer of a view with Cairo.
+
+   This is called during an expose, before the #PUGL_EXPOSE event is
+   dispatched, only if the layer has been invalidated or the view has been
+   resized since it was last drawn.
+
+   @param view The view being drawn.
+   @param context The Cairo context (a `cairo_t*`) to draw the layer with.  This
+   uses view coordinates, and draws to a cleared surface the size of the view.
+*/
+typedef void (*PuglCairoLayerFunc)(PuglView* view, void* context);
+
+/**
+   Add a retained layer to a view, or replace the draw function of one.
+
+   Layers are drawn to surfaces that are kept between exposes, and composited
+   from bottom to top (in the order they were added) to the exposed region
+   before the #PUGL_EXPOSE event is dispatched.  This allows static content
+   like backgrounds and labels to be drawn only once, while the expose handler
+   draws only what changes on top.
+
+   If a layer with the same name already exists, its draw function is replaced
+   and it is invalidated, but it stays in the same position.
+
+   On MacOS, layers can only be added after the view is realized.
+
+   @param view The view to add the layer to.
+   @param name The name of the layer, which is copied.
+   @param drawLayer The function to draw the layer.
+   @return #PUGL_BAD_BACKEND if the view doesn't use the Cairo backend,
+   #PUGL_FAILURE if layers aren't available yet, or #PUGL_SUCCESS.
+*/
+PUGL_API
+PuglStatus
+puglAddCairoLayer(PuglView*          view,
+                  const char*        name,
+                  PuglCairoLayerFunc drawLayer);
+
+/**
+   Remove a retained layer from a view.
+
+   @return #PUGL_BAD_PARAMETER if the view has no layer with the given name,
+   #PUGL_BAD_BACKEND if the view doesn't use the Cairo backend, or
+   #PUGL_SUCCESS.
+*/
+PUGL_API
+PuglStatus
+puglRemoveCairoLayer(PuglView* view, const char* name);
+
+/**
+   Invalidate a retained layer so that it is redrawn.
+
+   The layer is redrawn during the next expose, which this schedules like
+   puglPostRedisplay().  Layers that are not invalidated are only composited.
+
+   @return #PUGL_BAD_PARAMETER if the view has no layer with the given name,
+   #PUGL_BAD_BACKEND if the view doesn't use the Cairo backend, or
+   #PUGL_SUCCESS.
+*/
+PUGL_API
+PuglStatus
+puglInvalidateCairoLayer(PuglView* view, const char* name);
+
 /**
    Cairo graphics backend accessor.
 
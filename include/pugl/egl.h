@@ -0,0 +1,55 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef PUGL_EGL_H
+#define PUGL_EGL_H
+
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+PUGL_BEGIN_DECLS
+
+/**
+   @defgroup egl EGL
+   OpenGL graphics support via EGL.
+
+   These backends are only available on X11, and set up OpenGL contexts with
+   EGL rather than GLX.  Otherwise, they work like the OpenGL backend, and the
+   API in the @ref gl group can be used with them.
+
+   @ingroup pugl
+   @{
+*/
+
+/**
+   EGL graphics backend.
+
+   Pass the returned value to puglSetBackend() to draw to a view with OpenGL,
+   using an EGL window surface.  When an exposed region is smaller than the
+   view, only that region is reported as damaged when presenting, if
+   supported.
+*/
+PUGL_CONST_API
+const PuglBackend*
+puglEglBackend(void);
+
+/**
+   EGL offscreen graphics backend.
+
+   Pass the returned value to puglSetBackend() to use an OpenGL context that
+   isn't bound to the view's window.  The context is surfaceless if supported,
+   or uses a tiny pbuffer otherwise, so it has no usable default framebuffer,
+   and drawing must be done to framebuffer objects.  Nothing is presented to
+   the window, which may be left hidden.
+*/
+PUGL_CONST_API
+const PuglBackend*
+puglEglOffscreenBackend(void);
+
+/**
+   @}
+*/
+
+PUGL_END_DECLS
+
+#endif // PUGL_EGL_H
@@ -76,6 +76,102 @@ PUGL_API
 PuglStatus
 puglLeaveContext(PuglView* view);
 
+/**
+   Return the age of the back buffer in frames.
+
+   This should be called while handling a #PUGL_EXPOSE event, and returns how
+   many frames ago the current contents of the back buffer were drawn.  If this
+   is non-zero, then only the regions damaged in that many frames need to be
+   redrawn, since the rest of the buffer is already up to date.  When an
+   exposed region is smaller than the view, only that region may be presented,
+   where supported.
+
+   @return The age of the back buffer, or zero if its contents are undefined
+   and the whole view must be redrawn.
+*/
+PUGL_API
+unsigned
+puglGetBufferAge(PuglView* view);
+
+/**
+   Timing information about the most recently shown frame.
+
+   The media stream counter counts vertical refreshes of the display, and the
+   swap buffer counter counts frames that have been shown.  If no frames have
+   been shown yet, then the swap buffer counter is zero, and the time and media
+   stream counter are those of the latest refresh.
+*/
+typedef struct {
+  double   time;   ///< Time the frame was shown, see puglGetTime()
+  uint64_t msc;    ///< Media stream counter when the frame was shown
+  uint64_t sbc;    ///< Swap buffer counter of the frame
+  uint32_t missed; ///< Refreshes missed between frames since the last query
+} PuglFrameTiming;
+
+/**
+   Get timing information about the most recently shown frame.
+
+   This can be used to pace animation to the actual timing of the display.
+   Refreshes are counted as missed when more passed between frames than the
+   swap interval, so the `missed` count is only meaningful when drawing
+   continuously.
+
+   @return #PUGL_UNSUPPORTED if frame timing isn't available.
+*/
+PUGL_API
+PuglStatus
+puglGetFrameTiming(PuglView* view, PuglFrameTiming* timing);
+
+/**
+   The time taken to draw a frame.
+
+   The CPU time is how long the #PUGL_EXPOSE event took to handle, and the GPU
+   time is how long the GPU took to execute the commands issued while handling
+   it.  If the GPU time is much larger, then drawing is GPU-bound.
+*/
+typedef struct {
+  double   cpuTime; ///< Time spent handling the expose on the CPU in seconds
+  double   gpuTime; ///< Time spent executing commands on the GPU in seconds
+  uint64_t frame;   ///< Number of frames measured, including this one
+} PuglDrawTiming;
+
+/**
+   Get the time taken to draw a recent frame.
+
+   This requires the #PUGL_DRAW_TIMING hint to be set.  Every expose is then
+   wrapped in a GPU timer query, which is read back a few frames later to avoid
+   stalling, so the returned timing is for a slightly earlier frame than the
+   latest.  With #PUGL_RENDER_THREAD, this should only be called on the render
+   thread, for example while handling #PUGL_EXPOSE.
+
+   @return #PUGL_UNSUPPORTED if draw timing isn't enabled or supported, or
+   #PUGL_FAILURE if no frames have been measured yet.
+*/
+PUGL_API
+PuglStatus
+puglGetDrawTiming(PuglView* view, PuglDrawTiming* timing);
+
+/**
+   Set a view to share OpenGL objects with.
+
+   This must be called before `view` is realized.  The OpenGL context of `view`
+   will then share objects like textures, buffers, and shader programs with the
+   context of `shareView`, so data only needs to be uploaded once for all views
+   in a share group.  Views that share with the same view are all in the same
+   share group.
+
+   @param view The view to set the share view of.
+
+   @param shareView A view that has already been realized with an OpenGL
+   backend and a compatible configuration, or null to not share objects.  This
+   view must not be freed before `view` is realized.
+
+   @return #PUGL_FAILURE if `view` is already realized.
+*/
+PUGL_API
+PuglStatus
+puglSetShareView(PuglView* view, PuglView* shareView);
+
 /**
    OpenGL graphics backend.
 
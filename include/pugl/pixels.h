@@ -0,0 +1,73 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef PUGL_PIXELS_H
+#define PUGL_PIXELS_H
+
+#include "pugl/pugl.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+PUGL_BEGIN_DECLS
+
+/**
+   @defgroup pixels Pixels
+   Raw pixel buffer support.
+   @ingroup pugl
+   @{
+*/
+
+/**
+   A buffer of pixels that a view is drawn to.
+
+   This is the drawing context of the pixels backend, which is returned by
+   puglGetContext() while handling a #PUGL_EXPOSE event.  The buffer persists
+   between exposes, so pixels outside the damaged region still have the
+   contents they were last drawn with.  Only the damaged region is presented
+   to the view when the expose is finished.
+*/
+typedef struct {
+  /**
+     Pixel data in native-endian ARGB32 format.
+
+     Rows are ordered from top to bottom.  Alpha is ignored, so all pixels
+     are presented as opaque.
+  */
+  uint32_t* data;
+
+  size_t   stride; ///< Distance between the start of rows in bytes
+  PuglSpan width;  ///< Width of the buffer in pixels
+  PuglSpan height; ///< Height of the buffer in pixels
+
+  /**
+     The region that must be drawn.
+
+     This is usually the region of the expose event, but is the whole buffer
+     if its previous contents were lost, for example after a resize.
+  */
+  PuglRect damage;
+} PuglPixelBuffer;
+
+/**
+   Pixels graphics backend accessor.
+
+   Pass the returned value to puglSetBackend() to draw to a view by writing
+   pixels directly into memory.  The drawing context, returned by
+   puglGetContext() during an expose, is a pointer to a #PuglPixelBuffer.
+
+   Where possible, the buffer is in memory that is shared with the display
+   server, so presenting it doesn't require copying pixels to the server.
+   This backend is currently supported on X11 and Windows.
+*/
+PUGL_CONST_API
+const PuglBackend*
+puglPixelsBackend(void);
+
+/**
+   @}
+*/
+
+PUGL_END_DECLS
+
+#endif // PUGL_PIXELS_H
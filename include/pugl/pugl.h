@@ -696,6 +696,28 @@ typedef enum {
 /// Bitwise OR of #PuglWorldFlag values
 typedef uint32_t PuglWorldFlags;
 
+/**
+   Functions used to allocate memory.
+
+   These work like the standard C functions of the same name, with an
+   additional handle parameter for the allocator's own data.  All of them must
+   be set.  They may be called from any thread that uses the world, including
+   the render threads of views.
+*/
+typedef struct {
+  /// Allocate `count` zero-initialised objects of `size` bytes, like calloc()
+  void* (*callocFunc)(void* handle, size_t count, size_t size);
+
+  /// Resize an allocation to `size` bytes, or allocate if null, like realloc()
+  void* (*reallocFunc)(void* handle, void* ptr, size_t size);
+
+  /// Free an allocation, which may be null, like free()
+  void (*freeFunc)(void* handle, void* ptr);
+
+  /// Opaque user data passed to every allocator function
+  void* handle;
+} PuglAllocator;
+
 /**
    Create a new world.
 
@@ -707,7 +729,26 @@ PUGL_API
 PuglWorld*
 puglNewWorld(PuglWorldType type, PuglWorldFlags flags);
 
-/// Free a world allocated with puglNewWorld()
+/**
+   Create a new world that allocates memory with custom functions.
+
+   Everything Pugl allocates for the world and its views, including the world
+   itself, is allocated with `allocator`.  This does not include memory
+   allocated internally by system libraries or drivers.
+
+   @param type The type, which dictates what this world is responsible for.
+   @param flags Flags to control world features.
+   @param allocator Allocation functions, which are copied, or null to use the
+   standard C library.
+   @return A new world, which must be later freed with puglFreeWorld().
+*/
+PUGL_API
+PuglWorld*
+puglNewWorldWithAllocator(PuglWorldType        type,
+                          PuglWorldFlags       flags,
+                          const PuglAllocator* allocator);
+
+/// Free a world allocated with puglNewWorld() or puglNewWorldWithAllocator()
 PUGL_API
 void
 puglFreeWorld(PuglWorld* world);
@@ -760,6 +801,31 @@ PUGL_API
 const char*
 puglGetClassName(const PuglWorld* world);
 
+/// The level of a log message, with the same values as syslog
+typedef enum {
+  PUGL_LOG_LEVEL_ERR     = 3, ///< Error
+  PUGL_LOG_LEVEL_WARNING = 4, ///< Warning
+  PUGL_LOG_LEVEL_INFO    = 6, ///< Informational message
+  PUGL_LOG_LEVEL_DEBUG   = 7, ///< Debug message
+} PuglLogLevel;
+
+/// A function called to log a message
+typedef void (*PuglLogFunc)(PuglWorld*   world,
+                            PuglLogLevel level,
+                            const char*  msg);
+
+/**
+   Set the function to call to log messages.
+
+   Messages are only logged in specific situations, for example, messages from
+   an OpenGL debug context are logged if #PUGL_USE_DEBUG_CONTEXT is set.  The
+   function may be called from any thread that draws a view.  By default,
+   nothing is logged.
+*/
+PUGL_API
+void
+puglSetLogFunc(PuglWorld* world, PuglLogFunc logFunc);
+
 /**
    Return the time in seconds.
 
@@ -797,6 +863,131 @@ PUGL_API
 PuglStatus
 puglUpdate(PuglWorld* world, double timeout);
 
+/**
+   Prepare to wait for events in an external event loop.
+
+   This, along with puglGetUpdateFds(), puglCheckUpdate(), and
+   puglDispatchUpdate(), allows Pugl to be driven by another event loop, like
+   those of GLib or libuv, instead of puglUpdate().  An iteration of the
+   external loop should:
+
+   1. Call this function to flush any pending requests to the window system,
+      and get the longest time the loop may wait.
+
+   2. Wait for the descriptors from puglGetUpdateFds() to become readable, or
+      until the timeout has elapsed, along with anything else the loop waits
+      for.
+
+   3. Call puglCheckUpdate(), and if it returns true, call
+      puglDispatchUpdate().
+
+   @param world The world.
+
+   @param[out] timeout Set to zero if events are already ready to dispatch, a
+   positive time in seconds if the loop must wake up after that time even if
+   no descriptors are readable, or a negative value if the loop may wait
+   indefinitely for a readable descriptor.  Timers, redisplays, and idle tasks
+   are accounted for, so they are dispatched on time.
+
+   @return #PUGL_SUCCESS, or #PUGL_UNSUPPORTED if this platform's events can't
+   be watched by an external event loop.  Only X11 is currently supported.
+*/
+PUGL_API
+PuglStatus
+puglPrepareUpdate(PuglWorld* world, double* timeout);
+
+/**
+   Get the file descriptors that an external event loop must watch.
+
+   The descriptors must be watched for reading.  They may change when views
+   are created or destroyed, so they should be fetched after every call to
+   puglPrepareUpdate().
+
+   @param world The world.
+   @param fds Array to write descriptors to.
+   @param maxFds Size of `fds`.
+   @return The total number of descriptors, which may be more than `maxFds`.
+*/
+PUGL_API
+size_t
+puglGetUpdateFds(const PuglWorld* world, int* fds, size_t maxFds);
+
+/**
+   Check if events are ready to be dispatched.
+
+   This must be called after waiting, and reads any new events from the window
+   system without blocking.
+
+   @return True if puglDispatchUpdate() should be called.
+*/
+PUGL_API
+bool
+puglCheckUpdate(PuglWorld* world);
+
+/**
+   Dispatch all events that are ready, without blocking.
+
+   This dispatches exactly the events that have already been received, then
+   any pending configure and expose events, like puglUpdate() with a zero
+   timeout.
+
+   @return #PUGL_SUCCESS, or an error.
+*/
+PUGL_API
+PuglStatus
+puglDispatchUpdate(PuglWorld* world);
+
+/**
+   A function called to do some low-priority work when the world is idle.
+
+   This should do a small amount of work, like processing one chunk of a
+   larger job, then return quickly so events can be handled promptly.
+
+   @return True if the task has more work to do and should be called again,
+   or false if it is finished and should be removed.
+*/
+typedef bool (*PuglIdleFunc)(PuglWorld* world, void* data);
+
+/**
+   Add a task to be run when the world is idle.
+
+   Idle tasks are run at the end of puglUpdate(), after events have been
+   dispatched and views have been drawn, until the end of the update's timeout
+   or the idle budget has been used, whichever comes first.  Tasks are called
+   in turn, so several queued tasks all make progress.  While any tasks are
+   queued, puglUpdate() doesn't wait for events, so the idle time isn't spent
+   blocking.
+
+   @return #PUGL_SUCCESS, or #PUGL_NO_MEMORY.
+*/
+PUGL_API
+PuglStatus
+puglAddIdleTask(PuglWorld* world, PuglIdleFunc func, void* data);
+
+/**
+   Remove a task that was added with puglAddIdleTask().
+
+   @return #PUGL_SUCCESS, or #PUGL_FAILURE if there is no such task.
+*/
+PUGL_API
+PuglStatus
+puglRemoveIdleTask(PuglWorld* world, PuglIdleFunc func, void* data);
+
+/**
+   Set the maximum time to spend running idle tasks in a single update.
+
+   The default is 5 milliseconds.  A task that is already running isn't
+   interrupted, so the budget may be exceeded by the time one call takes.  At
+   least one task is run in every update, even if the budget is zero.
+
+   @param world The world.
+   @param budget Maximum time in seconds.
+   @return #PUGL_SUCCESS, or #PUGL_BAD_PARAMETER if `budget` is negative.
+*/
+PUGL_API
+PuglStatus
+puglSetIdleBudget(PuglWorld* world, double budget);
+
 /**
    @}
    @defgroup view View
@@ -859,6 +1050,10 @@ typedef enum {
   PUGL_RESIZABLE,             ///< True if view should be resizable
   PUGL_IGNORE_KEY_REPEAT,     ///< True if key repeat events are ignored
   PUGL_REFRESH_RATE,          ///< Refresh rate in Hz
+  PUGL_PREFETCH_CLIPBOARD,    ///< True to fetch small clipboard text early
+  PUGL_ADAPTIVE_SWAP,         ///< True if late buffer swaps should tear
+  PUGL_RENDER_THREAD,         ///< True to draw on a separate thread
+  PUGL_DRAW_TIMING,           ///< True to measure the time taken to draw
 
   PUGL_NUM_VIEW_HINTS
 } PuglViewHint;
@@ -1348,6 +1543,47 @@ puglSetClipboard(PuglView*   view,
                  const void* data,
                  size_t      len);
 
+/**
+   A function called to provide clipboard data on demand.
+
+   @param view The view that offered the data.
+
+   @param typeIndex The index of the requested type in the array of types
+   passed to puglOfferClipboard().
+
+   @param[out] len Set to the length of the data in bytes.
+
+   @return The data, or null if it can not be provided.  The data is not
+   copied, and must remain valid until the clipboard is set again or the view
+   is freed.
+*/
+typedef const void* (*PuglClipboardFunc)(PuglView* view,
+                                         uint32_t  typeIndex,
+                                         size_t*   len);
+
+/**
+   Offer data to the clipboard in several types without copying it.
+
+   This takes ownership of the system clipboard like puglSetClipboard(), but
+   data is only requested from `provider` when another view or application
+   actually pastes it, and only in the requested type.  This makes copying
+   large or expensive data cheap when it is never pasted.
+
+   Not all platforms support providing data on demand, in which case the
+   provider may be called immediately.
+
+   @param view The view.
+   @param types Array of MIME types that the data can be provided as.
+   @param numTypes The number of elements in `types`.
+   @param provider The function called to get the data in a specific type.
+*/
+PUGL_API
+PuglStatus
+puglOfferClipboard(PuglView*          view,
+                   const char* const* types,
+                   uint32_t           numTypes,
+                   PuglClipboardFunc  provider);
+
 /**
    Get the clipboard contents.
 
@@ -1455,6 +1691,160 @@ puglSendEvent(PuglView* view, const PuglEvent* event);
    @}
 */
 
+/**
+   @defgroup virtual Virtual Views
+
+   Lightweight child views drawn within a parent view.
+
+   A virtual view is a region of a parent view with its own frame, event
+   handler, and redisplay requests, but no native window or graphics context.
+   This allows a single view to host many independent widgets or embedded
+   components without the cost of a native window for each.
+
+   The parent routes events to its virtual views: pointer events go to the
+   topmost visible virtual view under the pointer (or the one that grabbed it
+   with a button press), and keyboard events go to the virtual view with the
+   focus.  Events delivered to a virtual view are not delivered to the parent.
+   Coordinates are translated to be relative to the virtual view, except root
+   coordinates which are unchanged.
+
+   Virtual views are drawn after the parent, in the order they were created,
+   while the parent's graphics context is active.  Expose events are in
+   virtual view coordinates, so drawing must be offset by the virtual view's
+   frame, for example by translating a Cairo context or setting an OpenGL
+   viewport.
+
+   @{
+*/
+
+/// A lightweight view drawn within a parent view
+typedef struct PuglVirtualViewImpl PuglVirtualView;
+
+/// A function called when an event occurs in a virtual view
+typedef PuglStatus (*PuglVirtualEventFunc)(PuglVirtualView* view,
+                                           const PuglEvent* event);
+
+/**
+   Create a new virtual view within a parent view.
+
+   The virtual view is initially hidden, and has an empty frame.  Virtual
+   views can't be used in a view that requests #PUGL_RENDER_THREAD, since the
+   render thread would draw them while the event thread changes them.
+
+   @return A newly created virtual view, or null on error.
+*/
+PUGL_API
+PuglVirtualView*
+puglNewVirtualView(PuglView* parent);
+
+/**
+   Free a virtual view.
+
+   Any virtual views that remain when the parent is freed are freed with it.
+*/
+PUGL_API
+void
+puglFreeVirtualView(PuglVirtualView* view);
+
+/// Return the parent view that a virtual view is drawn within
+PUGL_API
+PuglView*
+puglGetVirtualParent(const PuglVirtualView* view);
+
+/// Set the user data for a virtual view
+PUGL_API
+void
+puglSetVirtualHandle(PuglVirtualView* view, PuglHandle handle);
+
+/// Get the user data for a virtual view
+PUGL_API
+PuglHandle
+puglGetVirtualHandle(const PuglVirtualView* view);
+
+/// Set the function to call when an event occurs in a virtual view
+PUGL_API
+PuglStatus
+puglSetVirtualEventFunc(PuglVirtualView* view, PuglVirtualEventFunc eventFunc);
+
+/**
+   Set the frame of a virtual view in parent coordinates.
+
+   This immediately dispatches a #PUGL_CONFIGURE event to the virtual view
+   (without any graphics context entered), and requests a redisplay of the
+   old and new regions of the parent if the virtual view is visible.
+*/
+PUGL_API
+PuglStatus
+puglSetVirtualFrame(PuglVirtualView* view, PuglRect frame);
+
+/// Return the frame of a virtual view in parent coordinates
+PUGL_API
+PuglRect
+puglGetVirtualFrame(const PuglVirtualView* view);
+
+/**
+   Show a virtual view.
+
+   This dispatches a #PUGL_MAP event to the virtual view, and requests a
+   redisplay of its region of the parent.
+*/
+PUGL_API
+PuglStatus
+puglShowVirtualView(PuglVirtualView* view);
+
+/**
+   Hide a virtual view.
+
+   This dispatches a #PUGL_UNMAP event to the virtual view, and requests a
+   redisplay of its region of the parent.  A hidden virtual view is not drawn
+   and receives no input.
+*/
+PUGL_API
+PuglStatus
+puglHideVirtualView(PuglVirtualView* view);
+
+/// Return true iff a virtual view is visible
+PUGL_API
+bool
+puglGetVirtualVisible(const PuglVirtualView* view);
+
+/**
+   Give a virtual view the keyboard focus within its parent.
+
+   This dispatches #PUGL_FOCUS_OUT to the virtual view that previously had the
+   focus, if any, and #PUGL_FOCUS_IN to this one.  Pressing a button in a
+   virtual view also gives it the focus.
+*/
+PUGL_API
+PuglStatus
+puglGrabVirtualFocus(PuglVirtualView* view);
+
+/**
+   Request a redisplay of an entire virtual view.
+
+   This requests a redisplay of the virtual view's region of the parent, so
+   only the damaged regions of the parent are drawn.  Does nothing if the
+   virtual view is hidden.
+*/
+PUGL_API
+PuglStatus
+puglPostVirtualRedisplay(PuglVirtualView* view);
+
+/**
+   Request a redisplay of a rectangle within a virtual view.
+
+   @param view The virtual view to redisplay.
+   @param rect The region to redisplay in virtual view coordinates, which is
+   clipped to the virtual view.
+*/
+PUGL_API
+PuglStatus
+puglPostVirtualRedisplayRect(PuglVirtualView* view, PuglRect rect);
+
+/**
+   @}
+*/
+
 #ifndef PUGL_DISABLE_DEPRECATED
 
 /**
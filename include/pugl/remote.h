@@ -0,0 +1,222 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef PUGL_REMOTE_H
+#define PUGL_REMOTE_H
+
+#include "pugl/pixels.h"
+#include "pugl/pugl.h"
+
+PUGL_BEGIN_DECLS
+
+/**
+   @defgroup remote Remote Views
+   Views drawn by another process.
+   @ingroup pugl
+
+   A remote view is a region of a host view that is drawn by a guest in
+   another process, for example a plugin UI that runs in a sandbox.  The host
+   and guest communicate over a connected local stream socket, for example one
+   made with `socketpair()` before starting the guest process.
+
+   The guest draws into a pixel buffer in memory that is shared with the host,
+   and tells the host which region it drew.  The host copies that region into
+   its own pixel buffer while handling an expose, then acknowledges the frame,
+   after which the guest may draw again.  Drawing is paced by the host this
+   way, and the guest never writes to the shared buffer while the host is
+   reading it.  Input events are forwarded from the host to the guest over the
+   socket.
+
+   On Linux, the shared buffer is a memory file that is sealed at its initial
+   size, so a misbehaving guest can't resize it and crash the host while it
+   is reading.  Where sealing isn't available, the buffer is a POSIX shared
+   memory object that the guest could truncate, so the guest must be trusted
+   not to.
+
+   Events are sent between processes as raw #PuglEvent structures, so the host
+   and guest must use the same version of Pugl on the same machine.  Remote
+   views are currently supported on X11.
+
+   @{
+*/
+
+/// The host side of a remote view, which displays the guest
+typedef struct PuglRemoteHostImpl PuglRemoteHost;
+
+/// The guest side of a remote view, which draws it in another process
+typedef struct PuglRemoteGuestImpl PuglRemoteGuest;
+
+/// A function called when an event occurs in a remote guest
+typedef PuglStatus (*PuglRemoteEventFunc)(PuglRemoteGuest* guest,
+                                          const PuglEvent* event);
+
+/**
+   @defgroup remote_host Host
+   @{
+*/
+
+/**
+   Create the host side of a remote view.
+
+   The host should use the pixels backend, so that the frames drawn by the
+   guest can be copied into the view's pixel buffer with puglDrawRemote().
+
+   @param view The host view to display the guest in.
+   @param socket A connected local stream socket to the guest process.  The
+   host takes ownership of the socket, and closes it when freed.
+   @return A newly created remote host, or null on error.
+*/
+PUGL_API
+PuglRemoteHost*
+puglNewRemoteHost(PuglView* view, int socket);
+
+/// Free a remote host, which disconnects the guest
+PUGL_API
+void
+puglFreeRemoteHost(PuglRemoteHost* host);
+
+/**
+   Set the region of the host view that the guest is displayed in.
+
+   If the size has changed, this creates a new shared buffer for the guest.
+   The guest receives a #PUGL_CONFIGURE event with the new frame, and must
+   redraw everything.
+*/
+PUGL_API
+PuglStatus
+puglSetRemoteFrame(PuglRemoteHost* host, PuglRect frame);
+
+/// Return the region of the host view that the guest is displayed in
+PUGL_API
+PuglRect
+puglGetRemoteFrame(const PuglRemoteHost* host);
+
+/**
+   Forward an event to the guest.
+
+   This is typically called from the host's event handler for input events
+   within the remote frame.  Coordinates in pointer and keyboard events are
+   translated to be relative to the guest, except root coordinates which are
+   unchanged.  Expose events request that the guest redraws the given region,
+   in guest coordinates.
+*/
+PUGL_API
+PuglStatus
+puglSendRemoteEvent(PuglRemoteHost* host, const PuglEvent* event);
+
+/**
+   Process messages from the guest.
+
+   When the guest has drawn a frame, this posts a redisplay of the drawn
+   region of the host view.  This must be called regularly, for example while
+   handling #PUGL_UPDATE or a timer event.
+
+   @param host The remote host.
+   @param timeout Maximum time to wait for a message, in seconds.  If zero,
+   the call returns immediately, if negative, the call blocks indefinitely.
+   @return #PUGL_SUCCESS, or #PUGL_FAILURE if the guest disconnected.
+*/
+PUGL_API
+PuglStatus
+puglUpdateRemoteHost(PuglRemoteHost* host, double timeout);
+
+/**
+   Draw the latest frame from the guest.
+
+   This must be called while handling a #PUGL_EXPOSE event for the host view,
+   with the pixel buffer from puglGetContext().  It copies the region that the
+   guest has drawn since the last call into the remote frame of the buffer,
+   then acknowledges the frame so the guest can draw the next one.
+*/
+PUGL_API
+PuglStatus
+puglDrawRemote(PuglRemoteHost* host, PuglPixelBuffer* buffer);
+
+/**
+   @}
+   @defgroup remote_guest Guest
+   @{
+*/
+
+/**
+   Create the guest side of a remote view.
+
+   @param socket A connected local stream socket to the host process.  The
+   guest takes ownership of the socket, and closes it when freed.
+   @return A newly created remote guest, or null on error.
+*/
+PUGL_API
+PuglRemoteGuest*
+puglNewRemoteGuest(int socket);
+
+/// Free a remote guest, which disconnects from the host
+PUGL_API
+void
+puglFreeRemoteGuest(PuglRemoteGuest* guest);
+
+/// Set the user data for a remote guest
+PUGL_API
+void
+puglSetRemoteHandle(PuglRemoteGuest* guest, PuglHandle handle);
+
+/// Get the user data for a remote guest
+PUGL_API
+PuglHandle
+puglGetRemoteHandle(const PuglRemoteGuest* guest);
+
+/**
+   Set the function to call when an event occurs in a remote guest.
+
+   The guest receives the events forwarded by the host, a #PUGL_CONFIGURE
+   event when the frame changes, and #PUGL_EXPOSE events when it should draw.
+*/
+PUGL_API
+PuglStatus
+puglSetRemoteEventFunc(PuglRemoteGuest* guest, PuglRemoteEventFunc eventFunc);
+
+/**
+   Return the shared pixel buffer to draw to.
+
+   This is only available while handling a #PUGL_EXPOSE event, and returns
+   null otherwise.  The `damage` field of the buffer is the region that must
+   be drawn, which is shown by the host once the expose is finished.
+*/
+PUGL_API
+PuglPixelBuffer*
+puglGetRemoteBuffer(PuglRemoteGuest* guest);
+
+/// Request a redisplay of the entire remote view
+PUGL_API
+PuglStatus
+puglPostRemoteRedisplay(PuglRemoteGuest* guest);
+
+/// Request a redisplay of the given rectangle within the remote view
+PUGL_API
+PuglStatus
+puglPostRemoteRedisplayRect(PuglRemoteGuest* guest, PuglRect rect);
+
+/**
+   Process messages from the host and draw if necessary.
+
+   Events from the host are dispatched to the guest's event handler.  If the
+   guest needs to be redrawn and the host has acknowledged the previous frame,
+   a #PUGL_EXPOSE event is dispatched, and the drawn region is sent to the
+   host.
+
+   @param guest The remote guest.
+   @param timeout Maximum time to wait for a message, in seconds.  If zero,
+   the call returns immediately, if negative, the call blocks indefinitely.
+   @return #PUGL_SUCCESS, or #PUGL_FAILURE if the host disconnected.
+*/
+PUGL_API
+PuglStatus
+puglUpdateRemoteGuest(PuglRemoteGuest* guest, double timeout);
+
+/**
+   @}
+   @}
+*/
+
+PUGL_END_DECLS
+
+#endif // PUGL_REMOTE_H
@@ -14,6 +14,7 @@
 
 #include <vulkan/vulkan_core.h>
 
+#include <stdbool.h>
 #include <stdint.h>
 
 PUGL_BEGIN_DECLS
@@ -40,10 +41,12 @@ PUGL_BEGIN_DECLS
    runtime.  This ensures that things will work on as many systems as possible,
    and allows errors to be handled gracefully.
 
-   This is not a "loader" in the sense of loading all the required Vulkan
-   functions (which is the application's responsibility), but just a minimal
-   implementation to portably load the Vulkan library and get the two functions
-   that are used to load everything else.
+   This is not a "loader" in the sense of loading every Vulkan function, but a
+   minimal implementation to portably load the Vulkan library and get the two
+   functions that are used to load everything else.  For convenience, it can
+   also load tables of the functions that are commonly needed to draw to a
+   view, see puglLoadVulkanInstanceFunctions() and
+   puglLoadVulkanDeviceFunctions().
 
    Note that this owns the loaded Vulkan library, so it must outlive all use of
    the Vulkan API.
@@ -56,7 +59,8 @@ typedef struct PuglVulkanLoaderImpl PuglVulkanLoader;
    Create a new dynamic loader for Vulkan functions.
 
    This dynamically loads the Vulkan library and gets the load functions from
-   it.
+   it.  On X11, the loader is shared by the world, so if a loader already
+   exists for `world`, then it is returned with an additional reference.
 
    @return A new Vulkan loader, or null on failure.
 */
@@ -67,8 +71,8 @@ puglNewVulkanLoader(PuglWorld* world);
 /**
    Free a loader created with puglNewVulkanLoader().
 
-   Note that this closes the Vulkan library, so no Vulkan objects or API may be
-   used after this is called.
+   Note that this closes the Vulkan library when the last reference to the
+   loader is freed, so no Vulkan objects or API may be used after then.
 */
 PUGL_API
 void
@@ -94,6 +98,179 @@ PUGL_API
 PFN_vkGetDeviceProcAddr
 puglGetDeviceProcAddrFunc(const PuglVulkanLoader* loader);
 
+/**
+   Table of global and instance-level Vulkan functions.
+
+   These are the functions that are commonly needed to set up a device and
+   draw to a view, loaded for a specific instance.  Calling these directly
+   avoids the dispatch overhead of the exported Vulkan library functions.
+
+   Functions from extensions that aren't enabled, like those for
+   `VK_KHR_surface`, are null.
+*/
+typedef struct {
+  // Global functions
+  PFN_vkGetInstanceProcAddr                  vkGetInstanceProcAddr;
+  PFN_vkCreateInstance                       vkCreateInstance;
+  PFN_vkEnumerateInstanceExtensionProperties vkEnumerateInstanceExtensionProperties;
+  PFN_vkEnumerateInstanceLayerProperties     vkEnumerateInstanceLayerProperties;
+
+  // Instance functions
+  PFN_vkDestroyInstance                        vkDestroyInstance;
+  PFN_vkEnumeratePhysicalDevices               vkEnumeratePhysicalDevices;
+  PFN_vkGetPhysicalDeviceProperties            vkGetPhysicalDeviceProperties;
+  PFN_vkGetPhysicalDeviceFeatures              vkGetPhysicalDeviceFeatures;
+  PFN_vkGetPhysicalDeviceFormatProperties      vkGetPhysicalDeviceFormatProperties;
+  PFN_vkGetPhysicalDeviceMemoryProperties      vkGetPhysicalDeviceMemoryProperties;
+  PFN_vkGetPhysicalDeviceQueueFamilyProperties vkGetPhysicalDeviceQueueFamilyProperties;
+  PFN_vkEnumerateDeviceExtensionProperties     vkEnumerateDeviceExtensionProperties;
+  PFN_vkCreateDevice                           vkCreateDevice;
+  PFN_vkGetDeviceProcAddr                      vkGetDeviceProcAddr;
+
+  // VK_KHR_surface functions
+  PFN_vkDestroySurfaceKHR                       vkDestroySurfaceKHR;
+  PFN_vkGetPhysicalDeviceSurfaceSupportKHR      vkGetPhysicalDeviceSurfaceSupportKHR;
+  PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR vkGetPhysicalDeviceSurfaceCapabilitiesKHR;
+  PFN_vkGetPhysicalDeviceSurfaceFormatsKHR      vkGetPhysicalDeviceSurfaceFormatsKHR;
+  PFN_vkGetPhysicalDeviceSurfacePresentModesKHR vkGetPhysicalDeviceSurfacePresentModesKHR;
+} PuglVulkanInstanceFunctions;
+
+/**
+   Table of device-level Vulkan functions.
+
+   These are the functions that are commonly needed to draw to a view, loaded
+   directly from the driver for a specific device.  Calling these directly
+   avoids the dispatch overhead of the exported Vulkan library functions,
+   which is significant for applications that record many commands.
+
+   Functions from extensions that aren't enabled, like those for
+   `VK_KHR_swapchain`, are null.
+*/
+typedef struct {
+  // Devices and queues
+  PFN_vkDestroyDevice  vkDestroyDevice;
+  PFN_vkGetDeviceQueue vkGetDeviceQueue;
+  PFN_vkQueueSubmit    vkQueueSubmit;
+  PFN_vkQueueWaitIdle  vkQueueWaitIdle;
+  PFN_vkDeviceWaitIdle vkDeviceWaitIdle;
+
+  // Memory
+  PFN_vkAllocateMemory              vkAllocateMemory;
+  PFN_vkFreeMemory                  vkFreeMemory;
+  PFN_vkMapMemory                   vkMapMemory;
+  PFN_vkUnmapMemory                 vkUnmapMemory;
+  PFN_vkFlushMappedMemoryRanges     vkFlushMappedMemoryRanges;
+  PFN_vkBindBufferMemory            vkBindBufferMemory;
+  PFN_vkBindImageMemory             vkBindImageMemory;
+  PFN_vkGetBufferMemoryRequirements vkGetBufferMemoryRequirements;
+  PFN_vkGetImageMemoryRequirements  vkGetImageMemoryRequirements;
+
+  // Synchronization
+  PFN_vkCreateFence      vkCreateFence;
+  PFN_vkDestroyFence     vkDestroyFence;
+  PFN_vkResetFences      vkResetFences;
+  PFN_vkWaitForFences    vkWaitForFences;
+  PFN_vkCreateSemaphore  vkCreateSemaphore;
+  PFN_vkDestroySemaphore vkDestroySemaphore;
+
+  // Resources
+  PFN_vkCreateBuffer               vkCreateBuffer;
+  PFN_vkDestroyBuffer              vkDestroyBuffer;
+  PFN_vkCreateImage                vkCreateImage;
+  PFN_vkDestroyImage               vkDestroyImage;
+  PFN_vkCreateImageView            vkCreateImageView;
+  PFN_vkDestroyImageView           vkDestroyImageView;
+  PFN_vkCreateSampler              vkCreateSampler;
+  PFN_vkDestroySampler             vkDestroySampler;
+  PFN_vkCreateDescriptorSetLayout  vkCreateDescriptorSetLayout;
+  PFN_vkDestroyDescriptorSetLayout vkDestroyDescriptorSetLayout;
+  PFN_vkCreateDescriptorPool       vkCreateDescriptorPool;
+  PFN_vkDestroyDescriptorPool      vkDestroyDescriptorPool;
+  PFN_vkAllocateDescriptorSets     vkAllocateDescriptorSets;
+  PFN_vkUpdateDescriptorSets       vkUpdateDescriptorSets;
+
+  // Pipelines and render passes
+  PFN_vkCreateShaderModule      vkCreateShaderModule;
+  PFN_vkDestroyShaderModule     vkDestroyShaderModule;
+  PFN_vkCreatePipelineLayout    vkCreatePipelineLayout;
+  PFN_vkDestroyPipelineLayout   vkDestroyPipelineLayout;
+  PFN_vkCreateGraphicsPipelines vkCreateGraphicsPipelines;
+  PFN_vkDestroyPipeline         vkDestroyPipeline;
+  PFN_vkCreateRenderPass        vkCreateRenderPass;
+  PFN_vkDestroyRenderPass       vkDestroyRenderPass;
+  PFN_vkCreateFramebuffer       vkCreateFramebuffer;
+  PFN_vkDestroyFramebuffer      vkDestroyFramebuffer;
+
+  // Command buffers
+  PFN_vkCreateCommandPool      vkCreateCommandPool;
+  PFN_vkDestroyCommandPool     vkDestroyCommandPool;
+  PFN_vkResetCommandPool       vkResetCommandPool;
+  PFN_vkAllocateCommandBuffers vkAllocateCommandBuffers;
+  PFN_vkFreeCommandBuffers     vkFreeCommandBuffers;
+  PFN_vkBeginCommandBuffer     vkBeginCommandBuffer;
+  PFN_vkEndCommandBuffer       vkEndCommandBuffer;
+  PFN_vkResetCommandBuffer     vkResetCommandBuffer;
+
+  // Commands
+  PFN_vkCmdBeginRenderPass    vkCmdBeginRenderPass;
+  PFN_vkCmdEndRenderPass      vkCmdEndRenderPass;
+  PFN_vkCmdBindPipeline       vkCmdBindPipeline;
+  PFN_vkCmdBindDescriptorSets vkCmdBindDescriptorSets;
+  PFN_vkCmdBindVertexBuffers  vkCmdBindVertexBuffers;
+  PFN_vkCmdBindIndexBuffer    vkCmdBindIndexBuffer;
+  PFN_vkCmdSetViewport        vkCmdSetViewport;
+  PFN_vkCmdSetScissor         vkCmdSetScissor;
+  PFN_vkCmdPushConstants      vkCmdPushConstants;
+  PFN_vkCmdDraw               vkCmdDraw;
+  PFN_vkCmdDrawIndexed        vkCmdDrawIndexed;
+  PFN_vkCmdCopyBuffer         vkCmdCopyBuffer;
+  PFN_vkCmdCopyBufferToImage  vkCmdCopyBufferToImage;
+  PFN_vkCmdClearColorImage    vkCmdClearColorImage;
+  PFN_vkCmdPipelineBarrier    vkCmdPipelineBarrier;
+
+  // VK_KHR_swapchain functions
+  PFN_vkCreateSwapchainKHR    vkCreateSwapchainKHR;
+  PFN_vkDestroySwapchainKHR   vkDestroySwapchainKHR;
+  PFN_vkGetSwapchainImagesKHR vkGetSwapchainImagesKHR;
+  PFN_vkAcquireNextImageKHR   vkAcquireNextImageKHR;
+  PFN_vkQueuePresentKHR       vkQueuePresentKHR;
+} PuglVulkanDeviceFunctions;
+
+/**
+   Load a table of global and instance-level Vulkan functions.
+
+   @param loader The loader for the Vulkan library.
+   @param instance The instance to load functions for, or `VK_NULL_HANDLE` to
+   only load the global functions used to create an instance.
+   @param[out] functions Set to the loaded functions.
+   @return `VK_SUCCESS`, or `VK_ERROR_INITIALIZATION_FAILED` if a core function
+   is missing.
+*/
+PUGL_API
+VkResult
+puglLoadVulkanInstanceFunctions(const PuglVulkanLoader*      loader,
+                                VkInstance                   instance,
+                                PuglVulkanInstanceFunctions* functions);
+
+/**
+   Load a table of device-level Vulkan functions.
+
+   The functions are loaded with `vkGetDeviceProcAddr`, so they are specific to
+   `device` and call into the driver without any dispatch in the Vulkan
+   library.  They must only be used with `device` or objects created from it.
+
+   @param loader The loader for the Vulkan library.
+   @param device The device to load functions for.
+   @param[out] functions Set to the loaded functions.
+   @return `VK_SUCCESS`, or `VK_ERROR_INITIALIZATION_FAILED` if a core function
+   is missing.
+*/
+PUGL_API
+VkResult
+puglLoadVulkanDeviceFunctions(const PuglVulkanLoader*    loader,
+                              VkDevice                   device,
+                              PuglVulkanDeviceFunctions* functions);
+
 /**
    Return the Vulkan instance extensions required to draw to a PuglView.
 
@@ -125,6 +302,138 @@ puglCreateSurface(PFN_vkGetInstanceProcAddr    vkGetInstanceProcAddr,
                   const VkAllocationCallbacks* allocator,
                   VkSurfaceKHR*                surface);
 
+/**
+   A swapchain that presents images to a view.
+
+   This is an optional helper that manages the swapchain for a surface created
+   with puglCreateSurface(), so that applications don't need to implement the
+   fiddly details themselves.  It chooses a present mode based on the
+   #PUGL_SWAP_INTERVAL and #PUGL_ADAPTIVE_SWAP hints, keeps several frames in
+   flight with a fence for each, and lazily recreates the swapchain when the
+   view is resized or the swapchain becomes out of date.
+
+   A frame is drawn by acquiring an image with puglAcquireSwapchainImage(),
+   submitting commands that render to it, then presenting it with
+   puglPresentSwapchainImage().
+*/
+typedef struct PuglSwapchainImpl PuglSwapchain;
+
+/// Options for creating a swapchain
+typedef struct {
+  /// Accessor for Vulkan functions
+  PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
+
+  /// Vulkan instance
+  VkInstance instance;
+
+  /// Physical device that `device` was created for
+  VkPhysicalDevice physicalDevice;
+
+  /// Device with the `VK_KHR_swapchain` extension enabled
+  VkDevice device;
+
+  /// Queue used to present images, which must support presenting to surface
+  VkQueue presentQueue;
+
+  /// Surface created for the view with puglCreateSurface()
+  VkSurfaceKHR surface;
+
+  /// Vulkan allocation callbacks, may be NULL
+  const VkAllocationCallbacks* allocator;
+
+  /// Format of images, or `VK_FORMAT_UNDEFINED` to choose automatically
+  VkSurfaceFormatKHR format;
+
+  /// Usage of images, or zero for only use as a colour attachment
+  VkImageUsageFlags imageUsage;
+
+  /// Number of frames that may be in flight at once, or zero for two
+  uint32_t numFramesInFlight;
+} PuglSwapchainInfo;
+
+/**
+   A swapchain image acquired to draw a frame.
+
+   The commands that draw the frame must wait for `imageAvailable` before
+   writing to the image, signal `renderFinished` when rendering is finished,
+   and the final submission must signal `fence`.
+*/
+typedef struct {
+  VkImage     image;          ///< Image to draw to
+  VkImageView imageView;      ///< View of the whole image
+  VkSemaphore imageAvailable; ///< Signalled when the image can be written
+  VkSemaphore renderFinished; ///< Must be signalled when rendering finishes
+  VkFence     fence;          ///< Must be signalled by the final submission
+  VkExtent2D  extent;         ///< Size of the image
+  VkFormat    format;         ///< Format of the image
+  uint32_t    imageIndex;     ///< Index of the image in the swapchain
+  uint32_t    numImages;      ///< Number of images in the swapchain
+  uint32_t    frameIndex;     ///< Index of the frame in flight
+  bool        recreated;      ///< True if the swapchain has been recreated
+} PuglSwapchainImage;
+
+/**
+   Create a swapchain for a view.
+
+   The swapchain images themselves are only created when the first image is
+   acquired, but the surface format is chosen immediately, so that it is
+   available from puglGetSwapchainFormat() to set up render passes.
+
+   @param view The view the surface was created for.
+   @param info Options for the swapchain.
+   @param[out] swapchain Set to the newly created swapchain.
+   @return `VK_SUCCESS` on success, or a Vulkan error code.
+*/
+PUGL_API
+VkResult
+puglCreateSwapchain(PuglView*                view,
+                    const PuglSwapchainInfo* info,
+                    PuglSwapchain**          swapchain);
+
+/**
+   Destroy a swapchain created with puglCreateSwapchain().
+
+   This waits for the device to be idle, so that no resources are destroyed
+   while they are in use.
+*/
+PUGL_API
+void
+puglDestroySwapchain(PuglSwapchain* swapchain);
+
+/// Return the surface format of the swapchain images
+PUGL_API
+VkSurfaceFormatKHR
+puglGetSwapchainFormat(const PuglSwapchain* swapchain);
+
+/**
+   Acquire the next image to draw a frame to.
+
+   This should be called while handling a #PUGL_EXPOSE event.  It waits until
+   the resources for the next frame in flight are no longer in use, and
+   recreates the swapchain first if necessary.  When this happens, the
+   `recreated` field of `image` is set, and any objects that depend on the
+   swapchain images, like framebuffers, must be recreated.
+
+   @return `VK_SUCCESS` on success, `VK_NOT_READY` if the view currently has no
+   area to draw to (so the frame should be skipped), or a Vulkan error code.
+*/
+PUGL_API
+VkResult
+puglAcquireSwapchainImage(PuglSwapchain* swapchain, PuglSwapchainImage* image);
+
+/**
+   Present an image that was acquired with puglAcquireSwapchainImage().
+
+   If the swapchain is out of date or suboptimal, then this still succeeds,
+   and the swapchain is recreated before the next image is acquired.
+
+   @return `VK_SUCCESS` on success, or a Vulkan error code.
+*/
+PUGL_API
+VkResult
+puglPresentSwapchainImage(PuglSwapchain*            swapchain,
+                          const PuglSwapchainImage* image);
+
 /**
    Vulkan graphics backend.
 
@@ -0,0 +1,38 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef PUGL_SRC_ALLOCATOR_H
+#define PUGL_SRC_ALLOCATOR_H
+
+#include "types.h"
+
+#include "pugl/pugl.h"
+
+#include <stddef.h>
+
+PUGL_BEGIN_DECLS
+
+/// Allocate `count` zeroed objects of `size` bytes with the world's allocator
+static inline void*
+puglCalloc(const PuglWorld* const world, const size_t count, const size_t size)
+{
+  return world->allocator.callocFunc(world->allocator.handle, count, size);
+}
+
+/// Resize an allocation with the world's allocator
+static inline void*
+puglRealloc(const PuglWorld* const world, void* const ptr, const size_t size)
+{
+  return world->allocator.reallocFunc(world->allocator.handle, ptr, size);
+}
+
+/// Free an allocation made with the world's allocator
+static inline void
+puglFree(const PuglWorld* const world, void* const ptr)
+{
+  world->allocator.freeFunc(world->allocator.handle, ptr);
+}
+
+PUGL_END_DECLS
+
+#endif // PUGL_SRC_ALLOCATOR_H
@@ -0,0 +1,236 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "cairo_layers.h"
+
+#include "allocator.h"
+#include "types.h"
+
+#include "pugl/cairo.h"
+#include "pugl/pugl.h"
+
+#include <cairo.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+static PuglCairoLayer*
+puglCairoFindLayer(PuglCairoLayers* const layers, const char* const name)
+{
+  for (size_t i = 0u; i < layers->numLayers; ++i) {
+    if (!strcmp(layers->layers[i].name, name)) {
+      return &layers->layers[i];
+    }
+  }
+
+  return NULL;
+}
+
+/// Return the layers of a Cairo view, or set `st` to the reason there are none
+static PuglCairoLayers*
+puglCairoGetViewLayers(PuglView* const view, PuglStatus* const st)
+{
+  PuglCairoLayers* layers = NULL;
+
+  if (puglGetBackend(view) != puglCairoBackend()) {
+    *st = PUGL_BAD_BACKEND;
+  } else if (!(layers = puglCairoGetLayers(view))) {
+    *st = PUGL_FAILURE;
+  }
+
+  return layers;
+}
+
+/// Schedule a redraw of a view if it has been realized
+static PuglStatus
+puglCairoRedisplay(PuglView* const view)
+{
+  return puglGetNativeWindow(view) ? puglPostRedisplay(view) : PUGL_SUCCESS;
+}
+
+/// Draw a layer into its cached surface, which is (re)created if necessary
+static PuglStatus
+puglCairoDrawLayer(PuglView* const        view,
+                   PuglCairoLayer* const  layer,
+                   cairo_surface_t* const target)
+{
+  const PuglRect frame = puglGetFrame(view);
+
+  // Discard the cached surface if the view has been resized
+  if (layer->surface &&
+      (layer->width != frame.width || layer->height != frame.height)) {
+    cairo_surface_destroy(layer->surface);
+    layer->surface = NULL;
+  }
+
+  if (!layer->surface) {
+    layer->width   = frame.width;
+    layer->height  = frame.height;
+    layer->surface = cairo_surface_create_similar(target,
+                                                  CAIRO_CONTENT_COLOR_ALPHA,
+                                                  (int)frame.width,
+                                                  (int)frame.height);
+  }
+
+  if (cairo_surface_status(layer->surface)) {
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
+
+  cairo_t* const cr = cairo_create(layer->surface);
+
+  // Clear any previous contents
+  cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint(cr);
+  cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+
+  layer->drawLayer(view, cr);
+
+  cairo_destroy(cr);
+  cairo_surface_flush(layer->surface);
+  layer->invalid = false;
+  return PUGL_SUCCESS;
+}
+
+PuglStatus
+puglCairoDrawLayers(PuglView* const              view,
+                    PuglCairoLayers* const       layers,
+                    cairo_t* const               cr,
+                    const PuglExposeEvent* const expose)
+{
+  const PuglRect         frame  = puglGetFrame(view);
+  cairo_surface_t* const target = cairo_get_target(cr);
+  PuglStatus             st     = PUGL_SUCCESS;
+
+  cairo_save(cr);
+  cairo_rectangle(cr, expose->x, expose->y, expose->width, expose->height);
+  cairo_clip(cr);
+
+  for (size_t i = 0u; !st && i < layers->numLayers; ++i) {
+    PuglCairoLayer* const layer = &layers->layers[i];
+
+    if (layer->width != frame.width || layer->height != frame.height) {
+      layer->invalid = true; // View has been resized
+    }
+
+    if (layer->invalid && (st = puglCairoDrawLayer(view, layer, target))) {
+      break;
+    }
+
+    cairo_set_source_surface(cr, layer->surface, 0.0, 0.0);
+    cairo_paint(cr);
+  }
+
+  cairo_restore(cr);
+  return st;
+}
+
+void
+puglCairoFreeLayers(PuglView* const view, PuglCairoLayers* const layers)
+{
+  for (size_t i = 0u; i < layers->numLayers; ++i) {
+    cairo_surface_destroy(layers->layers[i].surface);
+    puglFree(view->world, layers->layers[i].name);
+  }
+
+  puglFree(view->world, layers->layers);
+  layers->layers    = NULL;
+  layers->numLayers = 0u;
+}
+
+PuglStatus
+puglAddCairoLayer(PuglView* const          view,
+                  const char* const        name,
+                  const PuglCairoLayerFunc drawLayer)
+{
+  PuglStatus             st     = PUGL_SUCCESS;
+  PuglCairoLayers* const layers = puglCairoGetViewLayers(view, &st);
+  if (!layers) {
+    return st;
+  }
+
+  if (!name || !drawLayer) {
+    return PUGL_BAD_PARAMETER;
+  }
+
+  // Replace the draw function of an existing layer with the same name
+  PuglCairoLayer* layer = puglCairoFindLayer(layers, name);
+  if (layer) {
+    layer->drawLayer = drawLayer;
+    layer->invalid   = true;
+    return puglCairoRedisplay(view);
+  }
+
+  // Otherwise, add a new layer to the top
+  const size_t len     = strlen(name);
+  char* const  newName = (char*)puglCalloc(view->world, len + 1u, 1u);
+  if (!newName) {
+    return PUGL_NO_MEMORY;
+  }
+
+  PuglCairoLayer* const newLayers = (PuglCairoLayer*)puglRealloc(
+    view->world,
+    layers->layers,
+    (layers->numLayers + 1u) * sizeof(PuglCairoLayer));
+  if (!newLayers) {
+    puglFree(view->world, newName);
+    return PUGL_NO_MEMORY;
+  }
+
+  memcpy(newName, name, len + 1u);
+
+  layer            = &newLayers[layers->numLayers++];
+  layer->name      = newName;
+  layer->drawLayer = drawLayer;
+  layer->surface   = NULL;
+  layer->width     = 0u;
+  layer->height    = 0u;
+  layer->invalid   = true;
+  layers->layers   = newLayers;
+
+  return puglCairoRedisplay(view);
+}
+
+PuglStatus
+puglRemoveCairoLayer(PuglView* const view, const char* const name)
+{
+  PuglStatus             st     = PUGL_SUCCESS;
+  PuglCairoLayers* const layers = puglCairoGetViewLayers(view, &st);
+  if (!layers) {
+    return st;
+  }
+
+  PuglCairoLayer* const layer = name ? puglCairoFindLayer(layers, name) : NULL;
+  if (!layer) {
+    return PUGL_BAD_PARAMETER;
+  }
+
+  // Free the layer and shift the layers above it down
+  const size_t index = (size_t)(layer - layers->layers);
+  cairo_surface_destroy(layer->surface);
+  puglFree(view->world, layer->name);
+  memmove(layer,
+          layer + 1,
+          (layers->numLayers - index - 1u) * sizeof(PuglCairoLayer));
+
+  --layers->numLayers;
+  return puglCairoRedisplay(view);
+}
+
+PuglStatus
+puglInvalidateCairoLayer(PuglView* const view, const char* const name)
+{
+  PuglStatus             st     = PUGL_SUCCESS;
+  PuglCairoLayers* const layers = puglCairoGetViewLayers(view, &st);
+  if (!layers) {
+    return st;
+  }
+
+  PuglCairoLayer* const layer = name ? puglCairoFindLayer(layers, name) : NULL;
+  if (!layer) {
+    return PUGL_BAD_PARAMETER;
+  }
+
+  layer->invalid = true;
+  return puglCairoRedisplay(view);
+}
@@ -0,0 +1,55 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef PUGL_SRC_CAIRO_LAYERS_H
+#define PUGL_SRC_CAIRO_LAYERS_H
+
+#include "pugl/cairo.h"
+#include "pugl/pugl.h"
+
+#include <cairo.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+
+PUGL_BEGIN_DECLS
+
+/// A retained layer, redrawn only when it is invalidated or resized
+typedef struct {
+  char*              name;
+  PuglCairoLayerFunc drawLayer;
+  cairo_surface_t*   surface; ///< Cached contents, or null if not drawn yet
+  PuglSpan           width;   ///< Width of the cached surface
+  PuglSpan           height;  ///< Height of the cached surface
+  bool               invalid; ///< True if the layer must be redrawn
+} PuglCairoLayer;
+
+/// The stack of layers of a view, from bottom to top
+typedef struct {
+  PuglCairoLayer* layers;
+  size_t          numLayers;
+} PuglCairoLayers;
+
+/**
+   Return the layers of a view (implemented once per platform).
+
+   @return The layers of the view, which may be allocated on demand, or null
+   if they are not available.
+*/
+PuglCairoLayers*
+puglCairoGetLayers(PuglView* view);
+
+/// Redraw any invalid layers, and composite all layers to the exposed region
+PuglStatus
+puglCairoDrawLayers(PuglView*              view,
+                    PuglCairoLayers*       layers,
+                    cairo_t*               cr,
+                    const PuglExposeEvent* expose);
+
+/// Free all layers of `view` and their cached surfaces
+void
+puglCairoFreeLayers(PuglView* view, PuglCairoLayers* layers);
+
+PUGL_END_DECLS
+
+#endif // PUGL_SRC_CAIRO_LAYERS_H
@@ -3,6 +3,7 @@
 
 #include "implementation.h"
 
+#include "allocator.h"
 #include "types.h"
 
 #include "pugl/pugl.h"
@@ -37,25 +38,30 @@ puglStrerror(const PuglStatus status)
 }
 
 void
-puglSetString(char** dest, const char* string)
+puglSetString(const PuglWorld* const world,
+              char** const           dest,
+              const char* const      string)
 {
   if (*dest != string) {
-    const size_t len = strlen(string);
-
-    *dest = (char*)realloc(*dest, len + 1);
-    strncpy(*dest, string, len + 1);
+    const size_t len  = strlen(string);
+    char* const  copy = (char*)puglRealloc(world, *dest, len + 1);
+    if (copy) { // Otherwise, keep the old string
+      strncpy(copy, string, len + 1);
+      *dest = copy;
+    }
   }
 }
 
 PuglStatus
-puglSetBlob(PuglBlob* const dest, const void* const data, const size_t len)
+puglSetBlob(const PuglWorld* const world,
+            PuglBlob* const        dest,
+            const void* const      data,
+            const size_t           len)
 {
   if (data) {
-    void* const newData = realloc(dest->data, len + 1);
+    void* const newData = puglRealloc(world, dest->data, len + 1);
     if (!newData) {
-      free(dest->data);
-      dest->len = 0;
-      return PUGL_NO_MEMORY;
+      return PUGL_NO_MEMORY; // Keep the old data
     }
 
     memcpy(newData, data, len);
@@ -89,20 +95,68 @@ puglSetDefaultHints(PuglHints hints)
   hints[PUGL_RESIZABLE]             = PUGL_FALSE;
   hints[PUGL_IGNORE_KEY_REPEAT]     = PUGL_FALSE;
   hints[PUGL_REFRESH_RATE]          = PUGL_DONT_CARE;
+  hints[PUGL_PREFETCH_CLIPBOARD]    = PUGL_FALSE;
+  hints[PUGL_ADAPTIVE_SWAP]         = PUGL_FALSE;
+  hints[PUGL_RENDER_THREAD]         = PUGL_FALSE;
+  hints[PUGL_DRAW_TIMING]           = PUGL_FALSE;
+}
+
+static void*
+puglDefaultCalloc(void* const handle, const size_t count, const size_t size)
+{
+  (void)handle;
+  return calloc(count, size);
+}
+
+static void*
+puglDefaultRealloc(void* const handle, void* const ptr, const size_t size)
+{
+  (void)handle;
+  return realloc(ptr, size);
+}
+
+static void
+puglDefaultFree(void* const handle, void* const ptr)
+{
+  (void)handle;
+  free(ptr);
 }
 
 PuglWorld*
 puglNewWorld(PuglWorldType type, PuglWorldFlags flags)
 {
-  PuglWorld* world = (PuglWorld*)calloc(1, sizeof(PuglWorld));
-  if (!world || !(world->impl = puglInitWorldInternals(type, flags))) {
-    free(world);
+  return puglNewWorldWithAllocator(type, flags, NULL);
+}
+
+PuglWorld*
+puglNewWorldWithAllocator(const PuglWorldType        type,
+                          const PuglWorldFlags       flags,
+                          const PuglAllocator* const allocator)
+{
+  static const PuglAllocator defaultAllocator = {
+    puglDefaultCalloc, puglDefaultRealloc, puglDefaultFree, NULL};
+
+  const PuglAllocator* const a = allocator ? allocator : &defaultAllocator;
+  if (!a->callocFunc || !a->reallocFunc || !a->freeFunc) {
     return NULL;
   }
 
-  world->startTime = puglGetTime(world);
+  PuglWorld* const world =
+    (PuglWorld*)a->callocFunc(a->handle, 1, sizeof(PuglWorld));
+  if (!world) {
+    return NULL;
+  }
 
-  puglSetString(&world->className, "Pugl");
+  world->allocator = *a;
+  if (!(world->impl = puglInitWorldInternals(world, type, flags))) {
+    a->freeFunc(a->handle, world);
+    return NULL;
+  }
+
+  world->startTime  = puglGetTime(world);
+  world->idleBudget = 0.005;
+
+  puglSetString(world, &world->className, "Pugl");
 
   return world;
 }
@@ -110,10 +164,13 @@ puglNewWorld(PuglWorldType type, PuglWorldFlags flags)
 void
 puglFreeWorld(PuglWorld* const world)
 {
+  const PuglAllocator allocator = world->allocator;
+
   puglFreeWorldInternals(world);
-  free(world->className);
-  free(world->views);
-  free(world);
+  puglFree(world, world->className);
+  puglFree(world, world->idleTasks);
+  puglFree(world, world->views);
+  allocator.freeFunc(allocator.handle, world);
 }
 
 void
@@ -131,7 +188,7 @@ puglGetWorldHandle(PuglWorld* world)
 PuglStatus
 puglSetClassName(PuglWorld* const world, const char* const name)
 {
-  puglSetString(&world->className, name);
+  puglSetString(world, &world->className, name);
   return PUGL_SUCCESS;
 }
 
@@ -141,12 +198,80 @@ puglGetClassName(const PuglWorld* world)
   return world->className;
 }
 
+void
+puglSetLogFunc(PuglWorld* world, PuglLogFunc logFunc)
+{
+  world->logFunc = logFunc;
+}
+
+PuglStatus
+puglAddIdleTask(PuglWorld* const   world,
+                const PuglIdleFunc func,
+                void* const        data)
+{
+  const size_t        size = (world->numIdleTasks + 1u) * sizeof(PuglIdleTask);
+  PuglIdleTask* const tasks =
+    (PuglIdleTask*)puglRealloc(world, world->idleTasks, size);
+  if (!tasks) {
+    return PUGL_NO_MEMORY;
+  }
+
+  world->idleTasks                           = tasks;
+  world->idleTasks[world->numIdleTasks].func = func;
+  world->idleTasks[world->numIdleTasks].data = data;
+  ++world->numIdleTasks;
+  return PUGL_SUCCESS;
+}
+
+PuglStatus
+puglRemoveIdleTask(PuglWorld* const   world,
+                   const PuglIdleFunc func,
+                   void* const        data)
+{
+  for (size_t i = 0u; i < world->numIdleTasks; ++i) {
+    if (world->idleTasks[i].func == func && world->idleTasks[i].data == data) {
+      memmove(world->idleTasks + i,
+              world->idleTasks + i + 1u,
+              (world->numIdleTasks - i - 1u) * sizeof(PuglIdleTask));
+
+      // Keep the next task to run the same, so the rotation stays fair
+      if (i < world->nextIdleTask) {
+        --world->nextIdleTask;
+      }
+
+      --world->numIdleTasks;
+      return PUGL_SUCCESS;
+    }
+  }
+
+  return PUGL_FAILURE;
+}
+
+PuglStatus
+puglSetIdleBudget(PuglWorld* const world, const double budget)
+{
+  if (budget < 0.0) {
+    return PUGL_BAD_PARAMETER;
+  }
+
+  world->idleBudget = budget;
+  return PUGL_SUCCESS;
+}
+
+void
+puglLog(PuglWorld* world, const PuglLogLevel level, const char* msg)
+{
+  if (world->logFunc) {
+    world->logFunc(world, level, msg);
+  }
+}
+
 PuglView*
 puglNewView(PuglWorld* const world)
 {
-  PuglView* view = (PuglView*)calloc(1, sizeof(PuglView));
+  PuglView* view = (PuglView*)puglCalloc(world, 1, sizeof(PuglView));
   if (!view || !(view->impl = puglInitViewInternals(world))) {
-    free(view);
+    puglFree(world, view);
     return NULL;
   }
 
@@ -157,11 +282,16 @@ puglNewView(PuglWorld* const world)
   puglSetDefaultHints(view->hints);
 
   // Add to world view list
-  ++world->numViews;
-  world->views =
-    (PuglView**)realloc(world->views, world->numViews * sizeof(PuglView*));
+  PuglView** const views = (PuglView**)puglRealloc(
+    world, world->views, (world->numViews + 1u) * sizeof(PuglView*));
+  if (!views) {
+    puglFreeViewInternals(view);
+    puglFree(world, view);
+    return NULL;
+  }
 
-  world->views[world->numViews - 1] = view;
+  world->views                    = views;
+  world->views[world->numViews++] = view;
 
   return view;
 }
@@ -189,9 +319,10 @@ puglFreeView(PuglView* view)
     }
   }
 
-  free(view->title);
+  puglFree(world, view->title);
+  puglFreeVirtualViews(view);
   puglFreeViewInternals(view);
-  free(view);
+  puglFree(world, view);
 }
 
 PuglWorld*
@@ -382,12 +513,37 @@ puglDecodeUTF8(const uint8_t* buf)
   return 0xFFFD;
 }
 
-static inline bool
+bool
 puglMustConfigure(PuglView* view, const PuglConfigureEvent* configure)
 {
   return !!memcmp(configure, &view->lastConfigure, sizeof(PuglConfigureEvent));
 }
 
+void
+puglRunIdleTasks(PuglWorld* const world, const double deadline)
+{
+  const double budgetEnd = puglGetTime(world) + world->idleBudget;
+  const double endTime =
+    (deadline >= 0.0 && deadline < budgetEnd) ? deadline : budgetEnd;
+
+  if (!world->numIdleTasks) {
+    return;
+  }
+
+  // Run at least one task, so tasks always make progress
+  do {
+    if (world->nextIdleTask >= world->numIdleTasks) {
+      world->nextIdleTask = 0u;
+    }
+
+    // Call the task, which may add or remove tasks (including itself)
+    const PuglIdleTask task = world->idleTasks[world->nextIdleTask++];
+    if (!task.func(world, task.data)) {
+      puglRemoveIdleTask(world, task.func, task.data);
+    }
+  } while (world->numIdleTasks && puglGetTime(world) < endTime);
+}
+
 PuglStatus
 puglDispatchSimpleEvent(PuglView* view, const PuglEventType type)
 {
@@ -422,9 +578,15 @@ puglConfigure(PuglView* view, const PuglEvent* event)
 PuglStatus
 puglExpose(PuglView* view, const PuglEvent* event)
 {
-  return (event->expose.width > 0.0 && event->expose.height > 0.0)
-           ? view->eventFunc(view, event)
-           : PUGL_SUCCESS;
+  if (!(event->expose.width > 0.0 && event->expose.height > 0.0)) {
+    return PUGL_SUCCESS;
+  }
+
+  // Draw the view, then any virtual views on top of it
+  const PuglStatus st0 = view->eventFunc(view, event);
+  const PuglStatus st1 = puglExposeVirtualViews(view, &event->expose);
+
+  return st0 ? st0 : st1;
 }
 
 PuglStatus
@@ -470,7 +632,9 @@ puglDispatchEvent(PuglView* view, const PuglEvent* event)
     }
     break;
   default:
-    st0 = view->eventFunc(view, event);
+    if (!puglDispatchVirtualEvent(view, event, &st0)) {
+      st0 = view->eventFunc(view, event);
+    }
   }
 
   return st0 ? st0 : st1;
@@ -9,6 +9,7 @@
 
 #include "pugl/pugl.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -16,15 +17,20 @@ PUGL_BEGIN_DECLS
 
 /// Set `blob` to `data` with length `len`, reallocating if necessary
 PuglStatus
-puglSetBlob(PuglBlob* dest, const void* data, size_t len);
+puglSetBlob(const PuglWorld* world,
+            PuglBlob*        dest,
+            const void*      data,
+            size_t           len);
 
 /// Reallocate and set `*dest` to `string`
 void
-puglSetString(char** dest, const char* string);
+puglSetString(const PuglWorld* world, char** dest, const char* string);
 
 /// Allocate and initialise world internals (implemented once per platform)
 PuglWorldInternals*
-puglInitWorldInternals(PuglWorldType type, PuglWorldFlags flags);
+puglInitWorldInternals(PuglWorld*     world,
+                       PuglWorldType  type,
+                       PuglWorldFlags flags);
 
 /// Destroy and free world internals (implemented once per platform)
 void
@@ -38,6 +44,10 @@ puglInitViewInternals(PuglWorld* world);
 void
 puglFreeViewInternals(PuglView* view);
 
+/// Log a message with the world's log function, if any
+void
+puglLog(PuglWorld* world, PuglLogLevel level, const char* msg);
+
 /// Return the Unicode code point for `buf` or the replacement character
 uint32_t
 puglDecodeUTF8(const uint8_t* buf);
@@ -46,6 +56,10 @@ puglDecodeUTF8(const uint8_t* buf);
 PuglStatus
 puglDispatchSimpleEvent(PuglView* view, PuglEventType type);
 
+/// Return true if `configure` differs from the last one sent to `view`
+bool
+puglMustConfigure(PuglView* view, const PuglConfigureEvent* configure);
+
 /// Process configure event while already in the graphics context
 PUGL_WARN_UNUSED_RESULT
 PuglStatus
@@ -60,6 +74,36 @@ puglExpose(PuglView* view, const PuglEvent* event);
 PuglStatus
 puglDispatchEvent(PuglView* view, const PuglEvent* event);
 
+/**
+   Dispatch an input event to the virtual view that should receive it, if any.
+
+   @return True if the event was dispatched to a virtual view, in which case
+   the result is written to `status` and the event must not be dispatched to
+   the parent.
+*/
+bool
+puglDispatchVirtualEvent(PuglView*        view,
+                         const PuglEvent* event,
+                         PuglStatus*      status);
+
+/// Expose the visible virtual views of `view` in the exposed region
+PuglStatus
+puglExposeVirtualViews(PuglView* view, const PuglExposeEvent* expose);
+
+/// Free all virtual views of `view`
+void
+puglFreeVirtualViews(PuglView* view);
+
+/**
+   Run idle tasks in turn until the idle budget is used.
+
+   @param world The world.
+   @param deadline Time to stop running tasks even if the budget isn't used,
+   or a negative value if there is no deadline.
+*/
+void
+puglRunIdleTasks(PuglWorld* world, double deadline);
+
 PUGL_END_DECLS
 
 #endif // PUGL_IMPLEMENTATION_H
@@ -6,6 +6,7 @@
 
 #include "mac.h"
 
+#include "allocator.h"
 #include "implementation.h"
 
 #include "pugl/pugl.h"
@@ -905,10 +906,15 @@ handleCrossing(PuglWrapperView* view, NSEvent* event, const PuglEventType type)
 @end
 
 PuglWorldInternals*
-puglInitWorldInternals(PuglWorldType type, PuglWorldFlags PUGL_UNUSED(flags))
+puglInitWorldInternals(PuglWorld*     world,
+                       PuglWorldType  type,
+                       PuglWorldFlags PUGL_UNUSED(flags))
 {
   PuglWorldInternals* impl =
-    (PuglWorldInternals*)calloc(1, sizeof(PuglWorldInternals));
+    (PuglWorldInternals*)puglCalloc(world, 1, sizeof(PuglWorldInternals));
+  if (!impl) {
+    return NULL;
+  }
 
   impl->app = [NSApplication sharedApplication];
 
@@ -928,7 +934,7 @@ puglFreeWorldInternals(PuglWorld* world)
     [world->impl->autoreleasePool drain];
   }
 
-  free(world->impl);
+  puglFree(world, world->impl);
 }
 
 void*
@@ -938,9 +944,13 @@ puglGetNativeWorld(PuglWorld* world)
 }
 
 PuglInternals*
-puglInitViewInternals(PuglWorld* PUGL_UNUSED(world))
+puglInitViewInternals(PuglWorld* world)
 {
-  PuglInternals* impl = (PuglInternals*)calloc(1, sizeof(PuglInternals));
+  PuglInternals* impl =
+    (PuglInternals*)puglCalloc(world, 1, sizeof(PuglInternals));
+  if (!impl) {
+    return NULL;
+  }
 
   impl->cursor = [NSCursor arrowCursor];
 
@@ -1219,7 +1229,7 @@ puglFreeViewInternals(PuglView* view)
         [view->impl->window release];
       }
 
-      free(view->impl);
+      puglFree(view->world, view->impl);
     }
   }
 }
@@ -1346,9 +1356,14 @@ PuglStatus
 puglUpdate(PuglWorld* world, const double timeout)
 {
   @autoreleasepool {
+    const double startTime = puglGetTime(world);
+
+    // Don't wait for events if there are idle tasks to run afterwards
     NSDate* date =
-      ((timeout < 0) ? [NSDate distantFuture]
-                     : [NSDate dateWithTimeIntervalSinceNow:timeout]);
+      (world->numIdleTasks
+         ? [NSDate date]
+         : ((timeout < 0) ? [NSDate distantFuture]
+                          : [NSDate dateWithTimeIntervalSinceNow:timeout]));
 
     for (NSEvent* ev = NULL;
          (ev = [world->impl->app nextEventMatchingMask:NSAnyEventMask
@@ -1378,6 +1393,10 @@ puglUpdate(PuglWorld* world, const double timeout)
 
       [view->impl->drawView displayIfNeeded];
     }
+
+    if (world->numIdleTasks) {
+      puglRunIdleTasks(world, timeout > 0.0 ? startTime + timeout : -1.0);
+    }
   }
 
   return PUGL_SUCCESS;
@@ -1391,6 +1410,38 @@ puglProcessEvents(PuglView* view)
 }
 #endif
 
+PuglStatus
+puglPrepareUpdate(PuglWorld* world, double* timeout)
+{
+  (void)world;
+
+  *timeout = 0.0;
+  return PUGL_UNSUPPORTED;
+}
+
+size_t
+puglGetUpdateFds(const PuglWorld* world, int* fds, size_t maxFds)
+{
+  (void)world;
+  (void)fds;
+  (void)maxFds;
+
+  return 0u;
+}
+
+bool
+puglCheckUpdate(PuglWorld* world)
+{
+  (void)world;
+  return true;
+}
+
+PuglStatus
+puglDispatchUpdate(PuglWorld* world)
+{
+  return puglUpdate(world, 0.0);
+}
+
 double
 puglGetTime(const PuglWorld* world)
 {
@@ -1423,7 +1474,7 @@ puglGetNativeWindow(PuglView* view)
 PuglStatus
 puglSetWindowTitle(PuglView* view, const char* title)
 {
-  puglSetString(&view->title, title);
+  puglSetString(view->world, &view->title, title);
 
   if (view->impl->window) {
     NSString* titleString =
@@ -1725,3 +1776,37 @@ puglSetClipboard(PuglView*         PUGL_UNUSED(view),
 
   return PUGL_FAILURE;
 }
+
+PuglStatus
+puglOfferClipboard(PuglView* const          view,
+                   const char* const* const types,
+                   const uint32_t           numTypes,
+                   const PuglClipboardFunc  provider)
+{
+  if (!numTypes || !provider) {
+    return PUGL_BAD_PARAMETER;
+  }
+
+  NSPasteboard* const   pasteboard = [NSPasteboard generalPasteboard];
+  NSMutableArray* const utis = [NSMutableArray arrayWithCapacity:numTypes];
+  for (uint32_t i = 0u; i < numTypes; ++i) {
+    [utis addObject:utiForMimeType([NSString stringWithUTF8String:types[i]])];
+  }
+
+  [pasteboard declareTypes:utis owner:nil];
+
+  // Data can't be provided on demand here, so set every type immediately
+  PuglStatus st = PUGL_SUCCESS;
+  for (uint32_t i = 0u; i < numTypes; ++i) {
+    size_t            len  = 0;
+    const void* const data = provider(view, i, &len);
+    if (data) {
+      NSData* const blob = [NSData dataWithBytes:data length:len];
+      if (![pasteboard setData:blob forType:[utis objectAtIndex:i]]) {
+        st = PUGL_FAILURE;
+      }
+    }
+  }
+
+  return st;
+}
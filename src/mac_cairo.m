@@ -1,6 +1,7 @@
 // Copyright 2019-2022 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
+#include "cairo_layers.h"
 #include "implementation.h"
 #include "mac.h"
 #include "stub.h"
@@ -21,6 +22,7 @@
   PuglView*        puglview;
   cairo_surface_t* surface;
   cairo_t*         cr;
+  PuglCairoLayers  layers;
 }
 
 - (id)initWithFrame:(NSRect)frame
@@ -69,6 +71,10 @@ puglMacCairoDestroy(PuglView* view)
 {
   PuglCairoView* const drawView = (PuglCairoView*)view->impl->drawView;
 
+  if (drawView) {
+    puglCairoFreeLayers(view, &drawView->layers);
+  }
+
   [drawView removeFromSuperview];
   [drawView release];
 
@@ -104,7 +110,9 @@ puglMacCairoEnter(PuglView* view, const PuglExposeEvent* expose)
 
   drawView->cr = cairo_create(drawView->surface);
 
-  return PUGL_SUCCESS;
+  return drawView->layers.numLayers
+           ? puglCairoDrawLayers(view, &drawView->layers, drawView->cr, expose)
+           : PUGL_SUCCESS;
 }
 
 static PuglStatus
@@ -136,6 +144,28 @@ puglMacCairoGetContext(PuglView* view)
   return ((PuglCairoView*)view->impl->drawView)->cr;
 }
 
+PuglCairoLayers*
+puglCairoGetLayers(PuglView* view)
+{
+  // Layers are stored in the draw view, which only exists once realized
+  PuglCairoView* const drawView = (PuglCairoView*)view->impl->drawView;
+
+  return drawView ? &drawView->layers : NULL;
+}
+
+PuglStatus
+puglSetCairoTileFunc(PuglView*         view,
+                     PuglCairoTileFunc drawTile,
+                     unsigned          numThreads,
+                     PuglSpan          tileSize)
+{
+  (void)drawTile;
+  (void)numThreads;
+  (void)tileSize;
+  return view->backend == puglCairoBackend() ? PUGL_UNSUPPORTED
+                                             : PUGL_BAD_BACKEND;
+}
+
 const PuglBackend*
 puglCairoBackend(void)
 {
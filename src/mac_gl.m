@@ -47,6 +47,11 @@
     puglview->hints[PUGL_SWAP_INTERVAL] = 1;
   }
 
+  // Adaptive swapping, render threads, and draw timing aren't supported
+  puglview->hints[PUGL_ADAPTIVE_SWAP] = PUGL_FALSE;
+  puglview->hints[PUGL_RENDER_THREAD] = PUGL_FALSE;
+  puglview->hints[PUGL_DRAW_TIMING]   = PUGL_FALSE;
+
   const unsigned colorSize = (unsigned)(puglview->hints[PUGL_RED_BITS] +
                                         puglview->hints[PUGL_BLUE_BITS] +
                                         puglview->hints[PUGL_GREEN_BITS] +
@@ -71,6 +76,24 @@
 
   if (pixelFormat) {
     self = [super initWithFrame:frame pixelFormat:pixelFormat];
+
+    PuglView* const shareView = puglview->shareView;
+    if (self && shareView && shareView->backend == puglview->backend &&
+        shareView->impl->drawView) {
+      // Replace the context with one that shares objects with the share view
+      PuglOpenGLView* const shareDrawView =
+        (PuglOpenGLView*)shareView->impl->drawView;
+
+      NSOpenGLContext* const context = [[NSOpenGLContext alloc]
+        initWithFormat:pixelFormat
+          shareContext:[shareDrawView openGLContext]];
+
+      if (context) {
+        [self setOpenGLContext:context];
+        [context release];
+      }
+    }
+
     [pixelFormat release];
   } else {
     self = [super initWithFrame:frame];
@@ -174,6 +197,40 @@ puglGetProcAddress(const char* name)
   return func;
 }
 
+unsigned
+puglGetBufferAge(PuglView* view)
+{
+  (void)view;
+  return 0u;
+}
+
+PuglStatus
+puglGetFrameTiming(PuglView* view, PuglFrameTiming* timing)
+{
+  (void)view;
+  (void)timing;
+  return PUGL_UNSUPPORTED;
+}
+
+PuglStatus
+puglGetDrawTiming(PuglView* view, PuglDrawTiming* timing)
+{
+  (void)view;
+  (void)timing;
+  return PUGL_UNSUPPORTED;
+}
+
+PuglStatus
+puglSetShareView(PuglView* view, PuglView* shareView)
+{
+  if (view->impl->drawView) {
+    return PUGL_FAILURE;
+  }
+
+  view->shareView = shareView;
+  return PUGL_SUCCESS;
+}
+
 PuglStatus
 puglEnterContext(PuglView* view)
 {
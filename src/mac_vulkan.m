@@ -3,6 +3,7 @@
 
 #define VK_NO_PROTOTYPES 1
 
+#include "allocator.h"
 #include "implementation.h"
 #include "mac.h"
 #include "stub.h"
@@ -101,25 +102,29 @@ puglMacVulkanDestroy(PuglView* view)
 }
 
 struct PuglVulkanLoaderImpl {
+  PuglAllocator             allocator; ///< Allocator of the creating world
   void*                     libvulkan;
   PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
   PFN_vkGetDeviceProcAddr   vkGetDeviceProcAddr;
 };
 
 PuglVulkanLoader*
-puglNewVulkanLoader(PuglWorld* PUGL_UNUSED(world))
+puglNewVulkanLoader(PuglWorld* world)
 {
   PuglVulkanLoader* loader =
-    (PuglVulkanLoader*)calloc(1, sizeof(PuglVulkanLoader));
+    (PuglVulkanLoader*)puglCalloc(world, 1, sizeof(PuglVulkanLoader));
   if (!loader) {
     return NULL;
   }
 
   if (!(loader->libvulkan = dlopen("libvulkan.dylib", RTLD_LAZY))) {
-    free(loader);
+    puglFree(world, loader);
     return NULL;
   }
 
+  // The loader may outlive the world, so keep a copy of its allocator
+  loader->allocator = world->allocator;
+
   loader->vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)dlsym(
     loader->libvulkan, "vkGetInstanceProcAddr");
 
@@ -133,8 +138,10 @@ void
 puglFreeVulkanLoader(PuglVulkanLoader* loader)
 {
   if (loader) {
+    const PuglAllocator allocator = loader->allocator;
+
     dlclose(loader->libvulkan);
-    free(loader);
+    allocator.freeFunc(allocator.handle, loader);
   }
 }
 
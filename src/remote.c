@@ -0,0 +1,820 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifdef HAVE_MEMFD
+#  define _GNU_SOURCE // For memfd_create() and file sealing
+#endif
+
+#include "allocator.h"
+#include "types.h"
+
+#include "pugl/remote.h"
+
+#include "pugl/pixels.h"
+#include "pugl/pugl.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef MSG_NOSIGNAL
+#  define MSG_NOSIGNAL 0
+#endif
+
+/// An empty region, for resetting damage
+static const PuglRect emptyRect = {0, 0, 0u, 0u};
+
+/// Type of a message sent between a host and guest
+typedef enum {
+  PUGL_REMOTE_BUFFER, ///< Host to guest: new shared buffer, with descriptor
+  PUGL_REMOTE_EVENT,  ///< Host to guest: event to dispatch
+  PUGL_REMOTE_ACK,    ///< Host to guest: frame was copied, so draw may resume
+  PUGL_REMOTE_DAMAGE, ///< Guest to host: frame was drawn in a region
+} PuglRemoteMessageType;
+
+/// A message sent between a host and guest, which is always the same size
+typedef struct {
+  uint32_t  type;   ///< Message type
+  uint32_t  serial; ///< Serial number of the shared buffer
+  PuglRect  rect;   ///< Frame of a new buffer, or region that was drawn
+  uint64_t  stride; ///< Distance between rows of a new buffer in bytes
+  PuglEvent event;  ///< Event to dispatch
+} PuglRemoteMessage;
+
+struct PuglRemoteHostImpl {
+  PuglWorld*      world;
+  PuglView*       view;
+  int             socket;
+  PuglRect        frame;        ///< Region of the host view for the guest
+  void*           data;         ///< Shared buffer contents
+  size_t          size;         ///< Size of shared buffer in bytes
+  size_t          stride;       ///< Distance between buffer rows in bytes
+  uint32_t        serial;       ///< Serial number of the shared buffer
+  PuglRect        damage;       ///< Region drawn by guest but not yet copied
+  bool            framePending; ///< True if guest drew a frame to copy
+  const uint32_t* lastTarget;   ///< Pixels of the last buffer drawn to
+  PuglSpan        lastWidth;    ///< Width of the last buffer drawn to
+  PuglSpan        lastHeight;   ///< Height of the last buffer drawn to
+};
+
+struct PuglRemoteGuestImpl {
+  int                 socket;
+  PuglHandle          handle;
+  PuglRemoteEventFunc eventFunc;
+  PuglPixelBuffer     buffer;      ///< Shared buffer
+  size_t              size;        ///< Size of shared buffer in bytes
+  uint32_t            serial;      ///< Serial number of the shared buffer
+  PuglRect            pending;     ///< Region that must be redrawn
+  bool                drawing;     ///< True while handling an expose
+  bool                awaitingAck; ///< True until the host copies a frame
+};
+
+static bool
+puglRemoteIsEmpty(const PuglRect rect)
+{
+  return !rect.width || !rect.height;
+}
+
+/// Return the smallest rectangle that contains both `a` and `b`
+static PuglRect
+puglRemoteUnion(const PuglRect a, const PuglRect b)
+{
+  if (puglRemoteIsEmpty(a)) {
+    return b;
+  }
+
+  if (puglRemoteIsEmpty(b)) {
+    return a;
+  }
+
+  const int ax1 = a.x + (int)a.width;
+  const int ay1 = a.y + (int)a.height;
+  const int bx1 = b.x + (int)b.width;
+  const int by1 = b.y + (int)b.height;
+  const int x0  = a.x < b.x ? a.x : b.x;
+  const int y0  = a.y < b.y ? a.y : b.y;
+  const int x1  = ax1 > bx1 ? ax1 : bx1;
+  const int y1  = ay1 > by1 ? ay1 : by1;
+
+  const PuglRect result = {
+    (PuglCoord)x0, (PuglCoord)y0, (PuglSpan)(x1 - x0), (PuglSpan)(y1 - y0)};
+
+  return result;
+}
+
+/// Return a rectangle clipped to an area from the origin, which may be empty
+static PuglRect
+puglRemoteClip(const PuglRect rect, const PuglSpan width, const PuglSpan height)
+{
+  const int rx1 = rect.x + (int)rect.width;
+  const int ry1 = rect.y + (int)rect.height;
+  const int x0  = rect.x > 0 ? rect.x : 0;
+  const int y0  = rect.y > 0 ? rect.y : 0;
+  const int x1  = rx1 < (int)width ? rx1 : (int)width;
+  const int y1  = ry1 < (int)height ? ry1 : (int)height;
+
+  const PuglRect result = {(PuglCoord)x0,
+                           (PuglCoord)y0,
+                           (PuglSpan)(x1 > x0 ? x1 - x0 : 0),
+                           (PuglSpan)(y1 > y0 ? y1 - y0 : 0)};
+
+  return result;
+}
+
+/// Send a message, and optionally a file descriptor, over a socket
+static PuglStatus
+puglRemoteSend(const int socket, PuglRemoteMessage* const message, int fd)
+{
+  union {
+    struct cmsghdr header;
+    char           buf[CMSG_SPACE(sizeof(int))];
+  } control;
+
+  struct iovec  iov = {message, sizeof(PuglRemoteMessage)};
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov    = &iov;
+  msg.msg_iovlen = 1;
+
+  if (fd >= 0) {
+    memset(&control, 0, sizeof(control));
+    msg.msg_control    = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr* const header = CMSG_FIRSTHDR(&msg);
+    header->cmsg_level           = SOL_SOCKET;
+    header->cmsg_type            = SCM_RIGHTS;
+    header->cmsg_len             = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(header), &fd, sizeof(int));
+  }
+
+  ssize_t r = 0;
+  while ((r = sendmsg(socket, &msg, MSG_NOSIGNAL)) < 0 && errno == EINTR) {
+  }
+
+  if (r < 0) {
+    return errno == EPIPE ? PUGL_FAILURE : PUGL_UNKNOWN_ERROR;
+  }
+
+  // Send the rest of the message if the socket only accepted part of it
+  const char* const bytes = (const char*)message;
+  for (size_t offset = (size_t)r; offset < sizeof(PuglRemoteMessage);) {
+    if ((r = send(socket,
+                  bytes + offset,
+                  sizeof(PuglRemoteMessage) - offset,
+                  MSG_NOSIGNAL)) > 0) {
+      offset += (size_t)r;
+    } else if (r < 0 && errno != EINTR) {
+      return errno == EPIPE ? PUGL_FAILURE : PUGL_UNKNOWN_ERROR;
+    }
+  }
+
+  return PUGL_SUCCESS;
+}
+
+/// Receive a message, and any file descriptor sent with it, from a socket
+static PuglStatus
+puglRemoteReceive(const int socket, PuglRemoteMessage* const message, int* fd)
+{
+  union {
+    struct cmsghdr header;
+    char           buf[CMSG_SPACE(sizeof(int))];
+  } control;
+
+  struct iovec  iov = {message, sizeof(PuglRemoteMessage)};
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  memset(&control, 0, sizeof(control));
+  msg.msg_iov        = &iov;
+  msg.msg_iovlen     = 1;
+  msg.msg_control    = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+
+  *fd = -1;
+
+  ssize_t r = 0;
+  while ((r = recvmsg(socket, &msg, 0)) < 0 && errno == EINTR) {
+  }
+
+  if (r < 0) {
+    return errno == ECONNRESET ? PUGL_FAILURE : PUGL_UNKNOWN_ERROR;
+  }
+
+  if (!r) {
+    return PUGL_FAILURE; // Disconnected
+  }
+
+  for (struct cmsghdr* h = CMSG_FIRSTHDR(&msg); h; h = CMSG_NXTHDR(&msg, h)) {
+    if (h->cmsg_level == SOL_SOCKET && h->cmsg_type == SCM_RIGHTS) {
+      memcpy(fd, CMSG_DATA(h), sizeof(int));
+    }
+  }
+
+  // Receive the rest of the message if only part of it has arrived
+  char* const bytes = (char*)message;
+  for (size_t offset = (size_t)r; offset < sizeof(PuglRemoteMessage);) {
+    if ((r = recv(socket, bytes + offset, sizeof(*message) - offset, 0)) > 0) {
+      offset += (size_t)r;
+    } else if (!r || errno != EINTR) {
+      if (*fd >= 0) {
+        close(*fd);
+      }
+      return r ? PUGL_UNKNOWN_ERROR : PUGL_FAILURE;
+    }
+  }
+
+  return PUGL_SUCCESS;
+}
+
+/// Wait for a socket to be readable, and return true if it is
+static bool
+puglRemoteWait(const int socket, const double timeout)
+{
+  struct pollfd pfd = {socket, POLLIN, 0};
+
+  const int ms = timeout < 0.0 ? -1 : (int)(timeout * 1000.0);
+
+  int r = 0;
+  while ((r = poll(&pfd, 1, ms)) < 0 && errno == EINTR) {
+  }
+
+  return r > 0;
+}
+
+/**
+   Create a shared memory object and return a descriptor for it.
+
+   Where possible, this is a memory file sealed at its initial size, so the
+   guest can't shrink it while the host is reading from it.  Otherwise, it
+   falls back to an unsealed POSIX shared memory object.
+*/
+static int
+puglRemoteCreateShm(const size_t size)
+{
+#ifdef HAVE_MEMFD
+  const int memfd =
+    memfd_create("pugl-remote", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (memfd >= 0) {
+    if (ftruncate(memfd, (off_t)size) ||
+        fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)) {
+      close(memfd);
+      return -1;
+    }
+
+    return memfd;
+  }
+#endif
+
+  static unsigned counter = 0u;
+
+  char name[64] = {0};
+  int  fd       = -1;
+  for (unsigned i = 0u; fd < 0 && i < 16u; ++i) {
+    snprintf(name, sizeof(name), "/pugl-%ld-%u", (long)getpid(), counter++);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  }
+
+  if (fd < 0) {
+    return -1;
+  }
+
+  // Remove the name, so the memory is freed once both sides are finished
+  shm_unlink(name);
+
+  if (ftruncate(fd, (off_t)size)) {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+/// Translate an event to be relative to a remote view
+static void
+puglRemoteTranslateEvent(PuglEvent* const event,
+                         const double     dx,
+                         const double     dy)
+{
+  switch (event->type) {
+  case PUGL_KEY_PRESS:
+  case PUGL_KEY_RELEASE:
+    event->key.x -= dx;
+    event->key.y -= dy;
+    break;
+  case PUGL_TEXT:
+    event->text.x -= dx;
+    event->text.y -= dy;
+    break;
+  case PUGL_POINTER_IN:
+  case PUGL_POINTER_OUT:
+    event->crossing.x -= dx;
+    event->crossing.y -= dy;
+    break;
+  case PUGL_BUTTON_PRESS:
+  case PUGL_BUTTON_RELEASE:
+    event->button.x -= dx;
+    event->button.y -= dy;
+    break;
+  case PUGL_MOTION:
+    event->motion.x -= dx;
+    event->motion.y -= dy;
+    break;
+  case PUGL_SCROLL:
+    event->scroll.x -= dx;
+    event->scroll.y -= dy;
+    break;
+  default:
+    break;
+  }
+}
+
+/*
+  Host
+*/
+
+static void
+puglRemoteHostFreeBuffer(PuglRemoteHost* const host)
+{
+  if (host->data) {
+    munmap(host->data, host->size);
+  }
+
+  host->data         = NULL;
+  host->size         = 0u;
+  host->stride       = 0u;
+  host->framePending = false;
+  host->damage       = emptyRect;
+}
+
+/// Create a new shared buffer and send it to the guest
+static PuglStatus
+puglRemoteHostCreateBuffer(PuglRemoteHost* const host)
+{
+  const PuglRect frame  = host->frame;
+  const size_t   stride = (size_t)frame.width * 4u;
+  const size_t   size   = stride * frame.height;
+
+  puglRemoteHostFreeBuffer(host);
+  if (!size) {
+    return PUGL_SUCCESS;
+  }
+
+  const int fd = puglRemoteCreateShm(size);
+  if (fd < 0) {
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
+
+  void* const data =
+    mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    close(fd);
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
+
+  host->data   = data;
+  host->size   = size;
+  host->stride = stride;
+
+  PuglRemoteMessage message;
+  memset(&message, 0, sizeof(message));
+  message.type   = PUGL_REMOTE_BUFFER;
+  message.serial = ++host->serial;
+  message.rect   = frame;
+  message.stride = stride;
+
+  const PuglStatus st = puglRemoteSend(host->socket, &message, fd);
+
+  close(fd); // The mapping and the guest's descriptor keep the memory alive
+  return st;
+}
+
+/// Send a message about the current buffer to the guest
+static PuglStatus
+puglRemoteHostSendSimple(PuglRemoteHost* const       host,
+                         const PuglRemoteMessageType type,
+                         const PuglEvent* const      event)
+{
+  PuglRemoteMessage message;
+  memset(&message, 0, sizeof(message));
+  message.type   = (uint32_t)type;
+  message.serial = host->serial;
+  if (event) {
+    message.event = *event;
+  }
+
+  return puglRemoteSend(host->socket, &message, -1);
+}
+
+/// Ask the guest to redraw everything
+static PuglStatus
+puglRemoteHostRequestExpose(PuglRemoteHost* const host)
+{
+  PuglEvent event     = {{PUGL_EXPOSE, 0}};
+  event.expose.width  = host->frame.width;
+  event.expose.height = host->frame.height;
+
+  return puglRemoteHostSendSimple(host, PUGL_REMOTE_EVENT, &event);
+}
+
+PuglRemoteHost*
+puglNewRemoteHost(PuglView* const view, const int socket)
+{
+  PuglWorld* const      world = puglGetWorld(view);
+  PuglRemoteHost* const host =
+    (PuglRemoteHost*)puglCalloc(world, 1, sizeof(PuglRemoteHost));
+
+  if (host) {
+    host->world  = world;
+    host->view   = view;
+    host->socket = socket;
+  }
+
+  return host;
+}
+
+void
+puglFreeRemoteHost(PuglRemoteHost* const host)
+{
+  if (host) {
+    puglRemoteHostFreeBuffer(host);
+    close(host->socket);
+    puglFree(host->world, host);
+  }
+}
+
+PuglStatus
+puglSetRemoteFrame(PuglRemoteHost* const host, const PuglRect frame)
+{
+  const PuglRect oldFrame = host->frame;
+  if (!memcmp(&frame, &oldFrame, sizeof(PuglRect))) {
+    return PUGL_SUCCESS;
+  }
+
+  host->frame = frame;
+  if (!puglRemoteIsEmpty(oldFrame) && puglGetNativeWindow(host->view)) {
+    puglPostRedisplayRect(host->view, oldFrame);
+  }
+
+  if (frame.width != oldFrame.width || frame.height != oldFrame.height) {
+    // The guest receives a configure event and redraws with the new buffer
+    return puglRemoteHostCreateBuffer(host);
+  }
+
+  // Only moved, so configure the guest and redraw it in the new position
+  PuglEvent event        = {{PUGL_CONFIGURE, 0}};
+  event.configure.x      = frame.x;
+  event.configure.y      = frame.y;
+  event.configure.width  = frame.width;
+  event.configure.height = frame.height;
+
+  const PuglStatus st =
+    puglRemoteHostSendSimple(host, PUGL_REMOTE_EVENT, &event);
+
+  return st ? st : puglRemoteHostRequestExpose(host);
+}
+
+PuglRect
+puglGetRemoteFrame(const PuglRemoteHost* const host)
+{
+  return host->frame;
+}
+
+PuglStatus
+puglSendRemoteEvent(PuglRemoteHost* const host, const PuglEvent* const event)
+{
+  PuglEvent local = *event;
+
+  puglRemoteTranslateEvent(&local, host->frame.x, host->frame.y);
+
+  return puglRemoteHostSendSimple(host, PUGL_REMOTE_EVENT, &local);
+}
+
+PuglStatus
+puglUpdateRemoteHost(PuglRemoteHost* const host, const double timeout)
+{
+  PuglRemoteMessage message;
+  PuglStatus        st = PUGL_SUCCESS;
+  int               fd = -1;
+
+  // Wait for the first message, then process any others that have arrived
+  for (double t = timeout; puglRemoteWait(host->socket, t); t = 0.0) {
+    if ((st = puglRemoteReceive(host->socket, &message, &fd))) {
+      return st;
+    }
+
+    if (fd >= 0) {
+      close(fd); // Guests never send descriptors
+    }
+
+    if (message.type == PUGL_REMOTE_DAMAGE && message.serial == host->serial) {
+      const PuglRect damage =
+        puglRemoteClip(message.rect, host->frame.width, host->frame.height);
+
+      host->damage       = puglRemoteUnion(host->damage, damage);
+      host->framePending = true;
+
+      const PuglRect rect = {(PuglCoord)(host->frame.x + damage.x),
+                             (PuglCoord)(host->frame.y + damage.y),
+                             damage.width,
+                             damage.height};
+
+      if (!puglRemoteIsEmpty(rect)) {
+        puglPostRedisplayRect(host->view, rect);
+      }
+    }
+  }
+
+  return st;
+}
+
+PuglStatus
+puglDrawRemote(PuglRemoteHost* const host, PuglPixelBuffer* const buffer)
+{
+  if (!host->data || !buffer || !buffer->data) {
+    return PUGL_SUCCESS;
+  }
+
+  // If the target was recreated, its contents are gone, so redraw everything
+  if (buffer->data != host->lastTarget || buffer->width != host->lastWidth ||
+      buffer->height != host->lastHeight) {
+    const bool recreated = !!host->lastTarget;
+
+    host->lastTarget = buffer->data;
+    host->lastWidth  = buffer->width;
+    host->lastHeight = buffer->height;
+
+    const PuglStatus st = recreated ? puglRemoteHostRequestExpose(host)
+                                    : PUGL_SUCCESS;
+    if (st) {
+      return st;
+    }
+  }
+
+  if (!host->framePending) {
+    return PUGL_SUCCESS;
+  }
+
+  // Clip the damaged region of the guest to the target buffer
+  const PuglRect frame  = host->frame;
+  const PuglRect target = {(PuglCoord)(frame.x + host->damage.x),
+                           (PuglCoord)(frame.y + host->damage.y),
+                           host->damage.width,
+                           host->damage.height};
+
+  const PuglRect region = puglRemoteClip(target, buffer->width, buffer->height);
+
+  // Copy the damaged region from the shared buffer
+  const size_t rowSize = (size_t)region.width * 4u;
+  for (int y = region.y; y < region.y + (int)region.height; ++y) {
+    const size_t srcRow = (size_t)(y - frame.y);
+    const size_t srcCol = (size_t)(region.x - frame.x);
+
+    const uint8_t* const src =
+      (const uint8_t*)host->data + (srcRow * host->stride) + (srcCol * 4u);
+
+    uint8_t* const dst = (uint8_t*)buffer->data + ((size_t)y * buffer->stride) +
+                         ((size_t)region.x * 4u);
+
+    memcpy(dst, src, rowSize);
+  }
+
+  // Acknowledge the frame so the guest can draw again
+  host->framePending = false;
+  host->damage       = emptyRect;
+  return puglRemoteHostSendSimple(host, PUGL_REMOTE_ACK, NULL);
+}
+
+/*
+  Guest
+*/
+
+static void
+puglRemoteGuestFreeBuffer(PuglRemoteGuest* const guest)
+{
+  if (guest->buffer.data) {
+    munmap(guest->buffer.data, guest->size);
+  }
+
+  memset(&guest->buffer, 0, sizeof(PuglPixelBuffer));
+  guest->size = 0u;
+}
+
+static PuglStatus
+puglRemoteGuestDispatch(PuglRemoteGuest* const guest,
+                        const PuglEvent* const event)
+{
+  return guest->eventFunc ? guest->eventFunc(guest, event) : PUGL_SUCCESS;
+}
+
+/// Map a new shared buffer from the host, and configure the guest
+static PuglStatus
+puglRemoteGuestSetBuffer(PuglRemoteGuest* const         guest,
+                         const PuglRemoteMessage* const message,
+                         const int                      fd)
+{
+  const PuglRect frame = message->rect;
+  const size_t   size  = (size_t)message->stride * frame.height;
+
+  puglRemoteGuestFreeBuffer(guest);
+
+  void* const data =
+    size ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : NULL;
+
+  close(fd);
+  if (data == MAP_FAILED) {
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
+
+  guest->buffer.data   = (uint32_t*)data;
+  guest->buffer.stride = (size_t)message->stride;
+  guest->buffer.width  = frame.width;
+  guest->buffer.height = frame.height;
+  guest->size          = size;
+  guest->serial        = message->serial;
+  guest->awaitingAck   = false;
+
+  // Everything must be drawn to the new buffer
+  guest->pending.x      = 0;
+  guest->pending.y      = 0;
+  guest->pending.width  = frame.width;
+  guest->pending.height = frame.height;
+
+  PuglEvent event        = {{PUGL_CONFIGURE, 0}};
+  event.configure.x      = frame.x;
+  event.configure.y      = frame.y;
+  event.configure.width  = frame.width;
+  event.configure.height = frame.height;
+
+  return puglRemoteGuestDispatch(guest, &event);
+}
+
+static PuglStatus
+puglRemoteGuestHandleMessage(PuglRemoteGuest* const         guest,
+                             const PuglRemoteMessage* const message,
+                             const int                      fd)
+{
+  if (message->type == PUGL_REMOTE_BUFFER && fd >= 0) {
+    return puglRemoteGuestSetBuffer(guest, message, fd);
+  }
+
+  if (fd >= 0) {
+    close(fd);
+  }
+
+  if (message->type == PUGL_REMOTE_ACK && message->serial == guest->serial) {
+    guest->awaitingAck = false;
+  } else if (message->type == PUGL_REMOTE_EVENT) {
+    const PuglEvent* const event = &message->event;
+    if (event->type == PUGL_EXPOSE) {
+      const PuglRect rect = {event->expose.x,
+                             event->expose.y,
+                             event->expose.width,
+                             event->expose.height};
+
+      return puglPostRemoteRedisplayRect(guest, rect);
+    }
+
+    return puglRemoteGuestDispatch(guest, event);
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static bool
+puglRemoteGuestCanDraw(const PuglRemoteGuest* const guest)
+{
+  return guest->buffer.data && !guest->awaitingAck &&
+         !puglRemoteIsEmpty(guest->pending);
+}
+
+/// Draw the pending region and send it to the host
+static PuglStatus
+puglRemoteGuestDraw(PuglRemoteGuest* const guest)
+{
+  PuglPixelBuffer* const buffer = &guest->buffer;
+
+  buffer->damage =
+    puglRemoteClip(guest->pending, buffer->width, buffer->height);
+  guest->pending = emptyRect;
+  if (puglRemoteIsEmpty(buffer->damage)) {
+    return PUGL_SUCCESS;
+  }
+
+  PuglEvent event     = {{PUGL_EXPOSE, 0}};
+  event.expose.x      = buffer->damage.x;
+  event.expose.y      = buffer->damage.y;
+  event.expose.width  = buffer->damage.width;
+  event.expose.height = buffer->damage.height;
+
+  guest->drawing          = true;
+  const PuglStatus drawSt = puglRemoteGuestDispatch(guest, &event);
+  guest->drawing          = false;
+
+  // Tell the host which region was drawn, and wait for it to be copied
+  PuglRemoteMessage message;
+  memset(&message, 0, sizeof(message));
+  message.type   = PUGL_REMOTE_DAMAGE;
+  message.serial = guest->serial;
+  message.rect   = buffer->damage;
+
+  const PuglStatus sendSt = puglRemoteSend(guest->socket, &message, -1);
+
+  guest->awaitingAck = !sendSt;
+  return sendSt ? sendSt : drawSt;
+}
+
+PuglRemoteGuest*
+puglNewRemoteGuest(const int socket)
+{
+  PuglRemoteGuest* const guest =
+    (PuglRemoteGuest*)calloc(1, sizeof(PuglRemoteGuest));
+
+  if (guest) {
+    guest->socket = socket;
+  }
+
+  return guest;
+}
+
+void
+puglFreeRemoteGuest(PuglRemoteGuest* const guest)
+{
+  if (guest) {
+    puglRemoteGuestFreeBuffer(guest);
+    close(guest->socket);
+    free(guest);
+  }
+}
+
+void
+puglSetRemoteHandle(PuglRemoteGuest* const guest, const PuglHandle handle)
+{
+  guest->handle = handle;
+}
+
+PuglHandle
+puglGetRemoteHandle(const PuglRemoteGuest* const guest)
+{
+  return guest->handle;
+}
+
+PuglStatus
+puglSetRemoteEventFunc(PuglRemoteGuest* const    guest,
+                       const PuglRemoteEventFunc eventFunc)
+{
+  guest->eventFunc = eventFunc;
+  return PUGL_SUCCESS;
+}
+
+PuglPixelBuffer*
+puglGetRemoteBuffer(PuglRemoteGuest* const guest)
+{
+  return guest->drawing ? &guest->buffer : NULL;
+}
+
+PuglStatus
+puglPostRemoteRedisplay(PuglRemoteGuest* const guest)
+{
+  const PuglRect rect = {0, 0, guest->buffer.width, guest->buffer.height};
+
+  return puglPostRemoteRedisplayRect(guest, rect);
+}
+
+PuglStatus
+puglPostRemoteRedisplayRect(PuglRemoteGuest* const guest, const PuglRect rect)
+{
+  guest->pending = puglRemoteUnion(guest->pending, rect);
+  return PUGL_SUCCESS;
+}
+
+PuglStatus
+puglUpdateRemoteGuest(PuglRemoteGuest* const guest, const double timeout)
+{
+  PuglRemoteMessage message;
+  PuglStatus        st = PUGL_SUCCESS;
+  int               fd = -1;
+
+  // Don't wait if there is already something to draw
+  const double firstTimeout = puglRemoteGuestCanDraw(guest) ? 0.0 : timeout;
+
+  // Wait for the first message, then process any others that have arrived
+  for (double t = firstTimeout; puglRemoteWait(guest->socket, t); t = 0.0) {
+    if ((st = puglRemoteReceive(guest->socket, &message, &fd)) ||
+        (st = puglRemoteGuestHandleMessage(guest, &message, fd))) {
+      return st;
+    }
+  }
+
+  return puglRemoteGuestCanDraw(guest) ? puglRemoteGuestDraw(guest) : st;
+}
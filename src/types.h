@@ -33,6 +33,24 @@ typedef struct {
   size_t len;  ///< Length of data in bytes
 } PuglBlob;
 
+/// Virtual child views of a view
+typedef struct {
+  PuglVirtualView** views;    ///< Virtual views from bottom to top
+  size_t            numViews; ///< Number of virtual views
+  PuglVirtualView*  hover;    ///< Virtual view under the pointer
+  PuglVirtualView*  grab;     ///< Virtual view that grabbed the pointer
+  PuglVirtualView*  focus;    ///< Virtual view with the keyboard focus
+} PuglVirtualViews;
+
+/// Lightweight view drawn within a parent view
+struct PuglVirtualViewImpl {
+  PuglView*            parent;
+  PuglHandle           handle;
+  PuglVirtualEventFunc eventFunc;
+  PuglRect             frame;
+  bool                 visible;
+};
+
 /// Cross-platform view definition
 struct PuglViewImpl {
   PuglWorld*         world;
@@ -43,21 +61,35 @@ struct PuglViewImpl {
   char*              title;
   PuglNativeView     parent;
   uintptr_t          transientParent;
+  PuglView*          shareView;
   PuglRect           frame;
   PuglConfigureEvent lastConfigure;
   PuglHints          hints;
   PuglViewSize       sizeHints[(unsigned)PUGL_MAX_ASPECT + 1u];
+  PuglVirtualViews   children;
   bool               visible;
 };
 
+/// A low-priority task run when the world is idle
+typedef struct {
+  PuglIdleFunc func;
+  void*        data;
+} PuglIdleTask;
+
 /// Cross-platform world definition
 struct PuglWorldImpl {
+  PuglAllocator       allocator;
   PuglWorldInternals* impl;
   PuglWorldHandle     handle;
   char*               className;
+  PuglLogFunc         logFunc;
   double              startTime;
   size_t              numViews;
   PuglView**          views;
+  PuglIdleTask*       idleTasks;
+  size_t              numIdleTasks;
+  size_t              nextIdleTask; ///< Index of the next idle task to run
+  double              idleBudget;   ///< Maximum time to run idle tasks for
 };
 
 /// Opaque surface used by graphics backend
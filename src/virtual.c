@@ -0,0 +1,494 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "allocator.h"
+#include "implementation.h"
+#include "types.h"
+
+#include "pugl/pugl.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/// Return the intersection of two rectangles, which may be empty
+static PuglRect
+puglIntersectRects(const PuglRect a, const PuglRect b)
+{
+  const int ax1 = a.x + (int)a.width;
+  const int ay1 = a.y + (int)a.height;
+  const int bx1 = b.x + (int)b.width;
+  const int by1 = b.y + (int)b.height;
+  const int x0  = a.x > b.x ? a.x : b.x;
+  const int y0  = a.y > b.y ? a.y : b.y;
+  const int x1  = ax1 < bx1 ? ax1 : bx1;
+  const int y1  = ay1 < by1 ? ay1 : by1;
+
+  const PuglRect result = {(PuglCoord)x0,
+                           (PuglCoord)y0,
+                           (PuglSpan)(x1 > x0 ? x1 - x0 : 0),
+                           (PuglSpan)(y1 > y0 ? y1 - y0 : 0)};
+
+  return result;
+}
+
+/// Return the topmost visible virtual view at a point in parent coordinates
+static PuglVirtualView*
+puglGetVirtualViewAt(const PuglView* const view,
+                     const double          x,
+                     const double          y)
+{
+  const PuglVirtualViews* const children = &view->children;
+
+  for (size_t i = children->numViews; i > 0u; --i) {
+    PuglVirtualView* const child = children->views[i - 1u];
+    const PuglRect         frame = child->frame;
+
+    if (child->visible && x >= frame.x && y >= frame.y &&
+        x < frame.x + (double)frame.width &&
+        y < frame.y + (double)frame.height) {
+      return child;
+    }
+  }
+
+  return NULL;
+}
+
+/// Dispatch an event to a virtual view, translated to its coordinates
+static PuglStatus
+puglDispatchToVirtualView(PuglVirtualView* const view,
+                          const PuglEvent* const event)
+{
+  if (!view->eventFunc) {
+    return PUGL_SUCCESS;
+  }
+
+  const double dx    = view->frame.x;
+  const double dy    = view->frame.y;
+  PuglEvent    local = *event;
+
+  switch (event->type) {
+  case PUGL_KEY_PRESS:
+  case PUGL_KEY_RELEASE:
+    local.key.x -= dx;
+    local.key.y -= dy;
+    break;
+  case PUGL_TEXT:
+    local.text.x -= dx;
+    local.text.y -= dy;
+    break;
+  case PUGL_POINTER_IN:
+  case PUGL_POINTER_OUT:
+    local.crossing.x -= dx;
+    local.crossing.y -= dy;
+    break;
+  case PUGL_BUTTON_PRESS:
+  case PUGL_BUTTON_RELEASE:
+    local.button.x -= dx;
+    local.button.y -= dy;
+    break;
+  case PUGL_MOTION:
+    local.motion.x -= dx;
+    local.motion.y -= dy;
+    break;
+  case PUGL_SCROLL:
+    local.scroll.x -= dx;
+    local.scroll.y -= dy;
+    break;
+  default:
+    break;
+  }
+
+  return view->eventFunc(view, &local);
+}
+
+/// Dispatch a simple event like a map or focus event to a virtual view
+static PuglStatus
+puglDispatchSimpleVirtualEvent(PuglVirtualView* const view,
+                               const PuglEventType    type)
+{
+  PuglEvent event = {{type, 0}};
+
+  if (type == PUGL_FOCUS_IN || type == PUGL_FOCUS_OUT) {
+    event.focus.mode = PUGL_CROSSING_NORMAL;
+  }
+
+  return puglDispatchToVirtualView(view, &event);
+}
+
+/// Move the pointer to a virtual view, sending crossing events as necessary
+static PuglStatus
+puglSetVirtualHover(PuglView* const                view,
+                    PuglVirtualView* const         hover,
+                    const PuglCrossingEvent* const crossing)
+{
+  PuglVirtualViews* const children = &view->children;
+  PuglStatus              st0      = PUGL_SUCCESS;
+  PuglStatus              st1      = PUGL_SUCCESS;
+
+  if (hover != children->hover) {
+    PuglEvent event = {{PUGL_POINTER_OUT, 0}};
+    event.crossing  = *crossing;
+
+    if (children->hover) {
+      event.crossing.type = PUGL_POINTER_OUT;
+      st0 = puglDispatchToVirtualView(children->hover, &event);
+    }
+
+    if ((children->hover = hover)) {
+      event.crossing.type = PUGL_POINTER_IN;
+      st1 = puglDispatchToVirtualView(hover, &event);
+    }
+  }
+
+  return st0 ? st0 : st1;
+}
+
+/// Move the keyboard focus to a virtual view, sending focus events
+static PuglStatus
+puglSetVirtualFocus(PuglView* const view, PuglVirtualView* const focus)
+{
+  PuglVirtualViews* const children = &view->children;
+  PuglStatus              st0      = PUGL_SUCCESS;
+  PuglStatus              st1      = PUGL_SUCCESS;
+
+  if (focus != children->focus) {
+    if (children->focus) {
+      st0 = puglDispatchSimpleVirtualEvent(children->focus, PUGL_FOCUS_OUT);
+    }
+
+    if ((children->focus = focus)) {
+      st1 = puglDispatchSimpleVirtualEvent(focus, PUGL_FOCUS_IN);
+    }
+  }
+
+  return st0 ? st0 : st1;
+}
+
+/// Release the pointer and focus from a virtual view that can't have them
+static void
+puglReleaseVirtualView(PuglVirtualView* const view)
+{
+  PuglVirtualViews* const children = &view->parent->children;
+
+  if (children->focus == view) {
+    puglDispatchSimpleVirtualEvent(view, PUGL_FOCUS_OUT);
+    children->focus = NULL;
+  }
+
+  if (children->hover == view) {
+    children->hover = NULL;
+  }
+
+  if (children->grab == view) {
+    children->grab = NULL;
+  }
+}
+
+bool
+puglDispatchVirtualEvent(PuglView* const        view,
+                         const PuglEvent* const event,
+                         PuglStatus* const      status)
+{
+  PuglVirtualViews* const children = &view->children;
+  PuglVirtualView*        target   = NULL;
+  PuglStatus              st       = PUGL_SUCCESS;
+
+  if (!children->numViews) {
+    return false;
+  }
+
+  switch (event->type) {
+  case PUGL_POINTER_OUT:
+    // The pointer left the parent, so it also left any virtual view
+    puglSetVirtualHover(view, NULL, &event->crossing);
+    return false;
+
+  case PUGL_BUTTON_PRESS:
+    // Grab the pointer and the focus until the button is released
+    target = children->grab ? children->grab
+                            : puglGetVirtualViewAt(
+                                view, event->button.x, event->button.y);
+
+    children->grab = target;
+    st             = puglSetVirtualFocus(view, target);
+    break;
+
+  case PUGL_BUTTON_RELEASE:
+    target = children->grab ? children->grab
+                            : puglGetVirtualViewAt(
+                                view, event->button.x, event->button.y);
+
+    children->grab = NULL;
+    break;
+
+  case PUGL_MOTION: {
+    const PuglMotionEvent* const motion = &event->motion;
+    const PuglCrossingEvent      crossing =
+      {PUGL_POINTER_IN,
+       0,
+       motion->time,
+       motion->x,
+       motion->y,
+       motion->xRoot,
+       motion->yRoot,
+       motion->state,
+       children->grab ? PUGL_CROSSING_GRAB : PUGL_CROSSING_NORMAL};
+
+    PuglVirtualView* const hover =
+      puglGetVirtualViewAt(view, motion->x, motion->y);
+
+    st     = puglSetVirtualHover(view, hover, &crossing);
+    target = children->grab ? children->grab : hover;
+    break;
+  }
+
+  case PUGL_SCROLL:
+    target = puglGetVirtualViewAt(view, event->scroll.x, event->scroll.y);
+    break;
+
+  case PUGL_KEY_PRESS:
+  case PUGL_KEY_RELEASE:
+  case PUGL_TEXT:
+    target = children->focus;
+    break;
+
+  default:
+    break;
+  }
+
+  if (!target) {
+    return false;
+  }
+
+  const PuglStatus dispatchStatus = puglDispatchToVirtualView(target, event);
+
+  *status = st ? st : dispatchStatus;
+  return true;
+}
+
+PuglStatus
+puglExposeVirtualViews(PuglView* const              view,
+                       const PuglExposeEvent* const expose)
+{
+  const PuglVirtualViews* const children = &view->children;
+  PuglStatus                    st       = PUGL_SUCCESS;
+
+  const PuglRect exposed = {
+    expose->x, expose->y, expose->width, expose->height};
+
+  for (size_t i = 0u; i < children->numViews; ++i) {
+    PuglVirtualView* const child  = children->views[i];
+    const PuglRect         region = puglIntersectRects(exposed, child->frame);
+
+    if (child->visible && region.width && region.height) {
+      PuglEvent event     = {{PUGL_EXPOSE, expose->flags}};
+      event.expose.x      = (PuglCoord)(region.x - child->frame.x);
+      event.expose.y      = (PuglCoord)(region.y - child->frame.y);
+      event.expose.width  = region.width;
+      event.expose.height = region.height;
+
+      const PuglStatus childStatus = puglDispatchToVirtualView(child, &event);
+
+      st = st ? st : childStatus;
+    }
+  }
+
+  return st;
+}
+
+void
+puglFreeVirtualViews(PuglView* const view)
+{
+  PuglVirtualViews* const children = &view->children;
+
+  for (size_t i = 0u; i < children->numViews; ++i) {
+    puglFree(view->world, children->views[i]);
+  }
+
+  puglFree(view->world, children->views);
+  memset(children, 0, sizeof(PuglVirtualViews));
+}
+
+PuglVirtualView*
+puglNewVirtualView(PuglView* const parent)
+{
+  PuglVirtualViews* const children = &parent->children;
+
+  if (parent->hints[PUGL_RENDER_THREAD] == PUGL_TRUE) {
+    return NULL; // Children would be drawn without synchronization
+  }
+
+  PuglVirtualView* const view =
+    (PuglVirtualView*)puglCalloc(parent->world, 1, sizeof(PuglVirtualView));
+  if (!view) {
+    return NULL;
+  }
+
+  PuglVirtualView** const views = (PuglVirtualView**)puglRealloc(
+    parent->world,
+    children->views,
+    (children->numViews + 1u) * sizeof(PuglVirtualView*));
+  if (!views) {
+    puglFree(parent->world, view);
+    return NULL;
+  }
+
+  view->parent                          = parent;
+  children->views                       = views;
+  children->views[children->numViews++] = view;
+  return view;
+}
+
+void
+puglFreeVirtualView(PuglVirtualView* const view)
+{
+  PuglView* const         parent   = view->parent;
+  PuglVirtualViews* const children = &parent->children;
+
+  if (view->visible) {
+    puglPostVirtualRedisplay(view);
+  }
+
+  puglReleaseVirtualView(view);
+
+  // Remove from the parent's list of virtual views
+  for (size_t i = 0u; i < children->numViews; ++i) {
+    if (children->views[i] == view) {
+      memmove(children->views + i,
+              children->views + i + 1u,
+              (children->numViews - i - 1u) * sizeof(PuglVirtualView*));
+      --children->numViews;
+      break;
+    }
+  }
+
+  puglFree(parent->world, view);
+}
+
+PuglView*
+puglGetVirtualParent(const PuglVirtualView* const view)
+{
+  return view->parent;
+}
+
+void
+puglSetVirtualHandle(PuglVirtualView* const view, const PuglHandle handle)
+{
+  view->handle = handle;
+}
+
+PuglHandle
+puglGetVirtualHandle(const PuglVirtualView* const view)
+{
+  return view->handle;
+}
+
+PuglStatus
+puglSetVirtualEventFunc(PuglVirtualView* const     view,
+                        const PuglVirtualEventFunc eventFunc)
+{
+  view->eventFunc = eventFunc;
+  return PUGL_SUCCESS;
+}
+
+PuglStatus
+puglSetVirtualFrame(PuglVirtualView* const view, const PuglRect frame)
+{
+  if (!memcmp(&frame, &view->frame, sizeof(PuglRect))) {
+    return PUGL_SUCCESS;
+  }
+
+  // Redisplay the old region, which may no longer be covered
+  if (view->visible) {
+    puglPostVirtualRedisplay(view);
+  }
+
+  view->frame = frame;
+
+  PuglEvent event        = {{PUGL_CONFIGURE, 0}};
+  event.configure.x      = frame.x;
+  event.configure.y      = frame.y;
+  event.configure.width  = frame.width;
+  event.configure.height = frame.height;
+
+  const PuglStatus st = puglDispatchToVirtualView(view, &event);
+
+  return view->visible ? puglPostVirtualRedisplay(view) : st;
+}
+
+PuglRect
+puglGetVirtualFrame(const PuglVirtualView* const view)
+{
+  return view->frame;
+}
+
+PuglStatus
+puglShowVirtualView(PuglVirtualView* const view)
+{
+  if (view->visible) {
+    return PUGL_SUCCESS;
+  }
+
+  view->visible = true;
+
+  const PuglStatus st = puglDispatchSimpleVirtualEvent(view, PUGL_MAP);
+
+  return st ? st : puglPostVirtualRedisplay(view);
+}
+
+PuglStatus
+puglHideVirtualView(PuglVirtualView* const view)
+{
+  if (!view->visible) {
+    return PUGL_SUCCESS;
+  }
+
+  puglPostVirtualRedisplay(view);
+  puglReleaseVirtualView(view);
+  view->visible = false;
+
+  return puglDispatchSimpleVirtualEvent(view, PUGL_UNMAP);
+}
+
+bool
+puglGetVirtualVisible(const PuglVirtualView* const view)
+{
+  return view->visible;
+}
+
+PuglStatus
+puglGrabVirtualFocus(PuglVirtualView* const view)
+{
+  return view->visible ? puglSetVirtualFocus(view->parent, view)
+                       : PUGL_FAILURE;
+}
+
+PuglStatus
+puglPostVirtualRedisplay(PuglVirtualView* const view)
+{
+  const PuglRect rect = {0, 0, view->frame.width, view->frame.height};
+
+  return puglPostVirtualRedisplayRect(view, rect);
+}
+
+PuglStatus
+puglPostVirtualRedisplayRect(PuglVirtualView* const view, const PuglRect rect)
+{
+  if (!view->visible) {
+    return PUGL_SUCCESS;
+  }
+
+  // Translate to parent coordinates, and clip to the virtual view
+  const PuglRect translated = {(PuglCoord)(rect.x + view->frame.x),
+                               (PuglCoord)(rect.y + view->frame.y),
+                               rect.width,
+                               rect.height};
+
+  const PuglRect damage = puglIntersectRects(translated, view->frame);
+
+  // Only post redisplays for realized parents, like a native view would
+  return (damage.width && damage.height && puglGetNativeWindow(view->parent))
+           ? puglPostRedisplayRect(view->parent, damage)
+           : PUGL_SUCCESS;
+}
@@ -0,0 +1,173 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+// Portable Vulkan function table loading for the Vulkan backends
+
+#define VK_NO_PROTOTYPES 1
+
+#include "pugl/pugl.h"
+#include "pugl/vulkan.h"
+
+#include <vulkan/vulkan_core.h>
+
+#include <stdbool.h>
+#include <string.h>
+
+#define PUGL_LOAD_GLOBAL(name) \
+  (functions->name = (PFN_##name)getInstanceProcAddr(VK_NULL_HANDLE, #name))
+
+#define PUGL_LOAD_INSTANCE(name) \
+  (functions->name = (PFN_##name)getInstanceProcAddr(instance, #name))
+
+#define PUGL_LOAD_DEVICE(name) \
+  (functions->name = (PFN_##name)getDeviceProcAddr(device, #name))
+
+VkResult
+puglLoadVulkanInstanceFunctions(const PuglVulkanLoader* const      loader,
+                                const VkInstance                   instance,
+                                PuglVulkanInstanceFunctions* const functions)
+{
+  const PFN_vkGetInstanceProcAddr getInstanceProcAddr =
+    puglGetInstanceProcAddrFunc(loader);
+
+  memset(functions, 0, sizeof(PuglVulkanInstanceFunctions));
+  if (!getInstanceProcAddr) {
+    return VK_ERROR_INITIALIZATION_FAILED;
+  }
+
+  functions->vkGetInstanceProcAddr = getInstanceProcAddr;
+
+  const bool hasGlobals =
+    PUGL_LOAD_GLOBAL(vkCreateInstance) &&
+    PUGL_LOAD_GLOBAL(vkEnumerateInstanceExtensionProperties) &&
+    PUGL_LOAD_GLOBAL(vkEnumerateInstanceLayerProperties);
+
+  if (!hasGlobals) {
+    return VK_ERROR_INITIALIZATION_FAILED;
+  }
+
+  if (!instance) {
+    return VK_SUCCESS;
+  }
+
+  const bool hasCore =
+    PUGL_LOAD_INSTANCE(vkDestroyInstance) &&
+    PUGL_LOAD_INSTANCE(vkEnumeratePhysicalDevices) &&
+    PUGL_LOAD_INSTANCE(vkGetPhysicalDeviceProperties) &&
+    PUGL_LOAD_INSTANCE(vkGetPhysicalDeviceFeatures) &&
+    PUGL_LOAD_INSTANCE(vkGetPhysicalDeviceFormatProperties) &&
+    PUGL_LOAD_INSTANCE(vkGetPhysicalDeviceMemoryProperties) &&
+    PUGL_LOAD_INSTANCE(vkGetPhysicalDeviceQueueFamilyProperties) &&
+    PUGL_LOAD_INSTANCE(vkEnumerateDeviceExtensionProperties) &&
+    PUGL_LOAD_INSTANCE(vkCreateDevice) &&
+    PUGL_LOAD_INSTANCE(vkGetDeviceProcAddr);
+
+  if (!hasCore) {
+    return VK_ERROR_INITIALIZATION_FAILED;
+  }
+
+  // Load functions from VK_KHR_surface, which are null if it isn't enabled
+  PUGL_LOAD_INSTANCE(vkDestroySurfaceKHR);
+  PUGL_LOAD_INSTANCE(vkGetPhysicalDeviceSurfaceSupportKHR);
+  PUGL_LOAD_INSTANCE(vkGetPhysicalDeviceSurfaceCapabilitiesKHR);
+  PUGL_LOAD_INSTANCE(vkGetPhysicalDeviceSurfaceFormatsKHR);
+  PUGL_LOAD_INSTANCE(vkGetPhysicalDeviceSurfacePresentModesKHR);
+
+  return VK_SUCCESS;
+}
+
+VkResult
+puglLoadVulkanDeviceFunctions(const PuglVulkanLoader* const    loader,
+                              const VkDevice                   device,
+                              PuglVulkanDeviceFunctions* const functions)
+{
+  const PFN_vkGetDeviceProcAddr getDeviceProcAddr =
+    puglGetDeviceProcAddrFunc(loader);
+
+  memset(functions, 0, sizeof(PuglVulkanDeviceFunctions));
+  if (!getDeviceProcAddr || !device) {
+    return VK_ERROR_INITIALIZATION_FAILED;
+  }
+
+  const bool hasCore =
+    PUGL_LOAD_DEVICE(vkDestroyDevice) &&
+    PUGL_LOAD_DEVICE(vkGetDeviceQueue) &&
+    PUGL_LOAD_DEVICE(vkQueueSubmit) &&
+    PUGL_LOAD_DEVICE(vkQueueWaitIdle) &&
+    PUGL_LOAD_DEVICE(vkDeviceWaitIdle) &&
+    PUGL_LOAD_DEVICE(vkAllocateMemory) &&
+    PUGL_LOAD_DEVICE(vkFreeMemory) &&
+    PUGL_LOAD_DEVICE(vkMapMemory) &&
+    PUGL_LOAD_DEVICE(vkUnmapMemory) &&
+    PUGL_LOAD_DEVICE(vkFlushMappedMemoryRanges) &&
+    PUGL_LOAD_DEVICE(vkBindBufferMemory) &&
+    PUGL_LOAD_DEVICE(vkBindImageMemory) &&
+    PUGL_LOAD_DEVICE(vkGetBufferMemoryRequirements) &&
+    PUGL_LOAD_DEVICE(vkGetImageMemoryRequirements) &&
+    PUGL_LOAD_DEVICE(vkCreateFence) &&
+    PUGL_LOAD_DEVICE(vkDestroyFence) &&
+    PUGL_LOAD_DEVICE(vkResetFences) &&
+    PUGL_LOAD_DEVICE(vkWaitForFences) &&
+    PUGL_LOAD_DEVICE(vkCreateSemaphore) &&
+    PUGL_LOAD_DEVICE(vkDestroySemaphore) &&
+    PUGL_LOAD_DEVICE(vkCreateBuffer) &&
+    PUGL_LOAD_DEVICE(vkDestroyBuffer) &&
+    PUGL_LOAD_DEVICE(vkCreateImage) &&
+    PUGL_LOAD_DEVICE(vkDestroyImage) &&
+    PUGL_LOAD_DEVICE(vkCreateImageView) &&
+    PUGL_LOAD_DEVICE(vkDestroyImageView) &&
+    PUGL_LOAD_DEVICE(vkCreateSampler) &&
+    PUGL_LOAD_DEVICE(vkDestroySampler) &&
+    PUGL_LOAD_DEVICE(vkCreateDescriptorSetLayout) &&
+    PUGL_LOAD_DEVICE(vkDestroyDescriptorSetLayout) &&
+    PUGL_LOAD_DEVICE(vkCreateDescriptorPool) &&
+    PUGL_LOAD_DEVICE(vkDestroyDescriptorPool) &&
+    PUGL_LOAD_DEVICE(vkAllocateDescriptorSets) &&
+    PUGL_LOAD_DEVICE(vkUpdateDescriptorSets) &&
+    PUGL_LOAD_DEVICE(vkCreateShaderModule) &&
+    PUGL_LOAD_DEVICE(vkDestroyShaderModule) &&
+    PUGL_LOAD_DEVICE(vkCreatePipelineLayout) &&
+    PUGL_LOAD_DEVICE(vkDestroyPipelineLayout) &&
+    PUGL_LOAD_DEVICE(vkCreateGraphicsPipelines) &&
+    PUGL_LOAD_DEVICE(vkDestroyPipeline) &&
+    PUGL_LOAD_DEVICE(vkCreateRenderPass) &&
+    PUGL_LOAD_DEVICE(vkDestroyRenderPass) &&
+    PUGL_LOAD_DEVICE(vkCreateFramebuffer) &&
+    PUGL_LOAD_DEVICE(vkDestroyFramebuffer) &&
+    PUGL_LOAD_DEVICE(vkCreateCommandPool) &&
+    PUGL_LOAD_DEVICE(vkDestroyCommandPool) &&
+    PUGL_LOAD_DEVICE(vkResetCommandPool) &&
+    PUGL_LOAD_DEVICE(vkAllocateCommandBuffers) &&
+    PUGL_LOAD_DEVICE(vkFreeCommandBuffers) &&
+    PUGL_LOAD_DEVICE(vkBeginCommandBuffer) &&
+    PUGL_LOAD_DEVICE(vkEndCommandBuffer) &&
+    PUGL_LOAD_DEVICE(vkResetCommandBuffer) &&
+    PUGL_LOAD_DEVICE(vkCmdBeginRenderPass) &&
+    PUGL_LOAD_DEVICE(vkCmdEndRenderPass) &&
+    PUGL_LOAD_DEVICE(vkCmdBindPipeline) &&
+    PUGL_LOAD_DEVICE(vkCmdBindDescriptorSets) &&
+    PUGL_LOAD_DEVICE(vkCmdBindVertexBuffers) &&
+    PUGL_LOAD_DEVICE(vkCmdBindIndexBuffer) &&
+    PUGL_LOAD_DEVICE(vkCmdSetViewport) &&
+    PUGL_LOAD_DEVICE(vkCmdSetScissor) &&
+    PUGL_LOAD_DEVICE(vkCmdPushConstants) &&
+    PUGL_LOAD_DEVICE(vkCmdDraw) &&
+    PUGL_LOAD_DEVICE(vkCmdDrawIndexed) &&
+    PUGL_LOAD_DEVICE(vkCmdCopyBuffer) &&
+    PUGL_LOAD_DEVICE(vkCmdCopyBufferToImage) &&
+    PUGL_LOAD_DEVICE(vkCmdClearColorImage) &&
+    PUGL_LOAD_DEVICE(vkCmdPipelineBarrier);
+
+  if (!hasCore) {
+    return VK_ERROR_INITIALIZATION_FAILED;
+  }
+
+  // Load functions from VK_KHR_swapchain, which are null if it isn't enabled
+  PUGL_LOAD_DEVICE(vkCreateSwapchainKHR);
+  PUGL_LOAD_DEVICE(vkDestroySwapchainKHR);
+  PUGL_LOAD_DEVICE(vkGetSwapchainImagesKHR);
+  PUGL_LOAD_DEVICE(vkAcquireNextImageKHR);
+  PUGL_LOAD_DEVICE(vkQueuePresentKHR);
+
+  return VK_SUCCESS;
+}
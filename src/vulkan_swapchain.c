@@ -0,0 +1,658 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+// Portable swapchain helper for the Vulkan backends
+
+#define VK_NO_PROTOTYPES 1
+
+#include "allocator.h"
+#include "types.h"
+
+#include "pugl/pugl.h"
+#include "pugl/vulkan.h"
+
+#include <vulkan/vulkan_core.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Maximum number of frames in flight
+#define PUGL_MAX_FRAMES_IN_FLIGHT 8u
+
+/// Vulkan functions used by the swapchain
+typedef struct {
+  PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR getSurfaceCapabilities;
+  PFN_vkGetPhysicalDeviceSurfaceFormatsKHR      getSurfaceFormats;
+  PFN_vkGetPhysicalDeviceSurfacePresentModesKHR getSurfacePresentModes;
+
+  PFN_vkGetDeviceProcAddr     vkGetDeviceProcAddr;
+  PFN_vkCreateSwapchainKHR    vkCreateSwapchainKHR;
+  PFN_vkDestroySwapchainKHR   vkDestroySwapchainKHR;
+  PFN_vkGetSwapchainImagesKHR vkGetSwapchainImagesKHR;
+  PFN_vkAcquireNextImageKHR   vkAcquireNextImageKHR;
+  PFN_vkQueuePresentKHR       vkQueuePresentKHR;
+  PFN_vkCreateImageView       vkCreateImageView;
+  PFN_vkDestroyImageView      vkDestroyImageView;
+  PFN_vkCreateSemaphore       vkCreateSemaphore;
+  PFN_vkDestroySemaphore      vkDestroySemaphore;
+  PFN_vkCreateFence           vkCreateFence;
+  PFN_vkDestroyFence          vkDestroyFence;
+  PFN_vkWaitForFences         vkWaitForFences;
+  PFN_vkResetFences           vkResetFences;
+  PFN_vkDeviceWaitIdle        vkDeviceWaitIdle;
+} PuglSwapchainApi;
+
+struct PuglSwapchainImpl {
+  PuglView*          view;
+  PuglSwapchainInfo  info;
+  PuglSwapchainApi   api;
+  VkSurfaceFormatKHR format;
+  VkPresentModeKHR   presentMode;
+  VkSwapchainKHR     swapchain;
+  VkExtent2D         extent;
+  PuglViewSize       size;           ///< View size the swapchain was made for
+  int                swapInterval;   ///< Swap interval hint as written back
+  int                adaptiveSwap;   ///< Adaptive swap hint as written back
+  uint32_t           numImages;      ///< Number of swapchain images
+  VkImage*           images;         ///< Swapchain images
+  VkImageView*       imageViews;     ///< View of each image
+  VkSemaphore*       renderFinished; ///< Rendering semaphore for each image
+  VkFence*           imageFences;    ///< Fence of the frame using each image
+  VkSemaphore        imageAvailable[PUGL_MAX_FRAMES_IN_FLIGHT];
+  VkFence            frameFences[PUGL_MAX_FRAMES_IN_FLIGHT];
+  uint32_t           currentFrame;
+  bool               outdated;  ///< Swapchain must be recreated before use
+  bool               recreated; ///< Swapchain was recreated since last acquire
+};
+
+static PFN_vkVoidFunction
+getInstanceProc(const PuglSwapchain* const swapchain, const char* const name)
+{
+  return swapchain->info.vkGetInstanceProcAddr(swapchain->info.instance, name);
+}
+
+static PFN_vkVoidFunction
+getDeviceProc(const PuglSwapchain* const swapchain, const char* const name)
+{
+  return swapchain->api.vkGetDeviceProcAddr(swapchain->info.device, name);
+}
+
+#define PUGL_LOAD_DEVICE_FUNC(swapchain, name) \
+  ((swapchain)->api.name = (PFN_##name)getDeviceProc((swapchain), #name))
+
+static bool
+loadFunctions(PuglSwapchain* const swapchain)
+{
+  PuglSwapchainApi* const api = &swapchain->api;
+
+  api->getSurfaceCapabilities =
+    (PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR)getInstanceProc(
+      swapchain, "vkGetPhysicalDeviceSurfaceCapabilitiesKHR");
+
+  api->getSurfaceFormats = (PFN_vkGetPhysicalDeviceSurfaceFormatsKHR)
+    getInstanceProc(swapchain, "vkGetPhysicalDeviceSurfaceFormatsKHR");
+
+  api->getSurfacePresentModes =
+    (PFN_vkGetPhysicalDeviceSurfacePresentModesKHR)getInstanceProc(
+      swapchain, "vkGetPhysicalDeviceSurfacePresentModesKHR");
+
+  api->vkGetDeviceProcAddr = (PFN_vkGetDeviceProcAddr)getInstanceProc(
+    swapchain, "vkGetDeviceProcAddr");
+
+  return api->getSurfaceCapabilities && api->getSurfaceFormats &&
+         api->getSurfacePresentModes && api->vkGetDeviceProcAddr &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkCreateSwapchainKHR) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkDestroySwapchainKHR) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkGetSwapchainImagesKHR) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkAcquireNextImageKHR) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkQueuePresentKHR) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkCreateImageView) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkDestroyImageView) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkCreateSemaphore) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkDestroySemaphore) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkCreateFence) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkDestroyFence) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkWaitForFences) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkResetFences) &&
+         PUGL_LOAD_DEVICE_FUNC(swapchain, vkDeviceWaitIdle);
+}
+
+static VkResult
+chooseFormat(PuglSwapchain* const swapchain)
+{
+  const PuglSwapchainInfo* const info  = &swapchain->info;
+  const PuglWorld* const         world = swapchain->view->world;
+
+  uint32_t nFormats = 0u;
+  VkResult r        = VK_SUCCESS;
+  if ((r = swapchain->api.getSurfaceFormats(
+         info->physicalDevice, info->surface, &nFormats, NULL))) {
+    return r;
+  }
+
+  if (!nFormats) {
+    return VK_ERROR_FORMAT_NOT_SUPPORTED;
+  }
+
+  VkSurfaceFormatKHR* const formats = (VkSurfaceFormatKHR*)puglCalloc(
+    world, nFormats, sizeof(VkSurfaceFormatKHR));
+  if (!formats) {
+    return VK_ERROR_OUT_OF_HOST_MEMORY;
+  }
+
+  if ((r = swapchain->api.getSurfaceFormats(
+         info->physicalDevice, info->surface, &nFormats, formats)) &&
+      r != VK_INCOMPLETE) {
+    puglFree(world, formats);
+    return r;
+  }
+
+  // Use the requested format if possible, then fall back to 8-bit BGRA
+  const VkSurfaceFormatKHR fallback = {VK_FORMAT_B8G8R8A8_UNORM,
+                                       VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
+  const VkSurfaceFormatKHR wanted =
+    info->format.format == VK_FORMAT_UNDEFINED ? fallback : info->format;
+
+  swapchain->format = formats[0];
+  if (nFormats == 1u && formats[0].format == VK_FORMAT_UNDEFINED) {
+    swapchain->format = wanted; // Surface has no preference
+  } else {
+    for (uint32_t i = 0u; i < nFormats; ++i) {
+      if (formats[i].format == wanted.format &&
+          formats[i].colorSpace == wanted.colorSpace) {
+        swapchain->format = formats[i];
+        break;
+      }
+
+      if (formats[i].format == fallback.format &&
+          formats[i].colorSpace == fallback.colorSpace) {
+        swapchain->format = formats[i];
+      }
+    }
+  }
+
+  puglFree(world, formats);
+  return VK_SUCCESS;
+}
+
+static bool
+hasPresentMode(const VkPresentModeKHR* const modes,
+               const uint32_t                nModes,
+               const VkPresentModeKHR        mode)
+{
+  for (uint32_t i = 0u; i < nModes; ++i) {
+    if (modes[i] == mode) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static VkResult
+choosePresentMode(PuglSwapchain* const swapchain)
+{
+  const PuglSwapchainInfo* const info = &swapchain->info;
+  PuglView* const                view = swapchain->view;
+
+  uint32_t nModes = 0u;
+  VkResult r      = VK_SUCCESS;
+  if ((r = swapchain->api.getSurfacePresentModes(
+         info->physicalDevice, info->surface, &nModes, NULL))) {
+    return r;
+  }
+
+  VkPresentModeKHR* const modes = (VkPresentModeKHR*)puglCalloc(
+    view->world, nModes ? nModes : 1u, sizeof(VkPresentModeKHR));
+  if (!modes) {
+    return VK_ERROR_OUT_OF_HOST_MEMORY;
+  }
+
+  if ((r = swapchain->api.getSurfacePresentModes(
+         info->physicalDevice, info->surface, &nModes, modes)) &&
+      r != VK_INCOMPLETE) {
+    puglFree(view->world, modes);
+    return r;
+  }
+
+  /* An interval of zero prefers mailbox, which doesn't tear, and adaptive swap
+     uses relaxed FIFO to tear when late.  FIFO is always supported. */
+  const int interval = view->hints[PUGL_SWAP_INTERVAL];
+  const int adaptive = view->hints[PUGL_ADAPTIVE_SWAP];
+
+  swapchain->presentMode = VK_PRESENT_MODE_FIFO_KHR;
+  if (interval == 0) {
+    if (hasPresentMode(modes, nModes, VK_PRESENT_MODE_MAILBOX_KHR)) {
+      swapchain->presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+    } else if (hasPresentMode(modes, nModes, VK_PRESENT_MODE_IMMEDIATE_KHR)) {
+      swapchain->presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    }
+  } else if (adaptive == PUGL_TRUE &&
+             hasPresentMode(modes, nModes, VK_PRESENT_MODE_FIFO_RELAXED_KHR)) {
+    swapchain->presentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+  }
+
+  // Write the actual configuration back to the view hints
+  switch (swapchain->presentMode) {
+  case VK_PRESENT_MODE_IMMEDIATE_KHR:
+  case VK_PRESENT_MODE_MAILBOX_KHR:
+    view->hints[PUGL_SWAP_INTERVAL] = 0;
+    view->hints[PUGL_ADAPTIVE_SWAP] = PUGL_FALSE;
+    break;
+  case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+    view->hints[PUGL_SWAP_INTERVAL] = 1;
+    view->hints[PUGL_ADAPTIVE_SWAP] = PUGL_TRUE;
+    break;
+  default:
+    view->hints[PUGL_SWAP_INTERVAL] = 1;
+    view->hints[PUGL_ADAPTIVE_SWAP] = PUGL_FALSE;
+    break;
+  }
+
+  swapchain->swapInterval = view->hints[PUGL_SWAP_INTERVAL];
+  swapchain->adaptiveSwap = view->hints[PUGL_ADAPTIVE_SWAP];
+
+  puglFree(view->world, modes);
+  return VK_SUCCESS;
+}
+
+static void
+destroyImages(PuglSwapchain* const swapchain)
+{
+  const PuglSwapchainApi* const api       = &swapchain->api;
+  const VkDevice                device    = swapchain->info.device;
+  const VkAllocationCallbacks*  allocator = swapchain->info.allocator;
+
+  for (uint32_t i = 0u; i < swapchain->numImages; ++i) {
+    if (swapchain->renderFinished && swapchain->renderFinished[i]) {
+      api->vkDestroySemaphore(device, swapchain->renderFinished[i], allocator);
+    }
+
+    if (swapchain->imageViews && swapchain->imageViews[i]) {
+      api->vkDestroyImageView(device, swapchain->imageViews[i], allocator);
+    }
+  }
+
+  const PuglWorld* const world = swapchain->view->world;
+
+  puglFree(world, swapchain->imageFences);
+  puglFree(world, swapchain->renderFinished);
+  puglFree(world, swapchain->imageViews);
+  puglFree(world, swapchain->images);
+
+  swapchain->imageFences    = NULL;
+  swapchain->renderFinished = NULL;
+  swapchain->imageViews     = NULL;
+  swapchain->images         = NULL;
+  swapchain->numImages      = 0u;
+}
+
+static VkResult
+createImages(PuglSwapchain* const swapchain)
+{
+  const PuglSwapchainApi* const api       = &swapchain->api;
+  const VkDevice                device    = swapchain->info.device;
+  const VkAllocationCallbacks*  allocator = swapchain->info.allocator;
+
+  uint32_t n = 0u;
+  VkResult r = VK_SUCCESS;
+  if ((r = api->vkGetSwapchainImagesKHR(
+         device, swapchain->swapchain, &n, NULL))) {
+    return r;
+  }
+
+  const PuglWorld* const world = swapchain->view->world;
+
+  swapchain->numImages = n;
+  swapchain->images    = (VkImage*)puglCalloc(world, n, sizeof(VkImage));
+  swapchain->imageViews =
+    (VkImageView*)puglCalloc(world, n, sizeof(VkImageView));
+  swapchain->renderFinished =
+    (VkSemaphore*)puglCalloc(world, n, sizeof(VkSemaphore));
+  swapchain->imageFences = (VkFence*)puglCalloc(world, n, sizeof(VkFence));
+  if (!swapchain->images || !swapchain->imageViews ||
+      !swapchain->renderFinished || !swapchain->imageFences) {
+    return VK_ERROR_OUT_OF_HOST_MEMORY;
+  }
+
+  if ((r = api->vkGetSwapchainImagesKHR(
+         device, swapchain->swapchain, &n, swapchain->images))) {
+    return r;
+  }
+
+  const VkSemaphoreCreateInfo semaphoreInfo = {
+    VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, NULL, 0};
+
+  for (uint32_t i = 0u; i < n; ++i) {
+    const VkImageViewCreateInfo viewInfo = {
+      VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      NULL,
+      0,
+      swapchain->images[i],
+      VK_IMAGE_VIEW_TYPE_2D,
+      swapchain->format.format,
+      {VK_COMPONENT_SWIZZLE_IDENTITY,
+       VK_COMPONENT_SWIZZLE_IDENTITY,
+       VK_COMPONENT_SWIZZLE_IDENTITY,
+       VK_COMPONENT_SWIZZLE_IDENTITY},
+      {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 1u, 0u, 1u},
+    };
+
+    if ((r = api->vkCreateImageView(
+           device, &viewInfo, allocator, &swapchain->imageViews[i])) ||
+        (r = api->vkCreateSemaphore(
+           device, &semaphoreInfo, allocator, &swapchain->renderFinished[i]))) {
+      return r;
+    }
+  }
+
+  return VK_SUCCESS;
+}
+
+static VkResult
+recreateSwapchain(PuglSwapchain* const swapchain)
+{
+  const PuglSwapchainInfo* const info = &swapchain->info;
+  const PuglSwapchainApi* const  api  = &swapchain->api;
+  PuglView* const                view = swapchain->view;
+
+  // Get the size from the last configure event that the application handled
+  const PuglViewSize size = {view->lastConfigure.width,
+                             view->lastConfigure.height};
+
+  VkSurfaceCapabilitiesKHR caps;
+  VkResult                 r = VK_SUCCESS;
+  if ((r = api->vkDeviceWaitIdle(info->device)) ||
+      (r = api->getSurfaceCapabilities(
+         info->physicalDevice, info->surface, &caps)) ||
+      (r = choosePresentMode(swapchain))) {
+    return r;
+  }
+
+  // Use the surface size if it is known, otherwise the view size
+  VkExtent2D extent = caps.currentExtent;
+  if (extent.width == UINT32_MAX) {
+    extent.width  = size.width;
+    extent.height = size.height;
+  }
+
+  if (extent.width < caps.minImageExtent.width) {
+    extent.width = caps.minImageExtent.width;
+  } else if (extent.width > caps.maxImageExtent.width) {
+    extent.width = caps.maxImageExtent.width;
+  }
+
+  if (extent.height < caps.minImageExtent.height) {
+    extent.height = caps.minImageExtent.height;
+  } else if (extent.height > caps.maxImageExtent.height) {
+    extent.height = caps.maxImageExtent.height;
+  }
+
+  if (!extent.width || !extent.height) {
+    return VK_NOT_READY; // Minimized or not mapped yet, nothing to draw to
+  }
+
+  // Use one more image than the minimum to avoid waiting on the driver
+  uint32_t minImageCount = caps.minImageCount + 1u;
+  if (caps.maxImageCount && minImageCount > caps.maxImageCount) {
+    minImageCount = caps.maxImageCount;
+  }
+
+  const VkSwapchainCreateInfoKHR createInfo = {
+    VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+    NULL,
+    0,
+    info->surface,
+    minImageCount,
+    swapchain->format.format,
+    swapchain->format.colorSpace,
+    extent,
+    1u,
+    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | info->imageUsage,
+    VK_SHARING_MODE_EXCLUSIVE,
+    0u,
+    NULL,
+    caps.currentTransform,
+    VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+    swapchain->presentMode,
+    VK_TRUE,
+    swapchain->swapchain,
+  };
+
+  VkSwapchainKHR newSwapchain = VK_NULL_HANDLE;
+  if ((r = api->vkCreateSwapchainKHR(
+         info->device, &createInfo, info->allocator, &newSwapchain))) {
+    return r;
+  }
+
+  // Destroy the old swapchain, which is now retired, and everything using it
+  destroyImages(swapchain);
+  if (swapchain->swapchain) {
+    api->vkDestroySwapchainKHR(
+      info->device, swapchain->swapchain, info->allocator);
+  }
+
+  swapchain->swapchain = newSwapchain;
+  swapchain->extent    = extent;
+  swapchain->size      = size;
+  swapchain->outdated  = false;
+  swapchain->recreated = true;
+
+  if ((r = createImages(swapchain))) {
+    swapchain->outdated = true;
+  }
+
+  return r;
+}
+
+VkResult
+puglCreateSwapchain(PuglView* const                view,
+                    const PuglSwapchainInfo* const info,
+                    PuglSwapchain** const          swapchain)
+{
+  *swapchain = NULL;
+
+  if (info->numFramesInFlight > PUGL_MAX_FRAMES_IN_FLIGHT) {
+    return VK_ERROR_INITIALIZATION_FAILED;
+  }
+
+  PuglSwapchain* const self =
+    (PuglSwapchain*)puglCalloc(view->world, 1, sizeof(PuglSwapchain));
+  if (!self) {
+    return VK_ERROR_OUT_OF_HOST_MEMORY;
+  }
+
+  self->view     = view;
+  self->info     = *info;
+  self->outdated = true;
+  if (!self->info.numFramesInFlight) {
+    self->info.numFramesInFlight = 2u;
+  }
+
+  if (!loadFunctions(self)) {
+    puglFree(view->world, self);
+    return VK_ERROR_EXTENSION_NOT_PRESENT;
+  }
+
+  const VkSemaphoreCreateInfo semaphoreInfo = {
+    VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, NULL, 0};
+
+  // Fences are created signalled, so the first wait for each frame succeeds
+  const VkFenceCreateInfo fenceInfo = {
+    VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, NULL, VK_FENCE_CREATE_SIGNALED_BIT};
+
+  VkResult r = VK_SUCCESS;
+  for (uint32_t i = 0u; !r && i < self->info.numFramesInFlight; ++i) {
+    if (!(r = self->api.vkCreateSemaphore(info->device,
+                                          &semaphoreInfo,
+                                          info->allocator,
+                                          &self->imageAvailable[i]))) {
+      r = self->api.vkCreateFence(
+        info->device, &fenceInfo, info->allocator, &self->frameFences[i]);
+    }
+  }
+
+  if (r || (r = chooseFormat(self))) {
+    puglDestroySwapchain(self);
+    return r;
+  }
+
+  *swapchain = self;
+  return VK_SUCCESS;
+}
+
+void
+puglDestroySwapchain(PuglSwapchain* const swapchain)
+{
+  if (!swapchain) {
+    return;
+  }
+
+  const PuglSwapchainApi* const api       = &swapchain->api;
+  const VkDevice                device    = swapchain->info.device;
+  const VkAllocationCallbacks*  allocator = swapchain->info.allocator;
+
+  api->vkDeviceWaitIdle(device);
+  destroyImages(swapchain);
+
+  if (swapchain->swapchain) {
+    api->vkDestroySwapchainKHR(device, swapchain->swapchain, allocator);
+  }
+
+  for (uint32_t i = 0u; i < swapchain->info.numFramesInFlight; ++i) {
+    if (swapchain->frameFences[i]) {
+      api->vkDestroyFence(device, swapchain->frameFences[i], allocator);
+    }
+
+    if (swapchain->imageAvailable[i]) {
+      api->vkDestroySemaphore(device, swapchain->imageAvailable[i], allocator);
+    }
+  }
+
+  puglFree(swapchain->view->world, swapchain);
+}
+
+VkSurfaceFormatKHR
+puglGetSwapchainFormat(const PuglSwapchain* const swapchain)
+{
+  return swapchain->format;
+}
+
+/// Return true if the view has changed in a way that requires a new swapchain
+static bool
+needsRecreate(const PuglSwapchain* const swapchain)
+{
+  const PuglView* const view = swapchain->view;
+
+  return swapchain->outdated || !swapchain->swapchain ||
+         view->lastConfigure.width != swapchain->size.width ||
+         view->lastConfigure.height != swapchain->size.height ||
+         view->hints[PUGL_SWAP_INTERVAL] != swapchain->swapInterval ||
+         view->hints[PUGL_ADAPTIVE_SWAP] != swapchain->adaptiveSwap;
+}
+
+VkResult
+puglAcquireSwapchainImage(PuglSwapchain* const      swapchain,
+                          PuglSwapchainImage* const image)
+{
+  const PuglSwapchainApi* const api    = &swapchain->api;
+  const VkDevice                device = swapchain->info.device;
+  const uint32_t                frame  = swapchain->currentFrame;
+  const VkFence                 fence  = swapchain->frameFences[frame];
+
+  memset(image, 0, sizeof(PuglSwapchainImage));
+
+  VkResult r = VK_SUCCESS;
+  if (needsRecreate(swapchain) && (r = recreateSwapchain(swapchain))) {
+    return r;
+  }
+
+  // Wait until the last submission for this frame in flight is finished
+  if ((r = api->vkWaitForFences(device, 1u, &fence, VK_TRUE, UINT64_MAX))) {
+    return r;
+  }
+
+  // Acquire an image, recreating the swapchain and retrying once if necessary
+  uint32_t index = 0u;
+  for (unsigned attempt = 0u; attempt < 2u; ++attempt) {
+    r = api->vkAcquireNextImageKHR(device,
+                                   swapchain->swapchain,
+                                   UINT64_MAX,
+                                   swapchain->imageAvailable[frame],
+                                   VK_NULL_HANDLE,
+                                   &index);
+
+    if (r == VK_ERROR_OUT_OF_DATE_KHR && !attempt) {
+      if ((r = recreateSwapchain(swapchain))) {
+        return r;
+      }
+    } else {
+      break;
+    }
+  }
+
+  if (r == VK_SUBOPTIMAL_KHR) {
+    swapchain->outdated = true; // Still usable, but recreate for next frame
+  } else if (r) {
+    return r;
+  }
+
+  // Wait for any earlier frame that is still using this image
+  const VkFence imageFence = swapchain->imageFences[index];
+  if (imageFence && imageFence != fence &&
+      (r = api->vkWaitForFences(
+         device, 1u, &imageFence, VK_TRUE, UINT64_MAX))) {
+    return r;
+  }
+
+  swapchain->imageFences[index] = fence;
+  if ((r = api->vkResetFences(device, 1u, &fence))) {
+    return r;
+  }
+
+  image->image          = swapchain->images[index];
+  image->imageView      = swapchain->imageViews[index];
+  image->imageAvailable = swapchain->imageAvailable[frame];
+  image->renderFinished = swapchain->renderFinished[index];
+  image->fence          = fence;
+  image->extent         = swapchain->extent;
+  image->format         = swapchain->format.format;
+  image->imageIndex     = index;
+  image->numImages      = swapchain->numImages;
+  image->frameIndex     = frame;
+  image->recreated      = swapchain->recreated;
+
+  swapchain->recreated = false;
+  return VK_SUCCESS;
+}
+
+VkResult
+puglPresentSwapchainImage(PuglSwapchain* const            swapchain,
+                          const PuglSwapchainImage* const image)
+{
+  const VkPresentInfoKHR presentInfo = {
+    VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+    NULL,
+    1u,
+    &image->renderFinished,
+    1u,
+    &swapchain->swapchain,
+    &image->imageIndex,
+    NULL,
+  };
+
+  const VkQueue  queue = swapchain->info.presentQueue;
+  const VkResult r     = swapchain->api.vkQueuePresentKHR(queue, &presentInfo);
+
+  swapchain->currentFrame =
+    (swapchain->currentFrame + 1u) % swapchain->info.numFramesInFlight;
+
+  if (r == VK_ERROR_OUT_OF_DATE_KHR || r == VK_SUBOPTIMAL_KHR) {
+    swapchain->outdated = true;
+    return VK_SUCCESS;
+  }
+
+  return r;
+}
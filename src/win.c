@@ -3,6 +3,7 @@
 
 #include "win.h"
 
+#include "allocator.h"
 #include "implementation.h"
 
 #include "pugl/pugl.h"
@@ -42,12 +43,16 @@ LRESULT CALLBACK
 wndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
 
 static wchar_t*
-puglUtf8ToWideChar(const char* const utf8)
+puglUtf8ToWideChar(const PuglWorld* const world, const char* const utf8)
 {
   const int len = MultiByteToWideChar(CP_UTF8, 0, utf8, -1, NULL, 0);
   if (len > 0) {
-    wchar_t* result = (wchar_t*)calloc((size_t)len, sizeof(wchar_t));
-    MultiByteToWideChar(CP_UTF8, 0, utf8, -1, result, len);
+    wchar_t* result =
+      (wchar_t*)puglCalloc(world, (size_t)len, sizeof(wchar_t));
+    if (result) {
+      MultiByteToWideChar(CP_UTF8, 0, utf8, -1, result, len);
+    }
+
     return result;
   }
 
@@ -55,13 +60,18 @@ puglUtf8ToWideChar(const char* const utf8)
 }
 
 static char*
-puglWideCharToUtf8(const wchar_t* const wstr, size_t* len)
+puglWideCharToUtf8(const PuglWorld* const world,
+                   const wchar_t* const   wstr,
+                   size_t*                len)
 {
   int n = WideCharToMultiByte(CP_UTF8, 0, wstr, -1, NULL, 0, NULL, NULL);
   if (n > 0) {
-    char* result = (char*)calloc((size_t)n, sizeof(char));
-    WideCharToMultiByte(CP_UTF8, 0, wstr, -1, result, n, NULL, NULL);
-    *len = (size_t)n - 1;
+    char* result = (char*)puglCalloc(world, (size_t)n, sizeof(char));
+    if (result) {
+      WideCharToMultiByte(CP_UTF8, 0, wstr, -1, result, n, NULL, NULL);
+      *len = (size_t)n - 1;
+    }
+
     return result;
   }
 
@@ -144,10 +154,12 @@ puglWinGetViewScaleFactor(const PuglView* const view)
 }
 
 PuglWorldInternals*
-puglInitWorldInternals(PuglWorldType type, PuglWorldFlags PUGL_UNUSED(flags))
+puglInitWorldInternals(PuglWorld*     world,
+                       PuglWorldType  type,
+                       PuglWorldFlags PUGL_UNUSED(flags))
 {
   PuglWorldInternals* impl =
-    (PuglWorldInternals*)calloc(1, sizeof(PuglWorldInternals));
+    (PuglWorldInternals*)puglCalloc(world, 1, sizeof(PuglWorldInternals));
   if (!impl) {
     return NULL;
   }
@@ -179,9 +191,9 @@ puglGetNativeWorld(PuglWorld* PUGL_UNUSED(world))
 }
 
 PuglInternals*
-puglInitViewInternals(PuglWorld* PUGL_UNUSED(world))
+puglInitViewInternals(PuglWorld* world)
 {
-  return (PuglInternals*)calloc(1, sizeof(PuglInternals));
+  return (PuglInternals*)puglCalloc(world, 1, sizeof(PuglInternals));
 }
 
 static PuglStatus
@@ -292,7 +304,7 @@ puglFreeViewInternals(PuglView* view)
 
     ReleaseDC(view->impl->hwnd, view->impl->hdc);
     DestroyWindow(view->impl->hwnd);
-    free(view->impl);
+    puglFree(view->world, view->impl);
   }
 }
 
@@ -300,7 +312,7 @@ void
 puglFreeWorldInternals(PuglWorld* world)
 {
   UnregisterClass(world->className, NULL);
-  free(world->impl);
+  puglFree(world, world->impl);
 }
 
 static PuglKey
@@ -914,10 +926,10 @@ puglUpdate(PuglWorld* world, double timeout)
   const double startTime = puglGetTime(world);
   PuglStatus   st        = PUGL_SUCCESS;
 
-  if (timeout < 0.0) {
+  if (timeout < 0.0 && !world->numIdleTasks) {
     st = puglPollWinEvents(world, timeout);
     st = st ? st : puglDispatchWinEvents(world);
-  } else if (timeout == 0.0) {
+  } else if (timeout == 0.0 || world->numIdleTasks) {
     st = puglDispatchWinEvents(world);
   } else {
     const double endTime = startTime + timeout - 0.001;
@@ -937,6 +949,10 @@ puglUpdate(PuglWorld* world, double timeout)
     UpdateWindow(world->views[i]->impl->hwnd);
   }
 
+  if (world->numIdleTasks) {
+    puglRunIdleTasks(world, timeout > 0.0 ? startTime + timeout : -1.0);
+  }
+
   return st;
 }
 
@@ -948,6 +964,38 @@ puglProcessEvents(PuglView* view)
 }
 #endif
 
+PuglStatus
+puglPrepareUpdate(PuglWorld* world, double* timeout)
+{
+  (void)world;
+
+  *timeout = 0.0;
+  return PUGL_UNSUPPORTED;
+}
+
+size_t
+puglGetUpdateFds(const PuglWorld* world, int* fds, size_t maxFds)
+{
+  (void)world;
+  (void)fds;
+  (void)maxFds;
+
+  return 0u;
+}
+
+bool
+puglCheckUpdate(PuglWorld* world)
+{
+  (void)world;
+  return true;
+}
+
+PuglStatus
+puglDispatchUpdate(PuglWorld* world)
+{
+  return puglUpdate(world, 0.0);
+}
+
 LRESULT CALLBACK
 wndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
@@ -1009,13 +1057,13 @@ puglGetNativeWindow(PuglView* view)
 PuglStatus
 puglSetWindowTitle(PuglView* view, const char* title)
 {
-  puglSetString(&view->title, title);
+  puglSetString(view->world, &view->title, title);
 
   if (view->impl->hwnd) {
-    wchar_t* wtitle = puglUtf8ToWideChar(title);
+    wchar_t* wtitle = puglUtf8ToWideChar(view->world, title);
     if (wtitle) {
       SetWindowTextW(view->impl->hwnd, wtitle);
-      free(wtitle);
+      puglFree(view->world, wtitle);
     }
   }
 
@@ -1209,9 +1257,10 @@ puglGetClipboard(PuglView* const view,
     return NULL;
   }
 
-  free(view->impl->clipboard.data);
+  puglFree(view->world, view->impl->clipboard.data);
+  view->impl->clipboard.len  = 0u;
   view->impl->clipboard.data =
-    puglWideCharToUtf8(wstr, &view->impl->clipboard.len);
+    puglWideCharToUtf8(view->world, wstr, &view->impl->clipboard.len);
 
   GlobalUnlock(mem);
   CloseClipboard();
@@ -1228,7 +1277,7 @@ puglSetClipboard(PuglView* const   view,
 {
   PuglInternals* const impl = view->impl;
 
-  PuglStatus st = puglSetBlob(&view->impl->clipboard, data, len);
+  PuglStatus st = puglSetBlob(view->world, &view->impl->clipboard, data, len);
   if (st) {
     return st;
   }
@@ -1268,6 +1317,29 @@ puglSetClipboard(PuglView* const   view,
   return PUGL_SUCCESS;
 }
 
+PuglStatus
+puglOfferClipboard(PuglView* const          view,
+                   const char* const* const types,
+                   const uint32_t           numTypes,
+                   const PuglClipboardFunc  provider)
+{
+  if (!numTypes || !provider) {
+    return PUGL_BAD_PARAMETER;
+  }
+
+  // Only text is supported, so get it immediately if it is offered
+  for (uint32_t i = 0u; i < numTypes; ++i) {
+    if (!strcmp(types[i], "text/plain")) {
+      size_t            len  = 0;
+      const void* const data = provider(view, i, &len);
+
+      return data ? puglSetClipboard(view, types[i], data, len) : PUGL_FAILURE;
+    }
+  }
+
+  return PUGL_UNSUPPORTED;
+}
+
 PuglStatus
 puglPaste(PuglView* const view)
 {
@@ -1,6 +1,8 @@
 // Copyright 2012-2022 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
+#include "allocator.h"
+#include "cairo_layers.h"
 #include "stub.h"
 #include "types.h"
 #include "win.h"
@@ -10,13 +12,14 @@
 #include <cairo-win32.h>
 #include <cairo.h>
 
-#include <stdlib.h>
+#include <stddef.h>
 
 typedef struct {
   cairo_surface_t* surface;
   cairo_t*         cr;
   HDC              drawDc;
   HBITMAP          drawBitmap;
+  PuglCairoLayers  layers;
 } PuglWinCairoSurface;
 
 static PuglStatus
@@ -49,14 +52,26 @@ puglWinCairoDestroyDrawContext(PuglView* view)
   return PUGL_SUCCESS;
 }
 
+static PuglWinCairoSurface*
+puglWinCairoGetSurface(PuglView* view)
+{
+  // Allocate the surface on demand, since layers can be added before realizing
+  PuglInternals* const impl = view->impl;
+  if (!impl->surface) {
+    impl->surface = (PuglWinCairoSurface*)puglCalloc(
+      view->world, 1, sizeof(PuglWinCairoSurface));
+  }
+
+  return (PuglWinCairoSurface*)impl->surface;
+}
+
 static PuglStatus
 puglWinCairoConfigure(PuglView* view)
 {
   const PuglStatus st = puglWinConfigure(view);
 
-  if (!st) {
-    view->impl->surface =
-      (PuglWinCairoSurface*)calloc(1, sizeof(PuglWinCairoSurface));
+  if (!st && !puglWinCairoGetSurface(view)) {
+    return PUGL_NO_MEMORY;
   }
 
   return st;
@@ -95,10 +110,13 @@ puglWinCairoDestroy(PuglView* view)
   PuglInternals* const       impl    = view->impl;
   PuglWinCairoSurface* const surface = (PuglWinCairoSurface*)impl->surface;
 
-  puglWinCairoClose(view);
-  puglWinCairoDestroyDrawContext(view);
-  free(surface);
-  impl->surface = NULL;
+  if (surface) {
+    puglWinCairoClose(view);
+    puglWinCairoDestroyDrawContext(view);
+    puglCairoFreeLayers(view, &surface->layers);
+    puglFree(view->world, surface);
+    impl->surface = NULL;
+  }
 }
 
 static PuglStatus
@@ -110,6 +128,13 @@ puglWinCairoEnter(PuglView* view, const PuglExposeEvent* expose)
       !(st = puglWinCairoOpen(view))) {
     PAINTSTRUCT ps;
     BeginPaint(view->impl->hwnd, &ps);
+
+    PuglWinCairoSurface* const surface =
+      (PuglWinCairoSurface*)view->impl->surface;
+
+    if (surface->layers.numLayers) {
+      st = puglCairoDrawLayers(view, &surface->layers, surface->cr, expose);
+    }
   }
 
   return st;
@@ -149,6 +174,27 @@ puglWinCairoGetContext(PuglView* view)
   return ((PuglWinCairoSurface*)view->impl->surface)->cr;
 }
 
+PuglCairoLayers*
+puglCairoGetLayers(PuglView* view)
+{
+  PuglWinCairoSurface* const surface = puglWinCairoGetSurface(view);
+
+  return surface ? &surface->layers : NULL;
+}
+
+PuglStatus
+puglSetCairoTileFunc(PuglView*         view,
+                     PuglCairoTileFunc drawTile,
+                     unsigned          numThreads,
+                     PuglSpan          tileSize)
+{
+  (void)drawTile;
+  (void)numThreads;
+  (void)tileSize;
+  return view->backend == puglCairoBackend() ? PUGL_UNSUPPORTED
+                                             : PUGL_BAD_BACKEND;
+}
+
 const PuglBackend*
 puglCairoBackend()
 {
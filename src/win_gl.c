@@ -1,6 +1,7 @@
 // Copyright 2012-2022 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
+#include "allocator.h"
 #include "stub.h"
 #include "types.h"
 #include "win.h"
@@ -12,7 +13,7 @@
 #include <GL/gl.h>
 
 #include <stdbool.h>
-#include <stdlib.h>
+#include <stddef.h>
 
 #define WGL_DRAW_TO_WINDOW_ARB 0x2001
 #define WGL_ACCELERATION_ARB 0x2003
@@ -112,6 +113,11 @@ puglWinGlConfigure(PuglView* view)
     view->hints[PUGL_SWAP_INTERVAL] = 1;
   }
 
+  // Adaptive swapping, render threads, and draw timing aren't supported
+  view->hints[PUGL_ADAPTIVE_SWAP] = PUGL_FALSE;
+  view->hints[PUGL_RENDER_THREAD] = PUGL_FALSE;
+  view->hints[PUGL_DRAW_TIMING]   = PUGL_FALSE;
+
   // clang-format off
   const int pixelAttrs[] = {
     WGL_DRAW_TO_WINDOW_ARB, GL_TRUE,
@@ -132,7 +138,11 @@ puglWinGlConfigure(PuglView* view)
   // clang-format on
 
   PuglWinGlSurface* const surface =
-    (PuglWinGlSurface*)calloc(1, sizeof(PuglWinGlSurface));
+    (PuglWinGlSurface*)puglCalloc(view->world, 1, sizeof(PuglWinGlSurface));
+  if (!surface) {
+    return PUGL_NO_MEMORY;
+  }
+
   impl->surface = surface;
 
   // Create fake window for getting at GL context
@@ -221,15 +231,33 @@ puglWinGlCreate(PuglView* view)
     return PUGL_SET_FORMAT_FAILED;
   }
 
+  // Get the context to share objects with, if any
+  HGLRC shareRc = NULL;
+  if (view->shareView) {
+    const PuglWinGlSurface* const shareSurface =
+      (const PuglWinGlSurface*)view->shareView->impl->surface;
+
+    if (view->shareView->backend != view->backend || !shareSurface ||
+        !shareSurface->hglrc) {
+      return PUGL_CREATE_CONTEXT_FAILED;
+    }
+
+    shareRc = shareSurface->hglrc;
+  }
+
   // Create GL context
   if (surface->procs.wglCreateContextAttribs &&
       !(surface->hglrc = surface->procs.wglCreateContextAttribs(
-          impl->hdc, 0, contextAttribs))) {
+          impl->hdc, shareRc, contextAttribs))) {
     return PUGL_CREATE_CONTEXT_FAILED;
   }
 
-  if (!(surface->hglrc = wglCreateContext(impl->hdc))) {
-    return PUGL_CREATE_CONTEXT_FAILED;
+  if (!surface->hglrc) {
+    // Fall back to a legacy context, which must share objects separately
+    if (!(surface->hglrc = wglCreateContext(impl->hdc)) ||
+        (shareRc && !wglShareLists(shareRc, surface->hglrc))) {
+      return PUGL_CREATE_CONTEXT_FAILED;
+    }
   }
 
   // Enter context and set swap interval
@@ -249,7 +277,7 @@ puglWinGlDestroy(PuglView* view)
   if (surface) {
     wglMakeCurrent(NULL, NULL);
     wglDeleteContext(surface->hglrc);
-    free(surface);
+    puglFree(view->world, surface);
     view->impl->surface = NULL;
   }
 }
@@ -299,6 +327,40 @@ puglGetProcAddress(const char* name)
            : (PuglGlFunc)GetProcAddress(GetModuleHandle("opengl32.dll"), name);
 }
 
+unsigned
+puglGetBufferAge(PuglView* view)
+{
+  (void)view;
+  return 0u;
+}
+
+PuglStatus
+puglGetFrameTiming(PuglView* view, PuglFrameTiming* timing)
+{
+  (void)view;
+  (void)timing;
+  return PUGL_UNSUPPORTED;
+}
+
+PuglStatus
+puglGetDrawTiming(PuglView* view, PuglDrawTiming* timing)
+{
+  (void)view;
+  (void)timing;
+  return PUGL_UNSUPPORTED;
+}
+
+PuglStatus
+puglSetShareView(PuglView* view, PuglView* shareView)
+{
+  if (view->impl->surface) {
+    return PUGL_FAILURE;
+  }
+
+  view->shareView = shareView;
+  return PUGL_SUCCESS;
+}
+
 PuglStatus
 puglEnterContext(PuglView* view)
 {
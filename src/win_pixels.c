@@ -0,0 +1,209 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "allocator.h"
+#include "stub.h"
+#include "types.h"
+#include "win.h"
+
+#include "pugl/pixels.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+  PuglPixelBuffer buffer;
+  HDC             drawDc;
+  HBITMAP         drawBitmap;
+  PuglRect        exposed; ///< Region of the current expose
+  bool            drawing; ///< True while handling an expose
+  bool            drawn;   ///< True if the buffer was drawn during an expose
+} PuglWinPixelsSurface;
+
+static PuglStatus
+puglWinPixelsConfigure(PuglView* view)
+{
+  const PuglStatus st = puglWinConfigure(view);
+
+  if (!st && !(view->impl->surface = (PuglWinPixelsSurface*)puglCalloc(
+                 view->world, 1, sizeof(PuglWinPixelsSurface)))) {
+    return PUGL_NO_MEMORY;
+  }
+
+  return st;
+}
+
+static void
+puglWinPixelsFreeBitmap(PuglView* view)
+{
+  PuglWinPixelsSurface* const surface =
+    (PuglWinPixelsSurface*)view->impl->surface;
+
+  DeleteDC(surface->drawDc);
+  DeleteObject(surface->drawBitmap);
+
+  surface->drawDc        = NULL;
+  surface->drawBitmap    = NULL;
+  surface->buffer.data   = NULL;
+  surface->buffer.width  = 0u;
+  surface->buffer.height = 0u;
+}
+
+/// Create a DIB section to draw to, which replaces any existing one
+static PuglStatus
+puglWinPixelsCreateBitmap(PuglView* const view,
+                          const PuglSpan  width,
+                          const PuglSpan  height)
+{
+  PuglInternals* const        impl    = view->impl;
+  PuglWinPixelsSurface* const surface = (PuglWinPixelsSurface*)impl->surface;
+
+  puglWinPixelsFreeBitmap(view);
+
+  // A negative height makes a top-down bitmap, with the first row at the top
+  BITMAPINFO info;
+  ZeroMemory(&info, sizeof(info));
+  info.bmiHeader.biSize        = sizeof(BITMAPINFOHEADER);
+  info.bmiHeader.biWidth       = (LONG)width;
+  info.bmiHeader.biHeight      = -(LONG)height;
+  info.bmiHeader.biPlanes      = 1;
+  info.bmiHeader.biBitCount    = 32;
+  info.bmiHeader.biCompression = BI_RGB;
+
+  void* data = NULL;
+  if (!(surface->drawBitmap = CreateDIBSection(
+          impl->hdc, &info, DIB_RGB_COLORS, &data, NULL, 0)) ||
+      !(surface->drawDc = CreateCompatibleDC(impl->hdc))) {
+    puglWinPixelsFreeBitmap(view);
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
+
+  SelectObject(surface->drawDc, surface->drawBitmap);
+
+  surface->buffer.data   = (uint32_t*)data;
+  surface->buffer.stride = (size_t)width * 4u;
+  surface->buffer.width  = width;
+  surface->buffer.height = height;
+  return PUGL_SUCCESS;
+}
+
+static void
+puglWinPixelsDestroy(PuglView* view)
+{
+  PuglInternals* const        impl    = view->impl;
+  PuglWinPixelsSurface* const surface = (PuglWinPixelsSurface*)impl->surface;
+
+  if (surface) {
+    puglWinPixelsFreeBitmap(view);
+    puglFree(view->world, surface);
+    impl->surface = NULL;
+  }
+}
+
+static PuglStatus
+puglWinPixelsEnter(PuglView* view, const PuglExposeEvent* expose)
+{
+  PuglWinPixelsSurface* const surface =
+    (PuglWinPixelsSurface*)view->impl->surface;
+
+  if (expose) {
+    // Ensure GDI is finished with the bitmap before it's written to again
+    GdiFlush();
+
+    surface->exposed.x      = expose->x;
+    surface->exposed.y      = expose->y;
+    surface->exposed.width  = expose->width;
+    surface->exposed.height = expose->height;
+    surface->drawing        = true;
+    surface->drawn          = false;
+  }
+
+  return puglWinEnter(view, expose);
+}
+
+static PuglStatus
+puglWinPixelsLeave(PuglView* view, const PuglExposeEvent* expose)
+{
+  PuglInternals* const        impl    = view->impl;
+  PuglWinPixelsSurface* const surface = (PuglWinPixelsSurface*)impl->surface;
+  const PuglRect              damage  = surface->buffer.damage;
+
+  if (expose && surface->drawn && damage.width && damage.height) {
+    // Present only the damaged region of the bitmap
+    BitBlt(impl->hdc,
+           damage.x,
+           damage.y,
+           (int)damage.width,
+           (int)damage.height,
+           surface->drawDc,
+           damage.x,
+           damage.y,
+           SRCCOPY);
+  }
+
+  surface->drawing = false;
+  return puglWinLeave(view, expose);
+}
+
+static void*
+puglWinPixelsGetContext(PuglView* view)
+{
+  PuglWinPixelsSurface* const surface =
+    (PuglWinPixelsSurface*)view->impl->surface;
+
+  if (!surface || !surface->drawing) {
+    return NULL;
+  }
+
+  // (Re)create the bitmap now, since the view may have just been configured
+  PuglPixelBuffer* const buffer = &surface->buffer;
+  const PuglSpan         width  = view->frame.width;
+  const PuglSpan         height = view->frame.height;
+  if (!buffer->data || buffer->width != width || buffer->height != height) {
+    if (!width || !height || puglWinPixelsCreateBitmap(view, width, height)) {
+      return NULL;
+    }
+
+    // The previous contents are gone, so everything must be drawn
+    surface->exposed.x      = 0;
+    surface->exposed.y      = 0;
+    surface->exposed.width  = width;
+    surface->exposed.height = height;
+  }
+
+  // Clip the damaged region to the buffer
+  const PuglRect exposed = surface->exposed;
+  const int      x0      = exposed.x > 0 ? exposed.x : 0;
+  const int      y0      = exposed.y > 0 ? exposed.y : 0;
+  const int      ex1     = exposed.x + (int)exposed.width;
+  const int      ey1     = exposed.y + (int)exposed.height;
+  const int      x1      = ex1 < (int)width ? ex1 : (int)width;
+  const int      y1      = ey1 < (int)height ? ey1 : (int)height;
+
+  if (x1 > x0 && y1 > y0) {
+    buffer->damage.x      = (PuglCoord)x0;
+    buffer->damage.y      = (PuglCoord)y0;
+    buffer->damage.width  = (PuglSpan)(x1 - x0);
+    buffer->damage.height = (PuglSpan)(y1 - y0);
+  } else {
+    buffer->damage.width  = 0u;
+    buffer->damage.height = 0u;
+  }
+
+  surface->drawn = true;
+  return buffer;
+}
+
+const PuglBackend*
+puglPixelsBackend(void)
+{
+  static const PuglBackend backend = {puglWinPixelsConfigure,
+                                      puglStubCreate,
+                                      puglWinPixelsDestroy,
+                                      puglWinPixelsEnter,
+                                      puglWinPixelsLeave,
+                                      puglWinPixelsGetContext};
+
+  return &backend;
+}
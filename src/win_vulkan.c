@@ -3,6 +3,7 @@
 
 #define VK_NO_PROTOTYPES 1
 
+#include "allocator.h"
 #include "stub.h"
 #include "types.h"
 #include "win.h"
@@ -12,28 +13,32 @@
 #include <vulkan/vulkan.h>
 #include <vulkan/vulkan_win32.h>
 
-#include <stdlib.h>
+#include <stddef.h>
 
 struct PuglVulkanLoaderImpl {
+  PuglAllocator             allocator; ///< Allocator of the creating world
   HMODULE                   libvulkan;
   PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
   PFN_vkGetDeviceProcAddr   vkGetDeviceProcAddr;
 };
 
 PuglVulkanLoader*
-puglNewVulkanLoader(PuglWorld* PUGL_UNUSED(world))
+puglNewVulkanLoader(PuglWorld* world)
 {
   PuglVulkanLoader* loader =
-    (PuglVulkanLoader*)calloc(1, sizeof(PuglVulkanLoader));
+    (PuglVulkanLoader*)puglCalloc(world, 1, sizeof(PuglVulkanLoader));
   if (!loader) {
     return NULL;
   }
 
   if (!(loader->libvulkan = LoadLibrary("vulkan-1.dll"))) {
-    free(loader);
+    puglFree(world, loader);
     return NULL;
   }
 
+  // The loader may outlive the world, so keep a copy of its allocator
+  loader->allocator = world->allocator;
+
   loader->vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)GetProcAddress(
     loader->libvulkan, "vkGetInstanceProcAddr");
 
@@ -47,8 +52,10 @@ void
 puglFreeVulkanLoader(PuglVulkanLoader* loader)
 {
   if (loader) {
+    const PuglAllocator allocator = loader->allocator;
+
     FreeLibrary(loader->libvulkan);
-    free(loader);
+    allocator.freeFunc(allocator.handle, loader);
   }
 }
 
@@ -5,6 +5,7 @@
 
 #include "x11.h"
 
+#include "allocator.h"
 #include "attributes.h"
 #include "implementation.h"
 #include "types.h"
@@ -31,6 +32,10 @@
 #  include <X11/Xcursor/Xcursor.h>
 #endif
 
+#ifdef HAVE_XFIXES
+#  include <X11/extensions/Xfixes.h>
+#endif
+
 #include <sys/select.h>
 
 #include <limits.h>
@@ -59,14 +64,15 @@
     }
 #endif
 
+/// Seconds an incremental transfer may stall before it's abandoned
+static const double transferTimeout = 10.0;
+
 enum WmClientStateMessageAction {
   WM_STATE_REMOVE,
   WM_STATE_ADD,
   WM_STATE_TOGGLE
 };
 
-#define NUM_CURSORS ((unsigned)PUGL_CURSOR_UP_DOWN + 1u)
-
 static const char* const cursor_names[NUM_CURSORS] = {
   "default",           // ARROW
   "text",              // CARET
@@ -107,6 +113,19 @@ initXSync(PuglWorldInternals* const impl)
   return false;
 }
 
+static void
+initXFixes(PuglWorldInternals* const impl)
+{
+#ifdef HAVE_XFIXES
+  int errorBase = 0;
+
+  impl->xfixesSupported =
+    XFixesQueryExtension(impl->display, &impl->xfixesEventBase, &errorBase);
+#else
+  (void)impl;
+#endif
+}
+
 static double
 puglX11GetDisplayScaleFactor(Display* const display)
 {
@@ -135,11 +154,13 @@ puglX11GetDisplayScaleFactor(Display* const display)
 }
 
 PuglWorldInternals*
-puglInitWorldInternals(const PuglWorldType type, const PuglWorldFlags flags)
+puglInitWorldInternals(PuglWorld* const     world,
+                       const PuglWorldType  type,
+                       const PuglWorldFlags flags)
 {
-  if (type == PUGL_PROGRAM && (flags & PUGL_WORLD_THREADS)) {
-    XInitThreads();
-  }
+  // Xlib is only thread-safe if initialized for threads before any other call
+  const bool threadSafe =
+    type == PUGL_PROGRAM && (flags & PUGL_WORLD_THREADS) && XInitThreads();
 
   Display* display = XOpenDisplay(NULL);
   if (!display) {
@@ -147,10 +168,15 @@ puglInitWorldInternals(const PuglWorldType type, const PuglWorldFlags flags)
   }
 
   PuglWorldInternals* impl =
-    (PuglWorldInternals*)calloc(1, sizeof(PuglWorldInternals));
+    (PuglWorldInternals*)puglCalloc(world, 1, sizeof(PuglWorldInternals));
+  if (!impl) {
+    XCloseDisplay(display);
+    return NULL;
+  }
 
   impl->display     = display;
   impl->scaleFactor = puglX11GetDisplayScaleFactor(display);
+  impl->threadSafe  = threadSafe;
 
   // Intern the various atoms we will need
   impl->atoms.CLIPBOARD        = XInternAtom(display, "CLIPBOARD", 0);
@@ -166,6 +192,7 @@ puglInitWorldInternals(const PuglWorldType type, const PuglWorldFlags flags)
     XInternAtom(display, "_NET_WM_STATE_HIDDEN", 0);
 
   impl->atoms.TARGETS       = XInternAtom(display, "TARGETS", 0);
+  impl->atoms.INCR          = XInternAtom(display, "INCR", 0);
   impl->atoms.text_uri_list = XInternAtom(display, "text/uri-list", 0);
 
   // Open input method
@@ -176,6 +203,7 @@ puglInitWorldInternals(const PuglWorldType type, const PuglWorldFlags flags)
   }
 
   initXSync(impl);
+  initXFixes(impl);
   XFlush(display);
 
   return impl;
@@ -190,7 +218,11 @@ puglGetNativeWorld(PuglWorld* const world)
 PuglInternals*
 puglInitViewInternals(PuglWorld* const world)
 {
-  PuglInternals* impl = (PuglInternals*)calloc(1, sizeof(PuglInternals));
+  PuglInternals* impl =
+    (PuglInternals*)puglCalloc(world, 1, sizeof(PuglInternals));
+  if (!impl) {
+    return NULL;
+  }
 
   impl->clipboard.selection = world->impl->atoms.CLIPBOARD;
   impl->clipboard.property  = XA_PRIMARY;
@@ -307,35 +339,40 @@ updateSizeHints(const PuglView* const view)
 
 #ifdef HAVE_XCURSOR
 static PuglStatus
-defineCursorName(PuglView* const view, const char* const name)
+defineCursor(PuglView* const view, const unsigned index)
 {
-  PuglInternals* const impl    = view->impl;
-  PuglWorld* const     world   = view->world;
-  Display* const       display = world->impl->display;
+  PuglInternals* const      impl    = view->impl;
+  PuglWorldInternals* const w       = view->world->impl;
+  Display* const            display = w->display;
+
+  // Load the cursor into the world cache the first time it is used
+  if (!w->cursors[index]) {
+    // Load cursor theme
+    char* const theme = XcursorGetTheme(display);
+    if (!theme) {
+      return PUGL_FAILURE;
+    }
 
-  // Load cursor theme
-  char* const theme = XcursorGetTheme(display);
-  if (!theme) {
-    return PUGL_FAILURE;
-  }
+    // Get the default size and cursor image from it
+    const int           size  = XcursorGetDefaultSize(display);
+    XcursorImage* const image =
+      XcursorLibraryLoadImage(cursor_names[index], theme, size);
+    if (!image) {
+      return PUGL_BAD_PARAMETER;
+    }
 
-  // Get the default size and cursor image from it
-  const int           size  = XcursorGetDefaultSize(display);
-  XcursorImage* const image = XcursorLibraryLoadImage(name, theme, size);
-  if (!image) {
-    return PUGL_BAD_PARAMETER;
-  }
+    // Load a cursor from the image
+    const Cursor cur = XcursorImageLoadCursor(display, image);
+    XcursorImageDestroy(image);
+    if (!cur) {
+      return PUGL_UNKNOWN_ERROR;
+    }
 
-  // Load a cursor from the image
-  const Cursor cur = XcursorImageLoadCursor(display, image);
-  XcursorImageDestroy(image);
-  if (!cur) {
-    return PUGL_UNKNOWN_ERROR;
+    w->cursors[index] = cur;
   }
 
-  // Set the view's cursor to the new loaded one
-  XDefineCursor(display, impl->win, cur);
-  XFreeCursor(display, cur);
+  // Set the view's cursor to the cached one
+  XDefineCursor(display, impl->win, w->cursors[index]);
   return PUGL_SUCCESS;
 }
 #endif
@@ -420,6 +457,21 @@ puglRealize(PuglView* const view)
                             CWColormap | CWEventMask,
                             &attr);
 
+#ifdef HAVE_XFIXES
+  if (world->impl->xfixesSupported) {
+    // Track the clipboard owner so that clipboard contents can be cached
+    XFixesSelectSelectionInput(display,
+                               impl->win,
+                               atoms->CLIPBOARD,
+                               XFixesSetSelectionOwnerNotifyMask |
+                                 XFixesSelectionWindowDestroyNotifyMask |
+                                 XFixesSelectionClientCloseNotifyMask);
+
+    impl->clipboard.owner = PUGL_X11_ROUND_TRIP(
+      world->impl, XGetSelectionOwner(display, atoms->CLIPBOARD));
+  }
+#endif
+
   // Create the backend drawing context/surface
   if ((st = view->backend->create(view))) {
     return st;
@@ -427,10 +479,12 @@ puglRealize(PuglView* const view)
 
 #ifdef HAVE_XRANDR
   int ignored = 0;
-  if (XRRQueryExtension(display, &ignored, &ignored)) {
+  if (PUGL_X11_ROUND_TRIP(world->impl,
+                          XRRQueryExtension(display, &ignored, &ignored))) {
     // Set refresh rate hint to the real refresh rate
-    XRRScreenConfiguration* conf         = XRRGetScreenInfo(display, parent);
-    short                   current_rate = XRRConfigCurrentRate(conf);
+    XRRScreenConfiguration* conf =
+      PUGL_X11_ROUND_TRIP(world->impl, XRRGetScreenInfo(display, parent));
+    short current_rate = XRRConfigCurrentRate(conf);
 
     view->hints[PUGL_REFRESH_RATE] = current_rate;
     XRRFreeScreenConfigInfo(conf);
@@ -455,14 +509,16 @@ puglRealize(PuglView* const view)
   }
 
   // Create input context
-  impl->xic = XCreateIC(world->impl->xim,
-                        XNInputStyle,
-                        XIMPreeditNothing | XIMStatusNothing,
-                        XNClientWindow,
-                        impl->win,
-                        XNFocusWindow,
-                        impl->win,
-                        (XIM)0);
+  impl->xic =
+    PUGL_X11_ROUND_TRIP(world->impl,
+                        XCreateIC(world->impl->xim,
+                                  XNInputStyle,
+                                  XIMPreeditNothing | XIMStatusNothing,
+                                  XNClientWindow,
+                                  impl->win,
+                                  XNFocusWindow,
+                                  impl->win,
+                                  (XIM)0));
 
   puglDispatchSimpleEvent(view, PUGL_CREATE);
 
@@ -490,28 +546,40 @@ puglHide(PuglView* const view)
 }
 
 static void
-clearX11Clipboard(PuglX11Clipboard* const board)
+clearX11Clipboard(const PuglWorld* const world, PuglX11Clipboard* const board)
 {
   for (unsigned long i = 0; i < board->numFormats; ++i) {
-    free(board->formatStrings[i]);
+    puglFree(world, board->formatStrings[i]);
     board->formatStrings[i] = NULL;
   }
 
   board->source              = None;
+  board->formatsOwner        = None;
   board->numFormats          = 0;
   board->acceptedFormatIndex = UINT32_MAX;
   board->acceptedFormat      = None;
   board->data.len            = 0;
+  board->provider            = NULL;
+  board->numOfferedFormats   = 0u;
 }
 
 void
 puglFreeViewInternals(PuglView* const view)
 {
   if (view && view->impl) {
-    clearX11Clipboard(&view->impl->clipboard);
-    free(view->impl->clipboard.data.data);
-    free(view->impl->clipboard.formats);
-    free(view->impl->clipboard.formatStrings);
+    const PuglWorld* const world = view->world;
+
+    clearX11Clipboard(world, &view->impl->clipboard);
+    for (size_t i = 0u; i < view->impl->clipboard.numTransfers; ++i) {
+      puglFree(world, view->impl->clipboard.transfers[i].data);
+    }
+
+    puglFree(world, view->impl->clipboard.data.data);
+    puglFree(world, view->impl->clipboard.incoming.data);
+    puglFree(world, view->impl->clipboard.transfers);
+    puglFree(world, view->impl->clipboard.formats);
+    puglFree(world, view->impl->clipboard.formatStrings);
+    puglFree(world, view->impl->clipboard.offeredFormats);
     if (view->impl->xic) {
       XDestroyIC(view->impl->xic);
     }
@@ -522,19 +590,37 @@ puglFreeViewInternals(PuglView* const view)
       XDestroyWindow(view->world->impl->display, view->impl->win);
     }
     XFree(view->impl->vi);
-    free(view->impl);
+    puglFree(world, view->impl);
   }
 }
 
 void
 puglFreeWorldInternals(PuglWorld* const world)
 {
+  for (size_t i = 0u; i < world->impl->numBackendData; ++i) {
+    const PuglX11BackendData* const entry = &world->impl->backendData[i];
+    entry->freeFunc(world, entry->data);
+  }
+
+  for (unsigned i = 0u; i < NUM_CURSORS; ++i) {
+    if (world->impl->cursors[i]) {
+      XFreeCursor(world->impl->display, world->impl->cursors[i]);
+    }
+  }
+
   if (world->impl->xim) {
     XCloseIM(world->impl->xim);
   }
   XCloseDisplay(world->impl->display);
-  free(world->impl->timers);
-  free(world->impl);
+
+  for (size_t i = 0u; i < world->impl->numAtomNames; ++i) {
+    puglFree(world, world->impl->atomNames[i].name);
+  }
+
+  puglFree(world, world->impl->backendData);
+  puglFree(world, world->impl->atomNames);
+  puglFree(world, world->impl->timers);
+  puglFree(world, world->impl);
 }
 
 static PuglKey
@@ -644,6 +730,78 @@ translateModifiers(const unsigned xstate)
           ((xstate & Mod4Mask) ? PUGL_MOD_SUPER : 0u));
 }
 
+/// Add an atom and its name to the world's cache and return the cached name
+static const char*
+cacheAtomName(PuglWorld* const world, const Atom atom, const char* const name)
+{
+  PuglWorldInternals* const impl = world->impl;
+
+  const size_t nameLen = strlen(name);
+  char* const  copy    = (char*)puglCalloc(world, nameLen + 1, 1);
+  if (!copy) {
+    return NULL;
+  }
+
+  PuglX11AtomName* const newAtomNames = (PuglX11AtomName*)puglRealloc(
+    world,
+    impl->atomNames,
+    (impl->numAtomNames + 1) * sizeof(PuglX11AtomName));
+  if (!newAtomNames) {
+    puglFree(world, copy);
+    return NULL;
+  }
+
+  memcpy(copy, name, nameLen + 1);
+  impl->atomNames                            = newAtomNames;
+  impl->atomNames[impl->numAtomNames].atom   = atom;
+  impl->atomNames[impl->numAtomNames++].name = copy;
+  return copy;
+}
+
+/// Intern an atom, using the world's cache to avoid a round trip if possible
+static Atom
+internAtom(PuglWorld* const world, const char* const name)
+{
+  PuglWorldInternals* const impl = world->impl;
+
+  for (size_t i = 0u; i < impl->numAtomNames; ++i) {
+    if (!strcmp(impl->atomNames[i].name, name)) {
+      return impl->atomNames[i].atom;
+    }
+  }
+
+  const Atom atom =
+    PUGL_X11_ROUND_TRIP(impl, XInternAtom(impl->display, name, False));
+  if (atom) {
+    cacheAtomName(world, atom, name);
+  }
+
+  return atom;
+}
+
+/// Return the name of an atom, using the world's cache if possible
+static const char*
+getAtomName(PuglWorld* const world, const Atom atom)
+{
+  PuglWorldInternals* const impl = world->impl;
+
+  for (size_t i = 0u; i < impl->numAtomNames; ++i) {
+    if (impl->atomNames[i].atom == atom) {
+      return impl->atomNames[i].name;
+    }
+  }
+
+  char* const name =
+    PUGL_X11_ROUND_TRIP(impl, XGetAtomName(impl->display, atom));
+  if (!name) {
+    return NULL;
+  }
+
+  const char* const cached = cacheAtomName(world, atom, name);
+  XFree(name);
+  return cached;
+}
+
 static PuglStatus
 getAtomProperty(PuglView* const view,
                 const Window    window,
@@ -655,18 +813,22 @@ getAtomProperty(PuglView* const view,
   int           actualFormat = 0;
   unsigned long bytesAfter   = 0;
 
-  return (XGetWindowProperty(view->world->impl->display,
-                             window,
-                             property,
-                             0,
-                             LONG_MAX,
-                             False,
-                             XA_ATOM,
-                             &actualType,
-                             &actualFormat,
-                             numValues,
-                             &bytesAfter,
-                             (unsigned char**)values) == Success)
+  PuglWorldInternals* const impl = view->world->impl;
+
+  return (PUGL_X11_ROUND_TRIP(impl,
+                              XGetWindowProperty(impl->display,
+                                                 window,
+                                                 property,
+                                                 0,
+                                                 LONG_MAX,
+                                                 False,
+                                                 XA_ATOM,
+                                                 &actualType,
+                                                 &actualFormat,
+                                                 numValues,
+                                                 &bytesAfter,
+                                                 (unsigned char**)values)) ==
+          Success)
            ? PUGL_SUCCESS
            : PUGL_FAILURE;
 }
@@ -679,32 +841,46 @@ getX11SelectionClipboard(PuglView* const view, const Atom selection)
            : NULL;
 }
 
-static void
+static PuglStatus
 setClipboardFormats(PuglView* const         view,
                     PuglX11Clipboard* const board,
                     const unsigned long     numFormats,
                     const Atom* const       formats)
 {
-  Atom* const newFormats =
-    (Atom*)realloc(board->formats, numFormats * sizeof(Atom));
-  if (!newFormats) {
-    return;
-  }
+  const PuglWorld* const world = view->world;
 
   for (unsigned long i = 0; i < board->numFormats; ++i) {
-    free(board->formatStrings[i]);
+    puglFree(world, board->formatStrings[i]);
     board->formatStrings[i] = NULL;
   }
 
-  board->formats    = newFormats;
   board->numFormats = 0;
+  if (!numFormats) {
+    return PUGL_SUCCESS;
+  }
+
+  // Grow the arrays, keeping any that were already grown if one fails
+  Atom* const newFormats =
+    (Atom*)puglRealloc(world, board->formats, numFormats * sizeof(Atom));
+  if (!newFormats) {
+    return PUGL_NO_MEMORY;
+  }
+
+  board->formats = newFormats;
+
+  char** const newFormatStrings = (char**)puglRealloc(
+    world, board->formatStrings, numFormats * sizeof(char*));
+  if (!newFormatStrings) {
+    return PUGL_NO_MEMORY;
+  }
 
-  board->formatStrings =
-    (char**)realloc(board->formatStrings, numFormats * sizeof(char*));
+  board->formatStrings = newFormatStrings;
 
   for (unsigned long i = 0; i < numFormats; ++i) {
-    if (formats[i]) {
-      char* const name = XGetAtomName(view->world->impl->display, formats[i]);
+    const char* const name =
+      formats[i] ? getAtomName(view->world, formats[i]) : NULL;
+
+    if (name) {
       const char* type = NULL;
 
       if (strchr(name, '/')) { // MIME type (hopefully)
@@ -715,7 +891,10 @@ setClipboardFormats(PuglView* const         view,
 
       if (type) {
         const size_t typeLen      = strlen(type);
-        char* const  formatString = (char*)calloc(typeLen + 1, 1);
+        char* const  formatString = (char*)puglCalloc(world, typeLen + 1, 1);
+        if (!formatString) {
+          return PUGL_NO_MEMORY;
+        }
 
         memcpy(formatString, type, typeLen + 1);
 
@@ -723,10 +902,10 @@ setClipboardFormats(PuglView* const         view,
         board->formatStrings[board->numFormats] = formatString;
         ++board->numFormats;
       }
-
-      XFree(name);
     }
   }
+
+  return PUGL_SUCCESS;
 }
 
 static PuglEvent
@@ -939,7 +1118,9 @@ puglGrabFocus(PuglView* const view)
   Display* const       display = view->world->impl->display;
   XWindowAttributes    attrs   = {0};
 
-  if (!impl->win || !XGetWindowAttributes(display, impl->win, &attrs)) {
+  if (!impl->win ||
+      !PUGL_X11_ROUND_TRIP(view->world->impl,
+                           XGetWindowAttributes(display, impl->win, &attrs))) {
     return PUGL_UNKNOWN_ERROR;
   }
 
@@ -956,7 +1137,9 @@ puglHasFocus(const PuglView* const view)
 {
   int    revertTo      = 0;
   Window focusedWindow = 0;
-  XGetInputFocus(view->world->impl->display, &focusedWindow, &revertTo);
+  PUGL_X11_ROUND_TRIP(
+    view->world->impl,
+    XGetInputFocus(view->world->impl->display, &focusedWindow, &revertTo));
   return focusedWindow == view->impl->win;
 }
 
@@ -1017,9 +1200,16 @@ puglStartTimer(PuglView* const view, const uintptr_t id, const double timeout)
       }
 
       // Add new timer
-      const size_t size           = ++w->numTimers * sizeof(timer);
-      w->timers                   = (PuglTimer*)realloc(w->timers, size);
-      w->timers[w->numTimers - 1] = timer;
+      const size_t     size   = (w->numTimers + 1u) * sizeof(timer);
+      PuglTimer* const timers =
+        (PuglTimer*)puglRealloc(view->world, w->timers, size);
+      if (!timers) {
+        XSyncDestroyAlarm(display, alarm);
+        return PUGL_NO_MEMORY;
+      }
+
+      w->timers                 = timers;
+      w->timers[w->numTimers++] = timer;
       return PUGL_SUCCESS;
     }
   }
@@ -1152,42 +1342,184 @@ mergeExposeEvents(PuglExposeEvent* const dst, const PuglExposeEvent* const src)
   }
 }
 
+/// Return the largest property size that fits in a single request
+static size_t
+getMaxPropertySize(Display* const display)
+{
+  // Leave room for the ChangeProperty request header
+  return (size_t)XMaxRequestSize(display) * 4u - 24u;
+}
+
+/// Reserve space for `len` bytes and a null terminator in `blob`
 static PuglStatus
-retrieveSelection(const PuglWorld* const world,
-                  PuglView* const        view,
-                  const Atom             property,
-                  const Atom             type,
-                  PuglBlob* const        result)
-{
-  uint8_t*      value          = NULL;
-  Atom          actualType     = 0u;
-  int           actualFormat   = 0;
-  unsigned long actualNumItems = 0u;
-  unsigned long bytesAfter     = 0u;
-
-  if (XGetWindowProperty(world->impl->display,
-                         view->impl->win,
-                         property,
-                         0,
-                         0x1FFFFFFF,
-                         False,
-                         type,
-                         &actualType,
-                         &actualFormat,
-                         &actualNumItems,
-                         &bytesAfter,
-                         &value) != Success) {
-    return PUGL_FAILURE;
+reserveBlob(const PuglWorld* const world,
+            PuglBlob* const        blob,
+            size_t* const          capacity,
+            const size_t           len)
+{
+  if (len + 1u > *capacity) {
+    void* const newData = puglRealloc(world, blob->data, len + 1u);
+    if (!newData) {
+      return PUGL_NO_MEMORY;
+    }
+
+    blob->data = newData;
+    *capacity  = len + 1u;
   }
 
-  if (value && actualFormat == 8 && bytesAfter == 0) {
-    puglSetBlob(result, value, actualNumItems);
+  return PUGL_SUCCESS;
+}
+
+/// Append `len` bytes of `data` to `blob`, growing it geometrically
+static PuglStatus
+appendToBlob(const PuglWorld* const world,
+             PuglBlob* const        blob,
+             size_t* const          capacity,
+             const void* const      data,
+             const size_t           len)
+{
+  const size_t newLen = blob->len + len;
+  PuglStatus   st     = PUGL_SUCCESS;
+
+  if (newLen + 1u > *capacity &&
+      (st = reserveBlob(
+         world, blob, capacity, MAX(newLen, 2u * blob->len)))) {
+    return st;
+  }
+
+  if (len) {
+    memcpy((char*)blob->data + blob->len, data, len);
   }
 
-  XFree(value);
+  blob->len                      = newLen;
+  ((char*)blob->data)[blob->len] = 0;
   return PUGL_SUCCESS;
 }
 
+/// Read and delete a selection property, appending its data to `result`
+static PuglStatus
+readSelectionProperty(PuglWorld* const world,
+                      const Window     window,
+                      const Atom       property,
+                      PuglBlob* const  result,
+                      size_t* const    capacity,
+                      Atom* const      type)
+{
+  // Read in request-sized chunks to avoid huge temporary buffers in Xlib
+  Display* const display     = world->impl->display;
+  const long     chunkLength = XMaxRequestSize(display);
+  long          offset      = 0;
+  unsigned long bytesAfter  = 1u;
+  PuglStatus    st          = PUGL_SUCCESS;
+
+  while (!st && bytesAfter) {
+    uint8_t*      value          = NULL;
+    int           actualFormat   = 0;
+    unsigned long actualNumItems = 0u;
+
+    if (PUGL_X11_ROUND_TRIP(world->impl,
+                            XGetWindowProperty(display,
+                                               window,
+                                               property,
+                                               offset,
+                                               chunkLength,
+                                               True,
+                                               AnyPropertyType,
+                                               type,
+                                               &actualFormat,
+                                               &actualNumItems,
+                                               &bytesAfter,
+                                               &value)) != Success) {
+      return PUGL_FAILURE;
+    }
+
+    if (value && actualFormat == 8) {
+      if (!offset && bytesAfter) {
+        // Reserve space for the whole property up front
+        st = reserveBlob(
+          world, result, capacity, result->len + actualNumItems + bytesAfter);
+      }
+
+      st = st ? st
+              : appendToBlob(world, result, capacity, value, actualNumItems);
+    }
+
+    offset += chunkLength;
+    XFree(value);
+  }
+
+  return st;
+}
+
+/// Return the current owner of a clipboard, from the cache if possible
+static Window
+getSelectionOwner(const PuglView* const view, const PuglX11Clipboard* board)
+{
+  PuglWorldInternals* const impl = view->world->impl;
+  if (impl->xfixesSupported) {
+    return board->owner;
+  }
+
+  return PUGL_X11_ROUND_TRIP(
+    impl, XGetSelectionOwner(impl->display, board->selection));
+}
+
+/// Return true if the cached types of a clipboard are still valid
+static bool
+hasCachedFormats(const PuglView* const view, const PuglX11Clipboard* board)
+{
+  return view->world->impl->xfixesSupported && board->formatsOwner &&
+         board->formatsOwner == board->owner;
+}
+
+/// Move received data into the clipboard and return the resulting event
+static PuglEvent
+finishReceiving(PuglView* const         view,
+                PuglX11Clipboard* const board,
+                const Time              time)
+{
+  PuglEvent event = {{PUGL_DATA, 0}};
+
+  puglFree(view->world, board->data.data);
+  board->data             = board->incoming;
+  board->incoming.data    = NULL;
+  board->incoming.len     = 0u;
+  board->incomingCapacity = 0u;
+  board->receiving        = false;
+  board->source           = getSelectionOwner(view, board);
+
+  if (board->prefetchTarget) {
+    // Data was fetched in advance, so only cache it
+    board->prefetchTarget = None;
+    event.type            = PUGL_NOTHING;
+  }
+
+  event.data.time      = (double)time / 1e3;
+  event.data.typeIndex = board->acceptedFormatIndex;
+  return event;
+}
+
+/// Start fetching text from a clipboard in advance, if it is available
+static void
+prefetchText(PuglView* const view, PuglX11Clipboard* const board)
+{
+  for (uint32_t i = 0u; i < board->numFormats; ++i) {
+    if (!strcmp(board->formatStrings[i], "text/plain")) {
+      board->acceptedFormatIndex = i;
+      board->acceptedFormat      = board->formats[i];
+      board->prefetchTarget      = board->formats[i];
+
+      XConvertSelection(view->world->impl->display,
+                        board->selection,
+                        board->acceptedFormat,
+                        board->property,
+                        view->impl->win,
+                        CurrentTime);
+      break;
+    }
+  }
+}
+
 static void
 handleSelectionNotify(const PuglWorld* const       world,
                       PuglView* const              view,
@@ -1200,44 +1532,290 @@ handleSelectionNotify(const PuglWorld* const       world,
   PuglX11Clipboard* const board     = getX11SelectionClipboard(view, selection);
   PuglEvent               puglEvent = {{PUGL_NOTHING, 0}};
 
-  if (event->target == atoms->TARGETS) {
+  if (!board) {
+    return; // Not a selection used as a clipboard, which anyone could send
+  }
+
+  if (event->property == None && event->target == board->prefetchTarget) {
+    // The owner refused a conversion that was requested in advance
+    board->prefetchTarget = None;
+
+  } else if (event->target == atoms->TARGETS) {
     // Notification of available datatypes
     unsigned long numFormats = 0;
     Atom*         formats    = NULL;
     if (!getAtomProperty(
           view, event->requestor, event->property, &numFormats, &formats)) {
       setClipboardFormats(view, board, numFormats, formats);
+      board->formatsOwner = board->owner;
 
-      const PuglDataOfferEvent offer = {
-        PUGL_DATA_OFFER, 0, (double)event->time / 1e3};
+      if (board->prefetchTarget == atoms->TARGETS) {
+        // Types were fetched in advance, continue by fetching any text
+        board->prefetchTarget = None;
+        prefetchText(view, board);
+      } else {
+        const PuglDataOfferEvent offer = {
+          PUGL_DATA_OFFER, 0, (double)event->time / 1e3};
 
-      puglEvent.offer            = offer;
-      board->acceptedFormatIndex = UINT32_MAX;
-      board->acceptedFormat      = None;
+        puglEvent.offer            = offer;
+        board->acceptedFormatIndex = UINT32_MAX;
+        board->acceptedFormat      = None;
+      }
 
       XFree(formats);
     }
 
+  } else if (event->selection == atoms->CLIPBOARD &&
+             event->property == XA_PRIMARY && event->target != None &&
+             event->target != board->acceptedFormat) {
+    // Stale data in a type that is no longer wanted, discard it
+    XDeleteProperty(display, view->impl->win, event->property);
+
   } else if (event->selection == atoms->CLIPBOARD &&
              event->property == XA_PRIMARY &&
              board->acceptedFormatIndex < board->numFormats) {
     // Notification of data from the clipboard
-    if (!retrieveSelection(
-          world, view, event->property, event->target, &board->data)) {
-      board->source = XGetSelectionOwner(display, board->selection);
+    Atom type = None;
+
+    board->incoming.len = 0u;
+    if (!readSelectionProperty(view->world,
+                               view->impl->win,
+                               event->property,
+                               &board->incoming,
+                               &board->incomingCapacity,
+                               &type)) {
+      if (type == atoms->INCR && board->prefetchTarget) {
+        // Only small data is fetched in advance, so leave this for a paste
+        board->incoming.len        = 0u;
+        board->acceptedFormatIndex = UINT32_MAX;
+        board->acceptedFormat      = None;
+        board->prefetchTarget      = None;
+      } else if (type == atoms->INCR) {
+        // Data is too large for one property, wait for it in chunks
+        board->receiving = true;
+      } else {
+        puglEvent = finishReceiving(view, board, event->time);
+      }
+    }
+  }
 
-      const PuglDataEvent data = {
-        PUGL_DATA, 0u, (double)event->time / 1e3, board->acceptedFormatIndex};
+  puglDispatchEvent(view, &puglEvent);
+}
 
-      puglEvent.data = data;
+static void
+handlePropertyNotify(PuglView* const view, const XPropertyEvent* const event)
+{
+  PuglX11Clipboard* const board = &view->impl->clipboard;
+
+  if (board->receiving && event->state == PropertyNewValue &&
+      event->atom == board->property) {
+    // Notification of the next chunk of an incremental transfer
+    const size_t oldLen = board->incoming.len;
+    Atom         type   = None;
+
+    if (readSelectionProperty(view->world,
+                              view->impl->win,
+                              event->atom,
+                              &board->incoming,
+                              &board->incomingCapacity,
+                              &type)) {
+      board->receiving = false;
+    } else if (board->incoming.len == oldLen) {
+      // An empty chunk terminates the transfer
+      const PuglEvent puglEvent = finishReceiving(view, board, event->time);
+      puglDispatchEvent(view, &puglEvent);
     }
   }
+}
 
-  puglDispatchEvent(view, &puglEvent);
+/**
+   Remove an incremental transfer that has finished or been abandoned.
+
+   If `destroyed` is true, the requestor window no longer exists, so no
+   requests are made to stop watching it.
+*/
+static void
+removeTransfer(PuglWorld* const        world,
+               PuglX11Clipboard* const board,
+               const size_t            index,
+               const bool              destroyed)
+{
+  const Window requestor = board->transfers[index].requestor;
+
+  puglFree(world, board->transfers[index].data);
+  if (index < board->numTransfers - 1) {
+    memmove(board->transfers + index,
+            board->transfers + index + 1,
+            sizeof(PuglX11Transfer) * (board->numTransfers - index - 1));
+  }
+
+  --board->numTransfers;
+
+  // Stop watching foreign windows that no longer have transfers in progress
+  if (!destroyed && !findView(world, requestor)) {
+    for (size_t i = 0; i < board->numTransfers; ++i) {
+      if (board->transfers[i].requestor == requestor) {
+        return;
+      }
+    }
+
+    XSelectInput(world->impl->display, requestor, NoEventMask);
+  }
+}
+
+/**
+   Abort any incremental transfers of the previous contents.
+
+   The property is deleted rather than terminated with an empty chunk, so a
+   requestor never mistakes a partial transfer for the complete contents.
+*/
+static void
+cancelTransfers(PuglWorld* const world, PuglX11Clipboard* const board)
+{
+  while (board->numTransfers) {
+    const PuglX11Transfer* const transfer =
+      &board->transfers[board->numTransfers - 1];
+
+    XDeleteProperty(
+      world->impl->display, transfer->requestor, transfer->property);
+
+    removeTransfer(world, board, board->numTransfers - 1, false);
+  }
+}
+
+/// Write the next chunk of an incremental transfer to the requestor
+static void
+continueTransfer(PuglWorld* const        world,
+                 PuglX11Clipboard* const board,
+                 const size_t            index)
+{
+  Display* const         display  = world->impl->display;
+  PuglX11Transfer* const transfer = &board->transfers[index];
+  const size_t           offset   = MIN(transfer->offset, transfer->len);
+  const size_t           len =
+    MIN(transfer->len - offset, getMaxPropertySize(display));
+
+  XChangeProperty(display,
+                  transfer->requestor,
+                  transfer->property,
+                  transfer->target,
+                  8,
+                  PropModeReplace,
+                  len ? transfer->data + offset : NULL,
+                  (int)len);
+
+  if (len) {
+    transfer->offset       = offset + len;
+    transfer->lastActivity = puglGetTime(world);
+    return;
+  }
+
+  // An empty chunk was written to terminate the transfer, remove it
+  removeTransfer(world, board, index, false);
+}
+
+/// Start an incremental transfer for data too large for one property
+static PuglStatus
+beginTransfer(PuglWorld* const                    world,
+              PuglX11Clipboard* const             board,
+              const XSelectionRequestEvent* const request,
+              const uint8_t* const                data,
+              const size_t                        len)
+{
+  Display* const display = world->impl->display;
+
+  // Copy the data, which may be replaced or freed before the transfer is done
+  uint8_t* const copy = (uint8_t*)puglRealloc(world, NULL, len);
+  if (!copy) {
+    return PUGL_NO_MEMORY;
+  }
+
+  memcpy(copy, data, len);
+
+  PuglX11Transfer* const newTransfers = (PuglX11Transfer*)puglRealloc(
+    world,
+    board->transfers,
+    (board->numTransfers + 1) * sizeof(PuglX11Transfer));
+  if (!newTransfers) {
+    puglFree(world, copy);
+    return PUGL_NO_MEMORY;
+  }
+
+  const PuglX11Transfer transfer = {request->requestor,
+                                    request->property,
+                                    request->target,
+                                    copy,
+                                    len,
+                                    0u,
+                                    puglGetTime(world)};
+
+  board->transfers                        = newTransfers;
+  board->transfers[board->numTransfers++] = transfer;
+
+  // Watch for the requestor deleting the property or going away (views do)
+  if (!findView(world, request->requestor)) {
+    XSelectInput(
+      display, request->requestor, PropertyChangeMask | StructureNotifyMask);
+  }
+
+  // Set the property to INCR with a lower bound on the size of the data
+  const long size = (long)len;
+  XChangeProperty(display,
+                  request->requestor,
+                  request->property,
+                  world->impl->atoms.INCR,
+                  32,
+                  PropModeReplace,
+                  (const uint8_t*)&size,
+                  1);
+
+  return PUGL_SUCCESS;
+}
+
+static void
+handlePropertyDelete(PuglWorld* const world, const XPropertyEvent* const event)
+{
+  // Find the transfer the requestor is waiting on and send the next chunk
+  for (size_t i = 0; i < world->numViews; ++i) {
+    PuglX11Clipboard* const board = &world->views[i]->impl->clipboard;
+
+    for (size_t t = 0; t < board->numTransfers; ++t) {
+      if (board->transfers[t].requestor == event->window &&
+          board->transfers[t].property == event->atom) {
+        continueTransfer(world, board, t);
+        return;
+      }
+    }
+  }
+}
+
+/// Drop incremental transfers to a destroyed window, or that have stalled
+static void
+dropTransfers(PuglWorld* const world, const Window destroyed)
+{
+  const double now = puglGetTime(world);
+
+  for (size_t i = 0; i < world->numViews; ++i) {
+    PuglX11Clipboard* const board = &world->views[i]->impl->clipboard;
+
+    for (size_t t = 0; t < board->numTransfers;) {
+      const PuglX11Transfer* const transfer = &board->transfers[t];
+
+      if (transfer->requestor == destroyed) {
+        removeTransfer(world, board, t, true);
+      } else if (now - transfer->lastActivity > transferTimeout) {
+        XDeleteProperty(
+          world->impl->display, transfer->requestor, transfer->property);
+        removeTransfer(world, board, t, false);
+      } else {
+        ++t;
+      }
+    }
+  }
 }
 
 static PuglStatus
-handleSelectionRequest(const PuglWorld* const              world,
+handleSelectionRequest(PuglWorld* const                    world,
                        PuglView* const                     view,
                        const XSelectionRequestEvent* const request)
 {
@@ -1251,24 +1829,53 @@ handleSelectionRequest(const PuglWorld* const              world,
     return PUGL_UNKNOWN_ERROR;
   }
 
+  Atom property = request->property;
   if (request->target == atoms->TARGETS) {
+    const Atom* const formats =
+      board->provider ? board->offeredFormats : board->formats;
+    const unsigned long numFormats =
+      board->provider ? board->numOfferedFormats : board->numFormats;
+
     XChangeProperty(world->impl->display,
                     request->requestor,
                     request->property,
                     XA_ATOM,
                     32,
                     PropModeReplace,
-                    (const uint8_t*)board->formats,
-                    (int)board->numFormats);
+                    (const uint8_t*)formats,
+                    (int)numFormats);
   } else {
-    XChangeProperty(world->impl->display,
-                    request->requestor,
-                    request->property,
-                    request->target,
-                    8,
-                    PropModeReplace,
-                    (const uint8_t*)board->data.data,
-                    (int)board->data.len);
+    const uint8_t* data = (const uint8_t*)board->data.data;
+    size_t         len  = board->data.len;
+
+    if (board->provider) {
+      // Get the data in the requested type from the application
+      data = NULL;
+      len  = 0u;
+      for (uint32_t i = 0u; i < board->numOfferedFormats; ++i) {
+        if (board->offeredFormats[i] == request->target) {
+          data = (const uint8_t*)board->provider(view, i, &len);
+          break;
+        }
+      }
+    }
+
+    if (!data) {
+      property = None; // Refuse the request
+    } else if (len > getMaxPropertySize(display)) {
+      if (beginTransfer(world, board, request, data, len)) {
+        property = None; // Refuse the request
+      }
+    } else {
+      XChangeProperty(world->impl->display,
+                      request->requestor,
+                      request->property,
+                      request->target,
+                      8,
+                      PropModeReplace,
+                      data,
+                      (int)len);
+    }
   }
 
   XSelectionEvent note = {SelectionNotify,
@@ -1278,7 +1885,7 @@ handleSelectionRequest(const PuglWorld* const              world,
                           request->requestor,
                           request->selection,
                           request->target,
-                          request->property,
+                          property,
                           request->time};
 
   return XSendEvent(
@@ -1292,9 +1899,10 @@ PUGL_WARN_UNUSED_RESULT
 static PuglStatus
 flushExposures(PuglWorld* const world)
 {
-  PuglStatus st0 = PUGL_SUCCESS;
-  PuglStatus st1 = PUGL_SUCCESS;
-  PuglStatus st2 = PUGL_SUCCESS;
+  PuglStatus st = PUGL_SUCCESS;
+
+  // Count frames so that backends can coordinate views drawn together
+  ++world->impl->numFrames;
 
   for (size_t i = 0; i < world->numViews; ++i) {
     PuglView* const view = world->views[i];
@@ -1311,24 +1919,17 @@ flushExposures(PuglWorld* const world)
     view->impl->pendingConfigure.type = PUGL_NOTHING;
     view->impl->pendingExpose.type    = PUGL_NOTHING;
 
-    if (expose.type) {
-      if (!(st0 = view->backend->enter(view, &expose.expose))) {
-        if (configure.type) {
-          st0 = puglConfigure(view, &configure);
-        }
+    // Draw the view, or hand the events to the backend to draw later
+    if (configure.type || expose.type) {
+      const PuglStatus drawStatus =
+        view->impl->drawFunc ? view->impl->drawFunc(view, &configure, &expose)
+                             : puglX11DrawView(view, &configure, &expose);
 
-        st1 = puglExpose(view, &expose);
-        st2 = view->backend->leave(view, &expose.expose);
-      }
-    } else if (configure.type) {
-      if (!(st0 = view->backend->enter(view, NULL))) {
-        st0 = puglConfigure(view, &configure);
-        st1 = view->backend->leave(view, NULL);
-      }
+      st = st ? st : drawStatus;
     }
   }
 
-  return st0 ? st0 : st1 ? st1 : st2;
+  return st;
 }
 
 static bool
@@ -1357,6 +1958,66 @@ handleTimerEvent(PuglWorld* const world, const XEvent xevent)
   return false;
 }
 
+static bool
+handleSelectionOwnerEvent(PuglWorld* const world, const XEvent xevent)
+{
+#ifdef HAVE_XFIXES
+  if (world->impl->xfixesSupported &&
+      xevent.type == world->impl->xfixesEventBase + XFixesSelectionNotify) {
+    const XFixesSelectionNotifyEvent* const notify =
+      ((const XFixesSelectionNotifyEvent*)&xevent);
+
+    PuglView* const         view = findView(world, notify->window);
+    PuglX11Clipboard* const board =
+      view ? getX11SelectionClipboard(view, notify->selection) : NULL;
+    if (!board) {
+      return true;
+    }
+
+    // Update the cached owner
+    board->owner = (notify->subtype == XFixesSetSelectionOwnerNotify)
+                     ? notify->owner
+                     : None;
+
+    if (board->owner != view->impl->win) {
+      /* The selection was set again, possibly by the same owner with new
+         contents, so forget the cached types and data.  Setting it from this
+         view already updated the clipboard, so that case is skipped. */
+      board->source              = None;
+      board->formatsOwner        = None;
+      board->acceptedFormatIndex = UINT32_MAX;
+      board->acceptedFormat      = None;
+    }
+
+    if (board->receiving) {
+      // Abandon any incremental transfer, which the old owner won't finish
+      XDeleteProperty(world->impl->display, view->impl->win, board->property);
+      board->incoming.len = 0u;
+      board->receiving    = false;
+    }
+
+    if (board->owner && board->owner != view->impl->win &&
+        view->hints[PUGL_PREFETCH_CLIPBOARD] == PUGL_TRUE) {
+      // Fetch the available types in advance, then any text
+      board->prefetchTarget = world->impl->atoms.TARGETS;
+      XConvertSelection(world->impl->display,
+                        board->selection,
+                        board->prefetchTarget,
+                        board->property,
+                        view->impl->win,
+                        CurrentTime);
+    }
+
+    return true;
+  }
+#else
+  (void)world;
+  (void)xevent;
+#endif
+
+  return false;
+}
+
 static PuglStatus
 dispatchX11Events(PuglWorld* const world)
 {
@@ -1372,10 +2033,20 @@ dispatchX11Events(PuglWorld* const world)
     XEvent xevent;
     XNextEvent(display, &xevent);
 
-    if (handleTimerEvent(world, xevent)) {
+    if (handleTimerEvent(world, xevent) ||
+        handleSelectionOwnerEvent(world, xevent)) {
       continue;
     }
 
+    if (xevent.type == PropertyNotify &&
+        xevent.xproperty.state == PropertyDelete) {
+      // Continue any incremental transfer to this (possibly foreign) window
+      handlePropertyDelete(world, &xevent.xproperty);
+    } else if (xevent.type == DestroyNotify) {
+      // Drop any incremental transfers to this (possibly foreign) window
+      dropTransfers(world, xevent.xdestroywindow.window);
+    }
+
     PuglView* view = findView(world, xevent.xany.window);
     if (!view) {
       continue;
@@ -1398,12 +2069,14 @@ dispatchX11Events(PuglWorld* const world)
       PuglX11Clipboard* const board =
         getX11SelectionClipboard(view, xevent.xselectionclear.selection);
       if (board) {
-        clearX11Clipboard(board);
+        clearX11Clipboard(world, board);
       }
     } else if (xevent.type == SelectionNotify) {
       handleSelectionNotify(world, view, &xevent.xselection);
     } else if (xevent.type == SelectionRequest) {
       handleSelectionRequest(world, view, &xevent.xselectionrequest);
+    } else if (xevent.type == PropertyNotify) {
+      handlePropertyNotify(view, &xevent.xproperty);
     }
 
     // Translate X11 event to Pugl event
@@ -1416,16 +2089,17 @@ dispatchX11Events(PuglWorld* const world)
       // Update configure event to be dispatched after loop
       view->impl->pendingConfigure = event;
     } else if (event.type == PUGL_MAP) {
-      // Get initial window position and size
-      XWindowAttributes attrs;
-      XGetWindowAttributes(view->world->impl->display, view->impl->win, &attrs);
-
-      // Build an initial configure event in case the WM doesn't send one
-      PuglEvent configureEvent        = {{PUGL_CONFIGURE, 0}};
-      configureEvent.configure.x      = (PuglCoord)attrs.x;
-      configureEvent.configure.y      = (PuglCoord)attrs.y;
-      configureEvent.configure.width  = (PuglSpan)attrs.width;
-      configureEvent.configure.height = (PuglSpan)attrs.height;
+      // Build an initial configure event in case the WM doesn't send one,
+      // from the latest known geometry to avoid a round trip to the server
+      PuglEvent configureEvent = view->impl->pendingConfigure;
+      if (configureEvent.type != PUGL_CONFIGURE) {
+        configureEvent.configure.type   = PUGL_CONFIGURE;
+        configureEvent.configure.flags  = 0;
+        configureEvent.configure.x      = view->frame.x;
+        configureEvent.configure.y      = view->frame.y;
+        configureEvent.configure.width  = view->frame.width;
+        configureEvent.configure.height = view->frame.height;
+      }
 
       // Dispatch an initial configure (if necessary), then the map event
       st0 = puglDispatchEvent(view, &configureEvent);
@@ -1455,8 +2129,12 @@ puglUpdate(PuglWorld* const world, const double timeout)
   PuglStatus   st1       = PUGL_SUCCESS;
 
   world->impl->dispatchingEvents = true;
+  world->impl->numRoundTrips     = 0u;
 
-  if (timeout < 0.0) {
+  if (world->numIdleTasks) {
+    // Don't wait for events, so the idle time can be used to run tasks
+    st0 = dispatchX11Events(world);
+  } else if (timeout < 0.0) {
     st0 = pollX11Socket(world, timeout);
     st0 = st0 ? st0 : dispatchX11Events(world);
   } else if (timeout <= 0.001) {
@@ -1475,11 +2153,160 @@ puglUpdate(PuglWorld* const world, const double timeout)
 
   st1 = flushExposures(world);
 
+  // Drop any incremental transfers that requestors have stopped reading
+  dropTransfers(world, None);
+
   world->impl->dispatchingEvents = false;
 
+  // Run idle tasks in the time left, after drawing so they don't delay frames
+  if (world->numIdleTasks) {
+    puglRunIdleTasks(world, timeout > 0.0 ? startTime + timeout : -1.0);
+  }
+
   return st0 ? st0 : st1;
 }
 
+/// Return true if any view has a configure or expose waiting to be flushed
+static bool
+hasPendingExposures(const PuglWorld* const world)
+{
+  for (size_t i = 0; i < world->numViews; ++i) {
+    const PuglInternals* const impl = world->views[i]->impl;
+    if (impl->pendingConfigure.type || impl->pendingExpose.type) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+PuglStatus
+puglPrepareUpdate(PuglWorld* const world, double* const timeout)
+{
+  Display* const display = world->impl->display;
+
+  // Flush requests, since the loop may sleep until the server responds
+  XFlush(display);
+
+  // Timers are server alarms, so they arrive on the connection like events
+  *timeout = (world->numIdleTasks ||
+              XEventsQueued(display, QueuedAlready) > 0 ||
+              hasPendingExposures(world))
+               ? 0.0
+               : -1.0;
+
+  return PUGL_SUCCESS;
+}
+
+size_t
+puglGetUpdateFds(const PuglWorld* const world,
+                 int* const             fds,
+                 const size_t           maxFds)
+{
+  if (maxFds) {
+    fds[0] = ConnectionNumber(world->impl->display);
+  }
+
+  return 1u;
+}
+
+bool
+puglCheckUpdate(PuglWorld* const world)
+{
+  return XEventsQueued(world->impl->display, QueuedAfterReading) > 0 ||
+         hasPendingExposures(world) || world->numIdleTasks;
+}
+
+PuglStatus
+puglDispatchUpdate(PuglWorld* const world)
+{
+  return puglUpdate(world, 0.0);
+}
+
+PuglStatus
+puglX11DrawView(PuglView* const        view,
+                const PuglEvent* const configure,
+                const PuglEvent* const expose)
+{
+  PuglStatus st0 = PUGL_SUCCESS;
+  PuglStatus st1 = PUGL_SUCCESS;
+  PuglStatus st2 = PUGL_SUCCESS;
+
+  if (expose->type) {
+    if (!(st0 = view->backend->enter(view, &expose->expose))) {
+      if (configure->type) {
+        st0 = puglConfigure(view, configure);
+      }
+
+      st1 = puglExpose(view, expose);
+      st2 = view->backend->leave(view, &expose->expose);
+    }
+  } else if (configure->type) {
+    if (!(st0 = view->backend->enter(view, NULL))) {
+      st0 = puglConfigure(view, configure);
+      st1 = view->backend->leave(view, NULL);
+    }
+  }
+
+  return st0 ? st0 : st1 ? st1 : st2;
+}
+
+void*
+puglX11GetBackendData(const PuglWorld* const   world,
+                      const PuglBackend* const backend)
+{
+  for (size_t i = 0u; i < world->impl->numBackendData; ++i) {
+    if (world->impl->backendData[i].backend == backend) {
+      return world->impl->backendData[i].data;
+    }
+  }
+
+  return NULL;
+}
+
+PuglStatus
+puglX11SetBackendData(PuglWorld* const         world,
+                      const PuglBackend* const backend,
+                      void* const              data,
+                      const PuglX11FreeFunc    freeFunc)
+{
+  PuglWorldInternals* const impl = world->impl;
+
+  // Replace any existing data for this backend
+  for (size_t i = 0u; i < impl->numBackendData; ++i) {
+    PuglX11BackendData* const entry = &impl->backendData[i];
+    if (entry->backend == backend) {
+      entry->freeFunc(world, entry->data);
+      entry->data     = data;
+      entry->freeFunc = freeFunc;
+      return PUGL_SUCCESS;
+    }
+  }
+
+  const size_t              newNumBackendData = impl->numBackendData + 1u;
+  PuglX11BackendData* const newBackendData =
+    (PuglX11BackendData*)puglRealloc(world,
+                                     impl->backendData,
+                                     newNumBackendData *
+                                       sizeof(PuglX11BackendData));
+  if (!newBackendData) {
+    return PUGL_NO_MEMORY;
+  }
+
+  const PuglX11BackendData entry = {backend, data, freeFunc};
+
+  impl->backendData                       = newBackendData;
+  impl->backendData[impl->numBackendData] = entry;
+  impl->numBackendData                    = newNumBackendData;
+  return PUGL_SUCCESS;
+}
+
+size_t
+puglX11GetNumRoundTrips(const PuglWorld* const world)
+{
+  return world->impl->numRoundTrips;
+}
+
 double
 puglGetTime(const PuglWorld* const world)
 {
@@ -1528,7 +2355,7 @@ puglSetWindowTitle(PuglView* const view, const char* const title)
   Display*                  display = view->world->impl->display;
   const PuglX11Atoms* const atoms   = &view->world->impl->atoms;
 
-  puglSetString(&view->title, title);
+  puglSetString(view->world, &view->title, title);
 
   if (view->impl->win) {
     XStoreName(display, view->impl->win, title);
@@ -1643,14 +2470,27 @@ puglGetClipboard(PuglView* const view,
                  const uint32_t  typeIndex,
                  size_t* const   len)
 {
-  Display* const          display = view->world->impl->display;
-  PuglX11Clipboard* const board   = &view->impl->clipboard;
+  PuglX11Clipboard* const board = &view->impl->clipboard;
+
+  if (board->provider && board->source == view->impl->win) {
+    // This view owns the clipboard, so get the data directly from it
+    const Atom format =
+      typeIndex < board->numFormats ? board->formats[typeIndex] : None;
+
+    for (uint32_t i = 0u; format && i < board->numOfferedFormats; ++i) {
+      if (board->offeredFormats[i] == format) {
+        return board->provider(view, i, len);
+      }
+    }
+
+    return NULL;
+  }
 
   if (typeIndex != board->acceptedFormatIndex) {
     return NULL;
   }
 
-  const Window owner = XGetSelectionOwner(display, board->selection);
+  const Window owner = getSelectionOwner(view, board);
   if (!owner || owner != board->source) {
     *len = 0;
     return NULL;
@@ -1671,8 +2511,30 @@ puglAcceptOffer(PuglView* const                 view,
   Display* const          display = view->world->impl->display;
   PuglX11Clipboard* const board   = &view->impl->clipboard;
 
+  if (typeIndex >= board->numFormats) {
+    return PUGL_BAD_PARAMETER;
+  }
+
+  const Atom format = board->formats[typeIndex];
+  if (hasCachedFormats(view, board) && board->source == board->owner &&
+      board->acceptedFormat == format && !board->receiving &&
+      board->prefetchTarget != format) {
+    // The data in this type is already cached, so deliver it immediately
+    PuglEvent event      = {{PUGL_DATA, 0}};
+    event.data.time      = puglGetTime(view->world);
+    event.data.typeIndex = typeIndex;
+
+    board->acceptedFormatIndex = typeIndex;
+    return puglDispatchEvent(view, &event);
+  }
+
   board->acceptedFormatIndex = typeIndex;
-  board->acceptedFormat      = board->formats[typeIndex];
+  board->acceptedFormat      = format;
+  if (board->prefetchTarget == format) {
+    // The data is already being fetched, so deliver it when it arrives
+    board->prefetchTarget = None;
+    return PUGL_SUCCESS;
+  }
 
   // Request the data in the specified type from the general clipboard
   XConvertSelection(display,
@@ -1690,7 +2552,23 @@ puglPaste(PuglView* const view)
 {
   Display* const          display = view->world->impl->display;
   const PuglX11Atoms*     atoms   = &view->world->impl->atoms;
-  const PuglX11Clipboard* board   = &view->impl->clipboard;
+  PuglX11Clipboard* const board   = &view->impl->clipboard;
+
+  if (hasCachedFormats(view, board)) {
+    // The owner hasn't changed, so offer the cached types immediately
+    const PuglDataOfferEvent offer = {
+      PUGL_DATA_OFFER, 0, puglGetTime(view->world)};
+
+    PuglEvent offerEvent;
+    offerEvent.offer = offer;
+    return puglDispatchEvent(view, &offerEvent);
+  }
+
+  if (board->prefetchTarget == atoms->TARGETS) {
+    // The types are already being fetched, so offer them when they arrive
+    board->prefetchTarget = None;
+    return PUGL_SUCCESS;
+  }
 
   // Request a SelectionNotify for TARGETS (available datatypes)
   XConvertSelection(display,
@@ -1726,20 +2604,79 @@ puglSetClipboard(PuglView* const   view,
   PuglInternals* const    impl    = view->impl;
   Display* const          display = view->world->impl->display;
   PuglX11Clipboard* const board   = &view->impl->clipboard;
-  const PuglStatus        st      = puglSetBlob(&board->data, data, len);
 
+  cancelTransfers(view->world, board);
+
+  PuglStatus st = puglSetBlob(view->world, &board->data, data, len);
   if (!st) {
-    const Atom format = {XInternAtom(display, type, 0)};
+    const Atom format = {internAtom(view->world, type ? type : "text/plain")};
+    if ((st = setClipboardFormats(view, board, 1, &format))) {
+      return st;
+    }
 
-    setClipboardFormats(view, board, 1, &format);
     XSetSelectionOwner(display, board->selection, impl->win, CurrentTime);
 
-    board->source = impl->win;
+    board->source              = impl->win;
+    board->owner               = impl->win;
+    board->formatsOwner        = impl->win;
+    board->acceptedFormatIndex = 0u;
+    board->acceptedFormat      = format;
+    board->prefetchTarget      = None;
+    board->provider            = NULL;
   }
 
   return st;
 }
 
+PuglStatus
+puglOfferClipboard(PuglView* const          view,
+                   const char* const* const types,
+                   const uint32_t           numTypes,
+                   const PuglClipboardFunc  provider)
+{
+  PuglInternals* const    impl    = view->impl;
+  Display* const          display = view->world->impl->display;
+  PuglX11Clipboard* const board   = &view->impl->clipboard;
+
+  if (!numTypes || !provider) {
+    return PUGL_BAD_PARAMETER;
+  }
+
+  Atom* const newFormats = (Atom*)puglRealloc(
+    view->world, board->offeredFormats, numTypes * sizeof(Atom));
+  if (!newFormats) {
+    return PUGL_NO_MEMORY;
+  }
+
+  cancelTransfers(view->world, board);
+
+  board->offeredFormats    = newFormats;
+  board->numOfferedFormats = numTypes;
+  for (uint32_t i = 0u; i < numTypes; ++i) {
+    if (!(board->offeredFormats[i] = internAtom(view->world, types[i]))) {
+      board->numOfferedFormats = 0u;
+      return PUGL_UNKNOWN_ERROR;
+    }
+  }
+
+  const PuglStatus st =
+    setClipboardFormats(view, board, numTypes, board->offeredFormats);
+  if (st) {
+    return st;
+  }
+
+  XSetSelectionOwner(display, board->selection, impl->win, CurrentTime);
+
+  board->source         = impl->win;
+  board->owner          = impl->win;
+  board->formatsOwner   = impl->win;
+  board->acceptedFormat = None;
+  board->prefetchTarget = None;
+  board->provider       = provider;
+  board->data.len       = 0u;
+  return PUGL_SUCCESS;
+}
+
 PuglStatus
 puglSetCursor(PuglView* const view, const PuglCursor cursor)
 {
@@ -1758,7 +2695,7 @@ puglSetCursor(PuglView* const view, const PuglCursor cursor)
 
   impl->cursorName = cursor_names[index];
 
-  return defineCursorName(view, impl->cursorName);
+  return defineCursor(view, index);
 #else
   (void)view;
   (void)cursor;
@@ -17,6 +17,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#define NUM_CURSORS ((unsigned)PUGL_CURSOR_UP_DOWN + 1u)
+
 typedef struct {
   Atom CLIPBOARD;
   Atom UTF8_STRING;
@@ -28,6 +30,7 @@ typedef struct {
   Atom NET_WM_STATE_DEMANDS_ATTENTION;
   Atom NET_WM_STATE_HIDDEN;
   Atom TARGETS;
+  Atom INCR;
   Atom text_uri_list;
 } PuglX11Atoms;
 
@@ -38,28 +41,76 @@ typedef struct {
 } PuglTimer;
 
 typedef struct {
-  Atom          selection;
-  Atom          property;
-  Window        source;
-  Atom*         formats;
-  char**        formatStrings;
-  unsigned long numFormats;
-  uint32_t      acceptedFormatIndex;
-  Atom          acceptedFormat;
-  PuglBlob      data;
+  Atom  atom;
+  char* name;
+} PuglX11AtomName;
+
+typedef struct {
+  Window   requestor;
+  Atom     property;
+  Atom     target;
+  uint8_t* data;         ///< Copy of the data, owned by the transfer
+  size_t   len;          ///< Length of data in bytes
+  size_t   offset;       ///< Offset of the next chunk to send
+  double   lastActivity; ///< Time the requestor last asked for a chunk
+} PuglX11Transfer;
+
+typedef struct {
+  Atom              selection;
+  Atom              property;
+  Window            source;
+  Atom*             formats;
+  char**            formatStrings;
+  unsigned long     numFormats;
+  uint32_t          acceptedFormatIndex;
+  Atom              acceptedFormat;
+  PuglBlob          data;
+  PuglBlob          incoming;
+  size_t            incomingCapacity;
+  bool              receiving;
+  PuglX11Transfer*  transfers;
+  size_t            numTransfers;
+  PuglClipboardFunc provider;
+  Atom*             offeredFormats;
+  uint32_t          numOfferedFormats;
+  Window            owner;
+  Window            formatsOwner;
+  Atom              prefetchTarget;
 } PuglX11Clipboard;
 
+typedef void (*PuglX11FreeFunc)(PuglWorld* world, void* data);
+
+typedef PuglStatus (*PuglX11DrawFunc)(PuglView*        view,
+                                      const PuglEvent* configure,
+                                      const PuglEvent* expose);
+
+typedef struct {
+  const PuglBackend* backend;
+  void*              data;
+  PuglX11FreeFunc    freeFunc;
+} PuglX11BackendData;
+
 struct PuglWorldInternalsImpl {
-  Display*     display;
-  PuglX11Atoms atoms;
-  XIM          xim;
-  double       scaleFactor;
-  PuglTimer*   timers;
-  size_t       numTimers;
-  XID          serverTimeCounter;
-  int          syncEventBase;
-  bool         syncSupported;
-  bool         dispatchingEvents;
+  Display*            display;
+  PuglX11Atoms        atoms;
+  XIM                 xim;
+  double              scaleFactor;
+  PuglTimer*          timers;
+  size_t              numTimers;
+  PuglX11AtomName*    atomNames;
+  size_t              numAtomNames;
+  PuglX11BackendData* backendData;
+  size_t              numBackendData;
+  size_t              numRoundTrips; ///< Round trips since puglUpdate() began
+  size_t              numFrames;
+  Cursor              cursors[NUM_CURSORS];
+  XID                 serverTimeCounter;
+  int                 syncEventBase;
+  int                 xfixesEventBase;
+  bool                syncSupported;
+  bool                xfixesSupported;
+  bool                threadSafe;
+  bool                dispatchingEvents;
 };
 
 struct PuglInternalsImpl {
@@ -70,13 +121,71 @@ struct PuglInternalsImpl {
   PuglEvent        pendingConfigure;
   PuglEvent        pendingExpose;
   PuglX11Clipboard clipboard;
+  PuglX11DrawFunc  drawFunc;
   int              screen;
   const char*      cursorName;
 };
 
+/**
+   Make a request that waits for a reply from the X server.
+
+   Every Xlib call that makes a round trip to the server once the world is set
+   up is wrapped in this, so round trips in the event loop can be counted.
+   Evaluates to the result of `call`.
+*/
+#define PUGL_X11_ROUND_TRIP(worldImpl, call) \
+  (++(worldImpl)->numRoundTrips, (call))
+
 PUGL_WARN_UNUSED_RESULT
 PUGL_API
 PuglStatus
 puglX11Configure(PuglView* view);
 
+/**
+   Draw a view by dispatching pending configure and expose events.
+
+   This enters the graphics context, dispatches the given events, then leaves
+   the context, which is what the event loop does to redraw a view.  Either
+   event may be #PUGL_NOTHING.  Backends can set a draw function in the view
+   internals to replace this, for example to call it from another thread.
+*/
+PUGL_API
+PuglStatus
+puglX11DrawView(PuglView*        view,
+                const PuglEvent* configure,
+                const PuglEvent* expose);
+
+/**
+   Return data that a backend has stored in a world.
+
+   Backends can use this to share resources, like caches, between all views
+   in a world.  Returns null if the backend hasn't set any data.
+*/
+PUGL_API
+void*
+puglX11GetBackendData(const PuglWorld* world, const PuglBackend* backend);
+
+/**
+   Set data for a backend in a world.
+
+   The data is freed with `freeFunc` when it is replaced or the world is freed.
+*/
+PUGL_API
+PuglStatus
+puglX11SetBackendData(PuglWorld*         world,
+                      const PuglBackend* backend,
+                      void*              data,
+                      PuglX11FreeFunc    freeFunc);
+
+/**
+   Return the number of round trips made to the X server.
+
+   This counts the requests that waited for a reply from the server since the
+   start of the last call to puglUpdate(), and is only intended for tests that
+   catch regressions which add round trips to the event loop.
+*/
+PUGL_API
+size_t
+puglX11GetNumRoundTrips(const PuglWorld* world);
+
 #endif // PUGL_SRC_X11_H
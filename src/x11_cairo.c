@@ -1,6 +1,8 @@
 // Copyright 2012-2022 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
+#include "allocator.h"
+#include "cairo_layers.h"
 #include "types.h"
 #include "x11.h"
 
@@ -11,14 +13,257 @@
 #include <cairo-xlib.h>
 #include <cairo.h>
 
-#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PUGL_X11_CAIRO_DEFAULT_TILE_SIZE 256u
+
+/// A tile of an exposed region, drawn by a worker
+typedef struct {
+  PuglExposeEvent  region; ///< Region of the view covered by the tile
+  cairo_surface_t* image;  ///< Image the tile is drawn to
+} PuglX11CairoTile;
+
+/// A pool of worker threads that draw tiles
 typedef struct {
-  cairo_surface_t* back;
-  cairo_surface_t* front;
-  cairo_t*         cr;
+  PuglView*         view;
+  PuglCairoTileFunc drawTile;
+  pthread_t*        threads;
+  size_t            numThreads; ///< Number of worker threads
+  pthread_mutex_t   mutex;
+  pthread_cond_t    workCond; ///< Signalled when tiles are ready to draw
+  pthread_cond_t    doneCond; ///< Signalled when all tiles are drawn
+  PuglX11CairoTile* tiles;
+  size_t            numTiles; ///< Number of tiles in the current region
+  size_t            maxTiles; ///< Number of allocated tiles
+  size_t            nextTile; ///< Index of the next tile to draw
+  size_t            numDone;  ///< Number of tiles that have been drawn
+  PuglSpan          tileSize;
+  bool              exiting;
+} PuglX11CairoPool;
+
+typedef struct {
+  cairo_surface_t*  back;
+  cairo_surface_t*  front;
+  cairo_t*          cr;
+  PuglX11CairoPool* pool;
+  PuglCairoLayers   layers;
 } PuglX11CairoSurface;
 
+/// Draw a tile into its image surface
+static void
+puglX11CairoDrawTile(PuglX11CairoPool* const pool, PuglX11CairoTile* const tile)
+{
+  const PuglExposeEvent* const region = &tile->region;
+
+  cairo_t* const cr = cairo_create(tile->image);
+
+  // Clear any previous contents, then draw in view coordinates
+  cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint(cr);
+  cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+  cairo_translate(cr, -(double)region->x, -(double)region->y);
+  cairo_rectangle(cr, region->x, region->y, region->width, region->height);
+  cairo_clip(cr);
+
+  pool->drawTile(pool->view, cr, region);
+
+  cairo_destroy(cr);
+  cairo_surface_flush(tile->image);
+}
+
+/// Draw tiles until there are none left, with the pool mutex held
+static void
+puglX11CairoDrawTiles(PuglX11CairoPool* const pool)
+{
+  while (pool->nextTile < pool->numTiles) {
+    PuglX11CairoTile* const tile = &pool->tiles[pool->nextTile++];
+
+    pthread_mutex_unlock(&pool->mutex);
+    puglX11CairoDrawTile(pool, tile);
+    pthread_mutex_lock(&pool->mutex);
+
+    if (++pool->numDone == pool->numTiles) {
+      pthread_cond_signal(&pool->doneCond);
+    }
+  }
+}
+
+static void*
+puglX11CairoWorker(void* const arg)
+{
+  PuglX11CairoPool* const pool = (PuglX11CairoPool*)arg;
+
+  pthread_mutex_lock(&pool->mutex);
+  while (!pool->exiting) {
+    puglX11CairoDrawTiles(pool);
+    pthread_cond_wait(&pool->workCond, &pool->mutex);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  return NULL;
+}
+
+static void
+puglX11CairoFreePool(PuglX11CairoPool* const pool)
+{
+  if (!pool) {
+    return;
+  }
+
+  pthread_mutex_lock(&pool->mutex);
+  pool->exiting = true;
+  pthread_cond_broadcast(&pool->workCond);
+  pthread_mutex_unlock(&pool->mutex);
+
+  for (size_t i = 0u; i < pool->numThreads; ++i) {
+    pthread_join(pool->threads[i], NULL);
+  }
+
+  for (size_t i = 0u; i < pool->maxTiles; ++i) {
+    cairo_surface_destroy(pool->tiles[i].image);
+  }
+
+  pthread_cond_destroy(&pool->doneCond);
+  pthread_cond_destroy(&pool->workCond);
+  pthread_mutex_destroy(&pool->mutex);
+  puglFree(pool->view->world, pool->tiles);
+  puglFree(pool->view->world, pool->threads);
+  puglFree(pool->view->world, pool);
+}
+
+static PuglX11CairoPool*
+puglX11CairoNewPool(PuglView* const         view,
+                    const PuglCairoTileFunc drawTile,
+                    const unsigned          numThreads,
+                    const PuglSpan          tileSize)
+{
+  PuglX11CairoPool* const pool =
+    (PuglX11CairoPool*)puglCalloc(view->world, 1, sizeof(PuglX11CairoPool));
+  if (!pool) {
+    return NULL;
+  }
+
+  pool->view     = view;
+  pool->drawTile = drawTile;
+  pool->tileSize = tileSize;
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->workCond, NULL);
+  pthread_cond_init(&pool->doneCond, NULL);
+
+  // The thread that handles the expose also draws, so start one less worker
+  if (numThreads > 1u) {
+    if (!(pool->threads = (pthread_t*)puglCalloc(
+            view->world, numThreads - 1u, sizeof(pthread_t)))) {
+      puglX11CairoFreePool(pool);
+      return NULL;
+    }
+
+    for (unsigned i = 0u; i < numThreads - 1u; ++i) {
+      if (pthread_create(&pool->threads[i], NULL, puglX11CairoWorker, pool)) {
+        break;
+      }
+
+      ++pool->numThreads;
+    }
+  }
+
+  return pool;
+}
+
+/// Split a region into tiles, aligned to a grid so images can be reused
+static PuglStatus
+puglX11CairoSplitRegion(PuglX11CairoPool* const      pool,
+                        const PuglExposeEvent* const expose)
+{
+  const PuglCoord x0   = expose->x;
+  const PuglCoord y0   = expose->y;
+  const PuglCoord x1   = (PuglCoord)(expose->x + expose->width);
+  const PuglCoord y1   = (PuglCoord)(expose->y + expose->height);
+  const PuglCoord size = (PuglCoord)pool->tileSize;
+
+  const PuglCoord gx0 = (PuglCoord)(x0 - (x0 % size));
+  const PuglCoord gy0 = (PuglCoord)(y0 - (y0 % size));
+  const size_t    nx  = (size_t)((x1 - gx0 + size - 1) / size);
+  const size_t    ny  = (size_t)((y1 - gy0 + size - 1) / size);
+  const size_t    n   = nx * ny;
+
+  // Allocate enough tiles, keeping the images of any existing ones
+  if (n > pool->maxTiles) {
+    PuglX11CairoTile* const tiles = (PuglX11CairoTile*)puglRealloc(
+      pool->view->world, pool->tiles, n * sizeof(PuglX11CairoTile));
+    if (!tiles) {
+      return PUGL_NO_MEMORY;
+    }
+
+    for (size_t i = pool->maxTiles; i < n; ++i) {
+      tiles[i].image = cairo_image_surface_create(
+        CAIRO_FORMAT_ARGB32, (int)pool->tileSize, (int)pool->tileSize);
+    }
+
+    pool->tiles    = tiles;
+    pool->maxTiles = n;
+  }
+
+  size_t i = 0u;
+  for (PuglCoord y = gy0; y < y1; y = (PuglCoord)(y + size)) {
+    for (PuglCoord x = gx0; x < x1; x = (PuglCoord)(x + size)) {
+      PuglExposeEvent* const region = &pool->tiles[i++].region;
+
+      const PuglCoord tx0 = x > x0 ? x : x0;
+      const PuglCoord ty0 = y > y0 ? y : y0;
+      const PuglCoord tx1 = (x + size) < x1 ? (PuglCoord)(x + size) : x1;
+      const PuglCoord ty1 = (y + size) < y1 ? (PuglCoord)(y + size) : y1;
+
+      *region        = *expose;
+      region->x      = tx0;
+      region->y      = ty0;
+      region->width  = (PuglSpan)(tx1 - tx0);
+      region->height = (PuglSpan)(ty1 - ty0);
+    }
+  }
+
+  pool->numTiles = i;
+  return PUGL_SUCCESS;
+}
+
+/// Draw all tiles of an exposed region, and composite them onto `cr`
+static PuglStatus
+puglX11CairoDrawTiled(PuglX11CairoPool* const      pool,
+                      const PuglExposeEvent* const expose,
+                      cairo_t* const               cr)
+{
+  PuglStatus st = PUGL_SUCCESS;
+
+  pthread_mutex_lock(&pool->mutex);
+  if (!(st = puglX11CairoSplitRegion(pool, expose))) {
+    // Start the workers, and draw tiles on this thread until all are done
+    pool->nextTile = 0u;
+    pool->numDone  = 0u;
+    pthread_cond_broadcast(&pool->workCond);
+    puglX11CairoDrawTiles(pool);
+    while (pool->numDone < pool->numTiles) {
+      pthread_cond_wait(&pool->doneCond, &pool->mutex);
+    }
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  // Composite the tiles into the view
+  for (size_t i = 0u; !st && i < pool->numTiles; ++i) {
+    const PuglExposeEvent* const region = &pool->tiles[i].region;
+
+    cairo_set_source_surface(cr, pool->tiles[i].image, region->x, region->y);
+    cairo_rectangle(cr, region->x, region->y, region->width, region->height);
+    cairo_fill(cr);
+  }
+
+  return st;
+}
+
 static void
 puglX11CairoClose(PuglView* view)
 {
@@ -57,14 +302,23 @@ puglX11CairoOpen(PuglView* view)
   return PUGL_SUCCESS;
 }
 
-static PuglStatus
-puglX11CairoCreate(PuglView* view)
+static PuglX11CairoSurface*
+puglX11CairoGetSurface(PuglView* view)
 {
+  // Allocate the surface on demand, since it can be configured before realizing
   PuglInternals* const impl = view->impl;
+  if (!impl->surface) {
+    impl->surface = (cairo_surface_t*)puglCalloc(
+      view->world, 1, sizeof(PuglX11CairoSurface));
+  }
 
-  impl->surface = (cairo_surface_t*)calloc(1, sizeof(PuglX11CairoSurface));
+  return (PuglX11CairoSurface*)impl->surface;
+}
 
-  return PUGL_SUCCESS;
+static PuglStatus
+puglX11CairoCreate(PuglView* view)
+{
+  return puglX11CairoGetSurface(view) ? PUGL_SUCCESS : PUGL_NO_MEMORY;
 }
 
 static void
@@ -73,8 +327,13 @@ puglX11CairoDestroy(PuglView* view)
   PuglInternals* const       impl    = view->impl;
   PuglX11CairoSurface* const surface = (PuglX11CairoSurface*)impl->surface;
 
-  puglX11CairoClose(view);
-  free(surface);
+  if (surface) {
+    puglX11CairoClose(view);
+    puglX11CairoFreePool(surface->pool);
+    puglCairoFreeLayers(view, &surface->layers);
+    puglFree(view->world, surface);
+    impl->surface = NULL;
+  }
 }
 
 static PuglStatus
@@ -87,6 +346,14 @@ puglX11CairoEnter(PuglView* view, const PuglExposeEvent* expose)
   if (expose && !(st = puglX11CairoOpen(view))) {
     surface->cr = cairo_create(surface->front);
     st = cairo_status(surface->cr) ? PUGL_CREATE_CONTEXT_FAILED : PUGL_SUCCESS;
+
+    if (!st && surface->layers.numLayers) {
+      st = puglCairoDrawLayers(view, &surface->layers, surface->cr, expose);
+    }
+
+    if (!st && surface->pool) {
+      st = puglX11CairoDrawTiled(surface->pool, expose, surface->cr);
+    }
   }
 
   return st;
@@ -131,6 +398,46 @@ puglX11CairoGetContext(PuglView* view)
   return surface->cr;
 }
 
+PuglCairoLayers*
+puglCairoGetLayers(PuglView* const view)
+{
+  PuglX11CairoSurface* const surface = puglX11CairoGetSurface(view);
+
+  return surface ? &surface->layers : NULL;
+}
+
+PuglStatus
+puglSetCairoTileFunc(PuglView* const         view,
+                     const PuglCairoTileFunc drawTile,
+                     const unsigned          numThreads,
+                     const PuglSpan          tileSize)
+{
+  if (view->backend != puglCairoBackend()) {
+    return PUGL_BAD_BACKEND;
+  }
+
+  PuglX11CairoSurface* const surface = puglX11CairoGetSurface(view);
+  if (!surface) {
+    return PUGL_NO_MEMORY;
+  }
+
+  // Replace any existing worker pool
+  puglX11CairoFreePool(surface->pool);
+  surface->pool = NULL;
+  if (!drawTile) {
+    return PUGL_SUCCESS;
+  }
+
+  const long     numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+  const unsigned n =
+    numThreads ? numThreads : numProcessors > 0 ? (unsigned)numProcessors : 1u;
+
+  surface->pool = puglX11CairoNewPool(
+    view, drawTile, n, tileSize ? tileSize : PUGL_X11_CAIRO_DEFAULT_TILE_SIZE);
+
+  return surface->pool ? PUGL_SUCCESS : PUGL_NO_MEMORY;
+}
+
 const PuglBackend*
 puglCairoBackend(void)
 {
@@ -0,0 +1,451 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "x11_egl.h"
+
+#include "allocator.h"
+#include "attributes.h"
+#include "stub.h"
+#include "types.h"
+#include "x11.h"
+
+#include "pugl/egl.h"
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <X11/X.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+  EGLConfig                          config;
+  EGLContext                         context;
+  EGLSurface                         surface;
+  PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC swap_with_damage;
+  bool                               offscreen;
+  bool                               has_buffer_age;
+} PuglX11EglSurface;
+
+static void
+puglX11EglTerminate(PuglWorld* PUGL_UNUSED(world), void* data)
+{
+  eglTerminate((EGLDisplay)data);
+}
+
+static bool
+puglX11EglHasExtension(const EGLDisplay display, const char* const name)
+{
+  const char* const extensions = eglQueryString(display, EGL_EXTENSIONS);
+  return extensions && !!strstr(extensions, name);
+}
+
+/// Return the EGL display for a world, initializing it if necessary
+static EGLDisplay
+puglX11EglGetDisplay(PuglWorld* const world)
+{
+  // The display is shared by all views in the world regardless of backend
+  EGLDisplay display = puglX11GetBackendData(world, puglEglBackend());
+  if (display) {
+    return display;
+  }
+
+  // Get the display for the X11 connection, explicitly if possible
+  Display* const xdisplay = world->impl->display;
+  if (puglX11EglHasExtension(EGL_NO_DISPLAY, "EGL_EXT_platform_x11")) {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+        "eglGetPlatformDisplayEXT");
+
+    if (get_platform_display) {
+      display = get_platform_display(EGL_PLATFORM_X11_EXT, xdisplay, NULL);
+    }
+  } else {
+    display = eglGetDisplay((EGLNativeDisplayType)xdisplay);
+  }
+
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+    return EGL_NO_DISPLAY;
+  }
+
+  if (puglX11SetBackendData(
+        world, puglEglBackend(), display, puglX11EglTerminate)) {
+    eglTerminate(display);
+    return EGL_NO_DISPLAY;
+  }
+
+  return display;
+}
+
+static int
+puglX11EglGetAttrib(const EGLDisplay display,
+                    const EGLConfig  config,
+                    const EGLint     attrib)
+{
+  EGLint value = 0;
+  eglGetConfigAttrib(display, config, attrib, &value);
+  return value;
+}
+
+static PuglStatus
+puglX11EglConfigure(PuglView* const view, const bool offscreen)
+{
+  PuglInternals* const impl    = view->impl;
+  const EGLDisplay     display = puglX11EglGetDisplay(view->world);
+  if (display == EGL_NO_DISPLAY) {
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
+
+  PuglX11EglSurface* const surface =
+    (PuglX11EglSurface*)puglCalloc(view->world, 1, sizeof(PuglX11EglSurface));
+  if (!surface) {
+    return PUGL_NO_MEMORY;
+  }
+
+  impl->surface      = surface;
+  surface->context   = EGL_NO_CONTEXT;
+  surface->surface   = EGL_NO_SURFACE;
+  surface->offscreen = offscreen;
+
+  // clang-format off
+  const EGLint attrs[] = {
+    EGL_SURFACE_TYPE,    offscreen ? EGL_PBUFFER_BIT : EGL_WINDOW_BIT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_SAMPLES,         view->hints[PUGL_SAMPLES],
+    EGL_RED_SIZE,        view->hints[PUGL_RED_BITS],
+    EGL_GREEN_SIZE,      view->hints[PUGL_GREEN_BITS],
+    EGL_BLUE_SIZE,       view->hints[PUGL_BLUE_BITS],
+    EGL_ALPHA_SIZE,      view->hints[PUGL_ALPHA_BITS],
+    EGL_DEPTH_SIZE,      view->hints[PUGL_DEPTH_BITS],
+    EGL_STENCIL_SIZE,    view->hints[PUGL_STENCIL_BITS],
+    EGL_NONE
+  };
+  // clang-format on
+
+  EGLint n_configs = 0;
+  if (!eglChooseConfig(display, attrs, &surface->config, 1, &n_configs) ||
+      n_configs < 1) {
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
+
+  if (offscreen) {
+    // The window is never drawn to, so just use the default visual
+    const PuglStatus st = puglX11Configure(view);
+    if (st) {
+      return st;
+    }
+  } else {
+    // Get the visual for the config (without contacting the server)
+    XVisualInfo pat;
+    int         n = 0;
+    memset(&pat, 0, sizeof(pat));
+    pat.visualid = (VisualID)puglX11EglGetAttrib(
+      display, surface->config, EGL_NATIVE_VISUAL_ID);
+    pat.screen = impl->screen;
+    if (!(impl->vi = XGetVisualInfo(view->world->impl->display,
+                                    VisualIDMask | VisualScreenMask,
+                                    &pat,
+                                    &n))) {
+      return PUGL_CREATE_CONTEXT_FAILED;
+    }
+  }
+
+  // Set the hints to the actual values of the config
+  const EGLConfig config = surface->config;
+
+  view->hints[PUGL_RED_BITS] =
+    puglX11EglGetAttrib(display, config, EGL_RED_SIZE);
+  view->hints[PUGL_GREEN_BITS] =
+    puglX11EglGetAttrib(display, config, EGL_GREEN_SIZE);
+  view->hints[PUGL_BLUE_BITS] =
+    puglX11EglGetAttrib(display, config, EGL_BLUE_SIZE);
+  view->hints[PUGL_ALPHA_BITS] =
+    puglX11EglGetAttrib(display, config, EGL_ALPHA_SIZE);
+  view->hints[PUGL_DEPTH_BITS] =
+    puglX11EglGetAttrib(display, config, EGL_DEPTH_SIZE);
+  view->hints[PUGL_STENCIL_BITS] =
+    puglX11EglGetAttrib(display, config, EGL_STENCIL_SIZE);
+  view->hints[PUGL_SAMPLES] = puglX11EglGetAttrib(display, config, EGL_SAMPLES);
+
+  // Window surfaces are always double buffered, and pbuffers never are
+  view->hints[PUGL_DOUBLE_BUFFER] = offscreen ? PUGL_FALSE : PUGL_TRUE;
+
+  // Render threads and draw timing aren't supported
+  view->hints[PUGL_RENDER_THREAD] = PUGL_FALSE;
+  view->hints[PUGL_DRAW_TIMING]   = PUGL_FALSE;
+
+  return PUGL_SUCCESS;
+}
+
+static PuglStatus
+puglX11EglConfigureWindow(PuglView* const view)
+{
+  return puglX11EglConfigure(view, false);
+}
+
+static PuglStatus
+puglX11EglConfigureOffscreen(PuglView* const view)
+{
+  return puglX11EglConfigure(view, true);
+}
+
+PUGL_WARN_UNUSED_RESULT
+static PuglStatus
+puglX11EglEnter(PuglView* const view,
+                const PuglExposeEvent* PUGL_UNUSED(expose))
+{
+  const PuglX11EglSurface* const surface =
+    (const PuglX11EglSurface*)view->impl->surface;
+  if (!surface || surface->context == EGL_NO_CONTEXT) {
+    return PUGL_FAILURE;
+  }
+
+  if (eglGetCurrentContext() == surface->context &&
+      eglGetCurrentSurface(EGL_DRAW) == surface->surface) {
+    return PUGL_SUCCESS; // Already current on this thread
+  }
+
+  const EGLDisplay display = puglX11EglGetDisplay(view->world);
+
+  return eglMakeCurrent(
+           display, surface->surface, surface->surface, surface->context)
+           ? PUGL_SUCCESS
+           : PUGL_FAILURE;
+}
+
+PUGL_WARN_UNUSED_RESULT
+static PuglStatus
+puglX11EglLeave(PuglView* const view, const PuglExposeEvent* const expose)
+{
+  const PuglX11EglSurface* const surface =
+    (const PuglX11EglSurface*)view->impl->surface;
+  if (!expose || !surface || surface->offscreen) {
+    return PUGL_SUCCESS;
+  }
+
+  const EGLDisplay display = puglX11EglGetDisplay(view->world);
+  const bool       partial =
+    expose->x > 0 || expose->y > 0 ||
+    expose->x + expose->width < view->frame.width ||
+    expose->y + expose->height < view->frame.height;
+
+  if (partial && surface->swap_with_damage) {
+    // Only report the exposed region as damaged (with a flipped Y)
+    EGLint rect[] = {
+      expose->x,
+      (EGLint)view->frame.height - expose->y - (EGLint)expose->height,
+      (EGLint)expose->width,
+      (EGLint)expose->height,
+    };
+
+    surface->swap_with_damage(display, surface->surface, rect, 1);
+  } else {
+    eglSwapBuffers(display, surface->surface);
+  }
+
+  // Leave the context current, so entering it again doesn't need a switch
+  return PUGL_SUCCESS;
+}
+
+static PuglStatus
+puglX11EglCreate(PuglView* const view)
+{
+  PuglX11EglSurface* const surface = (PuglX11EglSurface*)view->impl->surface;
+  const EGLDisplay         display = puglX11EglGetDisplay(view->world);
+  PuglStatus               st      = PUGL_SUCCESS;
+
+  // Get the context to share objects with, if any
+  EGLContext share_context = EGL_NO_CONTEXT;
+  if (view->shareView) {
+    const PuglX11EglSurface* const share_surface =
+      (const PuglX11EglSurface*)view->shareView->impl->surface;
+
+    if (!puglX11EglIsBackend(view->shareView->backend) || !share_surface ||
+        share_surface->context == EGL_NO_CONTEXT) {
+      return PUGL_CREATE_CONTEXT_FAILED;
+    }
+
+    share_context = share_surface->context;
+  }
+
+  const EGLint ctx_attrs[] = {
+    EGL_CONTEXT_MAJOR_VERSION_KHR,
+    view->hints[PUGL_CONTEXT_VERSION_MAJOR],
+
+    EGL_CONTEXT_MINOR_VERSION_KHR,
+    view->hints[PUGL_CONTEXT_VERSION_MINOR],
+
+    EGL_CONTEXT_FLAGS_KHR,
+    (view->hints[PUGL_USE_DEBUG_CONTEXT] ? EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR
+                                         : 0),
+
+    EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR,
+    (view->hints[PUGL_USE_COMPAT_PROFILE]
+       ? EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT_KHR
+       : EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR),
+    EGL_NONE};
+
+  // Create the context with the full OpenGL API
+  if (!eglBindAPI(EGL_OPENGL_API) ||
+      (surface->context = eglCreateContext(
+         display, surface->config, share_context, ctx_attrs)) ==
+        EGL_NO_CONTEXT) {
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
+
+  // Create the surface to draw to, unless the context can be surfaceless
+  const bool surfaceless =
+    surface->offscreen &&
+    puglX11EglHasExtension(display, "EGL_KHR_surfaceless_context");
+
+  if (!surface->offscreen) {
+    surface->surface =
+      eglCreateWindowSurface(display,
+                             surface->config,
+                             (EGLNativeWindowType)view->impl->win,
+                             NULL);
+  } else if (!surfaceless) {
+    const EGLint pbuffer_attrs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+
+    surface->surface =
+      eglCreatePbufferSurface(display, surface->config, pbuffer_attrs);
+  }
+
+  if (!surfaceless && surface->surface == EGL_NO_SURFACE) {
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
+
+  // Check for extensions used for partial updates
+  surface->has_buffer_age =
+    !surface->offscreen &&
+    puglX11EglHasExtension(display, "EGL_EXT_buffer_age");
+  if (!surface->offscreen &&
+      puglX11EglHasExtension(display, "EGL_KHR_swap_buffers_with_damage")) {
+    surface->swap_with_damage =
+      (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress(
+        "eglSwapBuffersWithDamageKHR");
+  }
+
+  if (surface->offscreen) {
+    view->hints[PUGL_SWAP_INTERVAL] = 0;
+    return PUGL_SUCCESS;
+  }
+
+  // Set the swap interval, which requires the context to be current
+  if ((st = puglX11EglEnter(view, NULL))) {
+    return st;
+  }
+
+  if (view->hints[PUGL_SWAP_INTERVAL] == PUGL_DONT_CARE) {
+    view->hints[PUGL_SWAP_INTERVAL] = 1; // The default for EGL surfaces
+  } else if (!eglSwapInterval(display, view->hints[PUGL_SWAP_INTERVAL])) {
+    view->hints[PUGL_SWAP_INTERVAL] = 1;
+  }
+
+  // Adaptive swapping isn't supported
+  view->hints[PUGL_ADAPTIVE_SWAP] = PUGL_FALSE;
+
+  return puglX11EglLeave(view, NULL);
+}
+
+static void
+puglX11EglDestroy(PuglView* const view)
+{
+  PuglX11EglSurface* const surface = (PuglX11EglSurface*)view->impl->surface;
+  if (surface) {
+    const EGLDisplay display = puglX11EglGetDisplay(view->world);
+
+    puglX11EglUnbind(view);
+    if (surface->surface != EGL_NO_SURFACE) {
+      eglDestroySurface(display, surface->surface);
+    }
+
+    if (surface->context != EGL_NO_CONTEXT) {
+      eglDestroyContext(display, surface->context);
+    }
+
+    puglFree(view->world, surface);
+    view->impl->surface = NULL;
+  }
+}
+
+bool
+puglX11EglIsBackend(const PuglBackend* const backend)
+{
+  return backend == puglEglBackend() || backend == puglEglOffscreenBackend();
+}
+
+PuglGlFunc
+puglX11EglGetProcAddress(const char* const name)
+{
+  return (eglGetCurrentContext() != EGL_NO_CONTEXT) ? eglGetProcAddress(name)
+                                                    : NULL;
+}
+
+unsigned
+puglX11EglGetBufferAge(PuglView* const view)
+{
+  const PuglX11EglSurface* const surface =
+    (const PuglX11EglSurface*)view->impl->surface;
+
+  EGLint age = 0;
+  if (surface && surface->has_buffer_age) {
+    eglQuerySurface(puglX11EglGetDisplay(view->world),
+                    surface->surface,
+                    EGL_BUFFER_AGE_EXT,
+                    &age);
+  }
+
+  return age > 0 ? (unsigned)age : 0u;
+}
+
+PuglStatus
+puglX11EglUnbind(PuglView* const view)
+{
+  const PuglX11EglSurface* const surface =
+    (const PuglX11EglSurface*)view->impl->surface;
+
+  if (!surface || surface->context == EGL_NO_CONTEXT ||
+      eglGetCurrentContext() != surface->context) {
+    return PUGL_SUCCESS;
+  }
+
+  return eglMakeCurrent(puglX11EglGetDisplay(view->world),
+                        EGL_NO_SURFACE,
+                        EGL_NO_SURFACE,
+                        EGL_NO_CONTEXT)
+           ? PUGL_SUCCESS
+           : PUGL_FAILURE;
+}
+
+const PuglBackend*
+puglEglBackend(void)
+{
+  static const PuglBackend backend = {puglX11EglConfigureWindow,
+                                      puglX11EglCreate,
+                                      puglX11EglDestroy,
+                                      puglX11EglEnter,
+                                      puglX11EglLeave,
+                                      puglStubGetContext};
+
+  return &backend;
+}
+
+const PuglBackend*
+puglEglOffscreenBackend(void)
+{
+  static const PuglBackend backend = {puglX11EglConfigureOffscreen,
+                                      puglX11EglCreate,
+                                      puglX11EglDestroy,
+                                      puglX11EglEnter,
+                                      puglX11EglLeave,
+                                      puglStubGetContext};
+
+  return &backend;
+}
@@ -0,0 +1,32 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef PUGL_SRC_X11_EGL_H
+#define PUGL_SRC_X11_EGL_H
+
+#include "types.h"
+
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+#include <stdbool.h>
+
+// Internal EGL functions used by the OpenGL API implementation in x11_gl.c
+
+/// Return true if `backend` is one of the EGL backends
+bool
+puglX11EglIsBackend(const PuglBackend* backend);
+
+/// Return the address of a function if an EGL context is current
+PuglGlFunc
+puglX11EglGetProcAddress(const char* name);
+
+/// Return the age of the back buffer of a view with an EGL backend
+unsigned
+puglX11EglGetBufferAge(PuglView* view);
+
+/// Release the EGL context of a view if it is current on this thread
+PuglStatus
+puglX11EglUnbind(PuglView* view);
+
+#endif // PUGL_SRC_X11_EGL_H
@@ -1,11 +1,17 @@
 // Copyright 2012-2022 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
+#include "allocator.h"
 #include "attributes.h"
+#include "implementation.h"
 #include "stub.h"
 #include "types.h"
 #include "x11.h"
 
+#ifdef HAVE_EGL
+#  include "x11_egl.h"
+#endif
+
 #include "pugl/gl.h"
 #include "pugl/pugl.h"
 
@@ -13,16 +19,139 @@
 #include <X11/X.h>
 #include <X11/Xlib.h>
 
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
 
+#ifndef MIN
+#  define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#  define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
+#ifndef GLX_BACK_BUFFER_AGE_EXT
+#  define GLX_BACK_BUFFER_AGE_EXT 0x20F4
+#endif
+
+#ifndef GLX_LATE_SWAPS_TEAR_EXT
+#  define GLX_LATE_SWAPS_TEAR_EXT 0x20F3
+#endif
+
+/// Number of frames that can be timed before results are read back
+#define PUGL_X11_GL_NUM_QUERIES 4u
+
+/// Timer queries that measure how long frames take to draw
 typedef struct {
-  GLXFBConfig fb_config;
-  GLXContext  ctx;
+  PFNGLBEGINQUERYPROC          begin_query;
+  PFNGLENDQUERYPROC            end_query;
+  PFNGLGETQUERYOBJECTIVPROC    get_query_iv;
+  PFNGLGETQUERYOBJECTUI64VPROC get_query_ui64v;
+  GLuint                       queries[PUGL_X11_GL_NUM_QUERIES];
+  double                       cpu_times[PUGL_X11_GL_NUM_QUERIES];
+  uint64_t                     n_frames;
+  uint64_t                     n_read;
+  double                       begin_time;
+  PuglDrawTiming               latest;
+  bool                         active;
+} PuglX11GlTimer;
+
+/// A thread that draws a view with the latest events from the event loop
+typedef struct {
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  PuglEvent       configure; ///< Pending configure for the application
+  PuglEvent       expose;    ///< Pending exposed region
+  PuglRect        frame;     ///< View frame when the events were queued
+  PuglRect        drawFrame; ///< Frame being drawn, used only by the thread
+  bool            running;
+  bool            exiting;
+} PuglX11GlRenderThread;
+
+typedef struct {
+  GLXFBConfig                 fb_config;
+  GLXContext                  ctx;
+  PuglX11GlRenderThread*      render_thread;
+  PuglX11GlTimer*             timer;
+  PFNGLXCOPYSUBBUFFERMESAPROC copy_sub_buffer;
+  PFNGLXGETSYNCVALUESOMLPROC  get_sync_values;
+  PFNGLXWAITFORSBCOMLPROC     wait_for_sbc;
+  PFNGLXSWAPINTERVALEXTPROC   swap_interval;
+  int64_t                     last_msc;
+  int64_t                     last_sbc;
+  int                         interval;
+  int                         current_interval;
+  bool                        has_buffer_age;
+  bool                        synced;
+  bool                        double_buffered; ///< Copy of the resolved hint
+  bool                        copy_partial;    ///< Copy partial updates
 } PuglX11GlSurface;
 
+/// Hints that determine which framebuffer configuration is chosen
+static const PuglViewHint puglX11GlConfigHints[] = {
+  PUGL_SAMPLES,
+  PUGL_RED_BITS,
+  PUGL_GREEN_BITS,
+  PUGL_BLUE_BITS,
+  PUGL_ALPHA_BITS,
+  PUGL_DEPTH_BITS,
+  PUGL_STENCIL_BITS,
+  PUGL_DOUBLE_BUFFER,
+};
+
+#define NUM_CONFIG_HINTS \
+  (sizeof(puglX11GlConfigHints) / sizeof(puglX11GlConfigHints[0]))
+
+/// A framebuffer configuration chosen for a set of hints
+typedef struct {
+  int         screen;
+  int         requested[NUM_CONFIG_HINTS];
+  int         resolved[NUM_CONFIG_HINTS];
+  GLXFBConfig fb_config;
+  VisualID    visual_id;
+} PuglX11GlConfig;
+
+/// State shared by all views in the world
+typedef struct {
+  PuglX11GlConfig* configs;        ///< Cached framebuffer configurations
+  size_t           n_configs;      ///< Number of cached configurations
+  size_t           n_synced_views; ///< Number of views with synced swaps
+  size_t           swap_frame;     ///< Last frame that waited for a refresh
+} PuglX11GlWorld;
+
+static void
+puglX11GlFreeWorld(PuglWorld* const world, void* const data)
+{
+  PuglX11GlWorld* const gl_world = (PuglX11GlWorld*)data;
+
+  puglFree(world, gl_world->configs);
+  puglFree(world, gl_world);
+}
+
+static PuglX11GlWorld*
+puglX11GlGetWorld(PuglView* view)
+{
+  // Get the state from the world, or create it if this is the first view
+  PuglX11GlWorld* gl_world =
+    (PuglX11GlWorld*)puglX11GetBackendData(view->world, view->backend);
+  if (!gl_world) {
+    if (!(gl_world = (PuglX11GlWorld*)puglCalloc(
+            view->world, 1, sizeof(PuglX11GlWorld))) ||
+        puglX11SetBackendData(
+          view->world, view->backend, gl_world, puglX11GlFreeWorld)) {
+      puglFree(view->world, gl_world);
+      return NULL;
+    }
+  }
+
+  return gl_world;
+}
+
 static int
 puglX11GlHintValue(const int value)
 {
@@ -40,15 +169,9 @@ puglX11GlGetAttrib(Display* const display,
 }
 
 static PuglStatus
-puglX11GlConfigure(PuglView* view)
+puglX11GlChooseConfig(PuglView* view, PuglX11GlConfig* config)
 {
-  PuglInternals* const impl    = view->impl;
-  const int            screen  = impl->screen;
-  Display* const       display = view->world->impl->display;
-
-  PuglX11GlSurface* const surface =
-    (PuglX11GlSurface*)calloc(1, sizeof(PuglX11GlSurface));
-  impl->surface = surface;
+  Display* const display = view->world->impl->display;
 
   // clang-format off
   const int attrs[] = {
@@ -66,41 +189,194 @@ puglX11GlConfigure(PuglView* view)
     GLX_DOUBLEBUFFER,  puglX11GlHintValue(view->hints[PUGL_DOUBLE_BUFFER]),
     None
   };
+
+  // Attributes corresponding to puglX11GlConfigHints
+  static const int hint_attribs[] = {
+    GLX_SAMPLES,
+    GLX_RED_SIZE,
+    GLX_GREEN_SIZE,
+    GLX_BLUE_SIZE,
+    GLX_ALPHA_SIZE,
+    GLX_DEPTH_SIZE,
+    GLX_STENCIL_SIZE,
+    GLX_DOUBLEBUFFER,
+  };
   // clang-format on
 
   int          n_fbc = 0;
-  GLXFBConfig* fbc   = glXChooseFBConfig(display, screen, attrs, &n_fbc);
+  GLXFBConfig* fbc =
+    glXChooseFBConfig(display, config->screen, attrs, &n_fbc);
   if (n_fbc <= 0) {
     return PUGL_CREATE_CONTEXT_FAILED;
   }
 
-  surface->fb_config = fbc[0];
-  impl->vi           = glXGetVisualFromFBConfig(display, fbc[0]);
-
-  view->hints[PUGL_RED_BITS] =
-    puglX11GlGetAttrib(display, fbc[0], GLX_RED_SIZE);
-  view->hints[PUGL_GREEN_BITS] =
-    puglX11GlGetAttrib(display, fbc[0], GLX_GREEN_SIZE);
-  view->hints[PUGL_BLUE_BITS] =
-    puglX11GlGetAttrib(display, fbc[0], GLX_BLUE_SIZE);
-  view->hints[PUGL_ALPHA_BITS] =
-    puglX11GlGetAttrib(display, fbc[0], GLX_ALPHA_SIZE);
-  view->hints[PUGL_DEPTH_BITS] =
-    puglX11GlGetAttrib(display, fbc[0], GLX_DEPTH_SIZE);
-  view->hints[PUGL_STENCIL_BITS] =
-    puglX11GlGetAttrib(display, fbc[0], GLX_STENCIL_SIZE);
-  view->hints[PUGL_SAMPLES] = puglX11GlGetAttrib(display, fbc[0], GLX_SAMPLES);
-  view->hints[PUGL_DOUBLE_BUFFER] =
-    puglX11GlGetAttrib(display, fbc[0], GLX_DOUBLEBUFFER);
+  XVisualInfo* const vi = glXGetVisualFromFBConfig(display, fbc[0]);
+  if (!vi) {
+    XFree(fbc);
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
 
+  config->fb_config = fbc[0];
+  config->visual_id = vi->visualid;
+  for (size_t i = 0u; i < NUM_CONFIG_HINTS; ++i) {
+    config->resolved[i] = puglX11GlGetAttrib(display, fbc[0], hint_attribs[i]);
+  }
+
+  XFree(vi);
   XFree(fbc);
+  return PUGL_SUCCESS;
+}
+
+static const PuglX11GlConfig*
+puglX11GlGetConfig(PuglView* view)
+{
+  PuglX11GlWorld* const cache = puglX11GlGetWorld(view);
+  if (!cache) {
+    return NULL;
+  }
+
+  // Make a new config with the relevant hints from the view
+  PuglX11GlConfig config = {view->impl->screen, {0}, {0}, NULL, 0};
+  for (size_t i = 0u; i < NUM_CONFIG_HINTS; ++i) {
+    config.requested[i] = view->hints[puglX11GlConfigHints[i]];
+  }
+
+  // Return an existing config if the same hints have already been used
+  for (size_t i = 0u; i < cache->n_configs; ++i) {
+    const PuglX11GlConfig* const cached = &cache->configs[i];
+    if (cached->screen == config.screen &&
+        !memcmp(
+          cached->requested, config.requested, sizeof(config.requested))) {
+      return cached;
+    }
+  }
+
+  // Otherwise, choose a new config and add it to the cache
+  PuglX11GlConfig* const new_configs = (PuglX11GlConfig*)puglRealloc(
+    view->world,
+    cache->configs,
+    (cache->n_configs + 1u) * sizeof(PuglX11GlConfig));
+  if (!new_configs) {
+    return NULL;
+  }
+
+  cache->configs = new_configs;
+  if (puglX11GlChooseConfig(view, &config)) {
+    return NULL;
+  }
+
+  cache->configs[cache->n_configs] = config;
+  return &cache->configs[cache->n_configs++];
+}
+
+static PuglStatus
+puglX11GlConfigure(PuglView* view)
+{
+  PuglInternals* const impl    = view->impl;
+  Display* const       display = view->world->impl->display;
+
+  PuglX11GlSurface* const surface =
+    (PuglX11GlSurface*)puglCalloc(view->world, 1, sizeof(PuglX11GlSurface));
+  if (!surface) {
+    return PUGL_NO_MEMORY;
+  }
+
+  impl->surface = surface;
+
+  // Get a framebuffer configuration, which may be cached in the world
+  const PuglX11GlConfig* const config = puglX11GlGetConfig(view);
+  if (!config) {
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
+
+  // Get the visual info for the configuration (without contacting the server)
+  XVisualInfo pat;
+  int         n = 0;
+  memset(&pat, 0, sizeof(pat));
+  pat.visualid = config->visual_id;
+  pat.screen   = config->screen;
+  if (!(impl->vi =
+          XGetVisualInfo(display, VisualIDMask | VisualScreenMask, &pat, &n))) {
+    return PUGL_CREATE_CONTEXT_FAILED;
+  }
+
+  // Set the hints to the actual values of the configuration
+  surface->fb_config = config->fb_config;
+  for (size_t i = 0u; i < NUM_CONFIG_HINTS; ++i) {
+    view->hints[puglX11GlConfigHints[i]] = config->resolved[i];
+  }
 
   return PUGL_SUCCESS;
 }
 
+static void
+puglX11GlStopRenderThread(PuglX11GlRenderThread* const thread)
+{
+  if (thread->running) {
+    pthread_mutex_lock(&thread->mutex);
+    thread->exiting = true;
+    pthread_cond_signal(&thread->cond);
+    pthread_mutex_unlock(&thread->mutex);
+
+    pthread_join(thread->thread, NULL);
+    thread->running = false;
+    thread->exiting = false;
+  }
+}
+
+/// Read back the results of any finished timer queries, without waiting
+static void
+puglX11GlReadTimer(PuglX11GlTimer* const timer)
+{
+  while (timer->n_read < timer->n_frames) {
+    const size_t i         = timer->n_read % PUGL_X11_GL_NUM_QUERIES;
+    GLint        available = 0;
+    GLuint64     elapsed   = 0u;
+
+    timer->get_query_iv(
+      timer->queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+      break;
+    }
+
+    timer->get_query_ui64v(timer->queries[i], GL_QUERY_RESULT, &elapsed);
+    timer->latest.cpuTime = timer->cpu_times[i];
+    timer->latest.gpuTime = (double)elapsed / 1000000000.0;
+    timer->latest.frame   = ++timer->n_read;
+  }
+}
+
+static void
+puglX11GlBeginTimer(PuglView* const view, PuglX11GlTimer* const timer)
+{
+  puglX11GlReadTimer(timer);
+
+  // Time this frame, unless every query is still waiting for the GPU
+  if (timer->n_frames - timer->n_read < PUGL_X11_GL_NUM_QUERIES) {
+    const size_t i = timer->n_frames % PUGL_X11_GL_NUM_QUERIES;
+
+    timer->begin_query(GL_TIME_ELAPSED, timer->queries[i]);
+    timer->begin_time = puglGetTime(view->world);
+    timer->active     = true;
+  }
+}
+
+static void
+puglX11GlEndTimer(PuglView* const view, PuglX11GlTimer* const timer)
+{
+  if (timer->active) {
+    const size_t i = timer->n_frames % PUGL_X11_GL_NUM_QUERIES;
+
+    timer->end_query(GL_TIME_ELAPSED);
+    timer->cpu_times[i] = puglGetTime(view->world) - timer->begin_time;
+    timer->active       = false;
+    ++timer->n_frames;
+  }
+}
+
 PUGL_WARN_UNUSED_RESULT
 static PuglStatus
-puglX11GlEnter(PuglView* view, const PuglExposeEvent* PUGL_UNUSED(expose))
+puglX11GlEnter(PuglView* view, const PuglExposeEvent* expose)
 {
   PuglX11GlSurface* surface = (PuglX11GlSurface*)view->impl->surface;
   Display* const    display = view->world->impl->display;
@@ -108,23 +384,394 @@ puglX11GlEnter(PuglView* view, const PuglExposeEvent* PUGL_UNUSED(expose))
     return PUGL_FAILURE;
   }
 
-  return glXMakeCurrent(display, view->impl->win, surface->ctx) ? PUGL_SUCCESS
-                                                                : PUGL_FAILURE;
+  // Stop any render thread so the context can be used on this thread
+  PuglX11GlRenderThread* const thread = surface->render_thread;
+  if (thread && thread->running &&
+      !pthread_equal(pthread_self(), thread->thread)) {
+    puglX11GlStopRenderThread(thread);
+  }
+
+  // Make the context current, unless it already is on this thread
+  if ((glXGetCurrentContext() != surface->ctx ||
+       glXGetCurrentDrawable() != view->impl->win) &&
+      !glXMakeCurrent(display, view->impl->win, surface->ctx)) {
+    return PUGL_FAILURE;
+  }
+
+  if (expose && surface->timer) {
+    puglX11GlBeginTimer(view, surface->timer);
+  }
+
+  return PUGL_SUCCESS;
+}
+
+/// Set the swap interval for the next swap so only one per frame waits
+static void
+puglX11GlSyncSwap(PuglView* view, PuglX11GlSurface* surface)
+{
+  PuglX11GlWorld* const gl_world = (PuglX11GlWorld*)puglX11GetBackendData(
+    view->world, view->backend);
+  if (!gl_world) {
+    return;
+  }
+
+  /* The first swap in a frame waits for a refresh as usual, then any other
+     views drawn in the same frame swap immediately afterwards.  This lets
+     several views present at once, rather than each waiting in turn. */
+  const size_t frame    = view->world->impl->numFrames;
+  const bool   waited   = gl_world->swap_frame == frame;
+  const int    interval = (waited && gl_world->n_synced_views > 1u)
+                            ? 0
+                            : surface->interval;
+
+  if (interval != surface->current_interval) {
+    surface->swap_interval(
+      view->world->impl->display, view->impl->win, interval);
+    surface->current_interval = interval;
+  }
+
+  gl_world->swap_frame = frame;
 }
 
 PUGL_WARN_UNUSED_RESULT
 static PuglStatus
 puglX11GlLeave(PuglView* view, const PuglExposeEvent* expose)
 {
-  Display* const display = view->world->impl->display;
+  PuglX11GlSurface* const surface = (PuglX11GlSurface*)view->impl->surface;
+  Display* const          display = view->world->impl->display;
 
-  if (expose && view->hints[PUGL_DOUBLE_BUFFER]) {
-    glXSwapBuffers(display, view->impl->win);
+  if (expose && surface && surface->timer) {
+    puglX11GlEndTimer(view, surface->timer);
+  }
+
+  // The render thread draws with its own snapshot of the frame
+  const PuglRect frame = (surface && surface->render_thread)
+                           ? surface->render_thread->drawFrame
+                           : view->frame;
+
+  if (expose && surface && surface->double_buffered) {
+    const bool partial = expose->x > 0 || expose->y > 0 ||
+                         expose->x + expose->width < frame.width ||
+                         expose->y + expose->height < frame.height;
+
+    if (partial && surface->copy_partial) {
+      // Only copy the exposed region to the front buffer (with a flipped Y)
+      surface->copy_sub_buffer(
+        display,
+        view->impl->win,
+        expose->x,
+        (int)frame.height - (int)expose->y - (int)expose->height,
+        (int)expose->width,
+        (int)expose->height);
+    } else {
+      if (surface->synced) {
+        puglX11GlSyncSwap(view, surface);
+      }
+
+      glXSwapBuffers(display, view->impl->win);
+    }
+  }
+
+  // Leave the context current, so entering it again doesn't need a switch
+  return PUGL_SUCCESS;
+}
+
+/// Release the context if it is current on this thread
+static PuglStatus
+puglX11GlUnbind(PuglView* view)
+{
+  const PuglX11GlSurface* surface = (PuglX11GlSurface*)view->impl->surface;
+  Display* const          display = view->world->impl->display;
+
+  if (!surface || !surface->ctx || glXGetCurrentContext() != surface->ctx) {
+    return PUGL_SUCCESS;
   }
 
   return glXMakeCurrent(display, None, NULL) ? PUGL_SUCCESS : PUGL_FAILURE;
 }
 
+/**
+   Draw events taken from the render thread.
+
+   This is like puglX11DrawView(), except the view state has already been
+   updated by the event thread, so the configure is only passed on to the
+   application here.
+*/
+static PuglStatus
+puglX11GlDrawQueued(PuglView* const        view,
+                    const PuglEvent* const configure,
+                    const PuglEvent* const expose)
+{
+  PuglStatus st0 = PUGL_SUCCESS;
+  PuglStatus st1 = PUGL_SUCCESS;
+  PuglStatus st2 = PUGL_SUCCESS;
+
+  if (expose->type) {
+    if (!(st0 = view->backend->enter(view, &expose->expose))) {
+      if (configure->type) {
+        st0 = view->eventFunc(view, configure);
+      }
+
+      st1 = puglExpose(view, expose);
+      st2 = view->backend->leave(view, &expose->expose);
+    }
+  } else if (configure->type) {
+    if (!(st0 = view->backend->enter(view, NULL))) {
+      st0 = view->eventFunc(view, configure);
+      st1 = view->backend->leave(view, NULL);
+    }
+  }
+
+  return st0 ? st0 : st1 ? st1 : st2;
+}
+
+static void*
+puglX11GlRenderThreadRun(void* const arg)
+{
+  PuglView* const              view    = (PuglView*)arg;
+  PuglX11GlSurface* const      surface = (PuglX11GlSurface*)view->impl->surface;
+  PuglX11GlRenderThread* const thread  = surface->render_thread;
+
+  pthread_mutex_lock(&thread->mutex);
+  while (!thread->exiting) {
+    if (!thread->configure.type && !thread->expose.type) {
+      pthread_cond_wait(&thread->cond, &thread->mutex);
+      continue;
+    }
+
+    // Take the latest events, and draw without holding the lock
+    const PuglEvent configure = thread->configure;
+    const PuglEvent expose    = thread->expose;
+
+    thread->configure.type = PUGL_NOTHING;
+    thread->expose.type    = PUGL_NOTHING;
+    thread->drawFrame      = thread->frame;
+
+    pthread_mutex_unlock(&thread->mutex);
+    puglX11GlDrawQueued(view, &configure, &expose);
+    pthread_mutex_lock(&thread->mutex);
+  }
+  pthread_mutex_unlock(&thread->mutex);
+
+  // Release the context so that it can be entered on other threads
+  puglX11GlUnbind(view);
+  return NULL;
+}
+
+/// Hand events to the render thread to draw, starting it if necessary
+static PuglStatus
+puglX11GlQueueDraw(PuglView* const        view,
+                   const PuglEvent* const configure,
+                   const PuglEvent* const expose)
+{
+  PuglX11GlSurface* const      surface = (PuglX11GlSurface*)view->impl->surface;
+  PuglX11GlRenderThread* const thread  = surface->render_thread;
+  PuglStatus                   st      = PUGL_SUCCESS;
+
+  pthread_mutex_lock(&thread->mutex);
+
+  // Start the thread, which will only run once the lock is released
+  if (!thread->running) {
+    if ((st = puglX11GlUnbind(view))) {
+      pthread_mutex_unlock(&thread->mutex);
+      return st;
+    }
+
+    if (pthread_create(
+          &thread->thread, NULL, puglX11GlRenderThreadRun, view)) {
+      pthread_mutex_unlock(&thread->mutex);
+      return PUGL_UNKNOWN_ERROR;
+    }
+
+    thread->running = true;
+  }
+
+  /* Update the view on this thread, so the event loop never reads state the
+     render thread is writing, and only hand over the configure to dispatch
+     along with a snapshot of the frame. */
+  if (configure->type) {
+    view->frame.x      = configure->configure.x;
+    view->frame.y      = configure->configure.y;
+    view->frame.width  = configure->configure.width;
+    view->frame.height = configure->configure.height;
+
+    if (puglMustConfigure(view, &configure->configure)) {
+      thread->configure   = *configure;
+      view->lastConfigure = configure->configure;
+    }
+  }
+
+  thread->frame = view->frame;
+
+  // Merge the pending exposed region
+
+  if (expose->type && !thread->expose.type) {
+    thread->expose = *expose;
+  } else if (expose->type) {
+    const PuglExposeEvent* const src    = &expose->expose;
+    PuglExposeEvent* const       dst    = &thread->expose.expose;
+    const int                    right  = MAX(dst->x + dst->width,
+                                              src->x + src->width);
+    const int                    bottom = MAX(dst->y + dst->height,
+                                              src->y + src->height);
+
+    dst->x      = (PuglCoord)MIN(dst->x, src->x);
+    dst->y      = (PuglCoord)MIN(dst->y, src->y);
+    dst->width  = (PuglSpan)(right - dst->x);
+    dst->height = (PuglSpan)(bottom - dst->y);
+  }
+
+  pthread_cond_signal(&thread->cond);
+  pthread_mutex_unlock(&thread->mutex);
+  return PUGL_SUCCESS;
+}
+
+/// Return whether the current context has a GL version or extension
+static bool
+puglX11GlSupports(const int major, const int minor, const char* const extension)
+{
+  // Get the version, which legacy contexts don't support querying like this
+  GLint version[2] = {0, 0};
+  glGetIntegerv(GL_MAJOR_VERSION, &version[0]);
+  glGetIntegerv(GL_MINOR_VERSION, &version[1]);
+  while (glGetError() != GL_NO_ERROR) {
+  }
+
+  if (version[0] > major || (version[0] == major && version[1] >= minor)) {
+    return true;
+  }
+
+  // Legacy contexts only support getting all extensions as a single string
+  if (version[0] < 3) {
+    const char* const extensions = (const char*)glGetString(GL_EXTENSIONS);
+    return extensions && !!strstr(extensions, extension);
+  }
+
+  PFNGLGETSTRINGIPROC get_string_i = (PFNGLGETSTRINGIPROC)glXGetProcAddress(
+    (const uint8_t*)"glGetStringi");
+
+  GLint n_extensions = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &n_extensions);
+  for (GLint i = 0; get_string_i && i < n_extensions; ++i) {
+    const char* const name =
+      (const char*)get_string_i(GL_EXTENSIONS, (GLuint)i);
+
+    if (name && !strcmp(name, extension)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static const char*
+puglX11GlDebugTypeString(const GLenum type)
+{
+  switch (type) {
+  case GL_DEBUG_TYPE_ERROR:
+    return "error";
+  case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+    return "deprecated behavior";
+  case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+    return "undefined behavior";
+  case GL_DEBUG_TYPE_PORTABILITY:
+    return "portability";
+  case GL_DEBUG_TYPE_PERFORMANCE:
+    return "performance";
+  default:
+    break;
+  }
+
+  return "message";
+}
+
+static void APIENTRY
+puglX11GlDebugCallback(const GLenum PUGL_UNUSED(source),
+                       const GLenum  type,
+                       const GLuint  PUGL_UNUSED(id),
+                       const GLenum  severity,
+                       const GLsizei PUGL_UNUSED(length),
+                       const GLchar* message,
+                       const void*   user_param)
+{
+  const PuglView* const view = (const PuglView*)user_param;
+
+  // Errors and performance warnings are reported at least as warnings
+  PuglLogLevel level = PUGL_LOG_LEVEL_DEBUG;
+  if (type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH) {
+    level = PUGL_LOG_LEVEL_ERR;
+  } else if (type == GL_DEBUG_TYPE_PERFORMANCE ||
+             severity == GL_DEBUG_SEVERITY_MEDIUM) {
+    level = PUGL_LOG_LEVEL_WARNING;
+  } else if (severity == GL_DEBUG_SEVERITY_LOW) {
+    level = PUGL_LOG_LEVEL_INFO;
+  }
+
+  char msg[1024];
+  snprintf(msg,
+           sizeof(msg),
+           "OpenGL %s: %s",
+           puglX11GlDebugTypeString(type),
+           message);
+
+  puglLog(view->world, level, msg);
+}
+
+/// Route debug messages from the current context to the world's log function
+static void
+puglX11GlSetupDebugOutput(PuglView* const view)
+{
+  if (puglX11GlSupports(4, 3, "GL_KHR_debug")) {
+    PFNGLDEBUGMESSAGECALLBACKPROC debug_message_callback =
+      (PFNGLDEBUGMESSAGECALLBACKPROC)glXGetProcAddress(
+        (const uint8_t*)"glDebugMessageCallback");
+
+    if (debug_message_callback) {
+      glEnable(GL_DEBUG_OUTPUT);
+      glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+      debug_message_callback(puglX11GlDebugCallback, view);
+    }
+  }
+}
+
+/// Set up timer queries in the current context, if supported
+static PuglStatus
+puglX11GlSetupTimer(PuglView* const view, PuglX11GlSurface* const surface)
+{
+  if (!puglX11GlSupports(3, 3, "GL_ARB_timer_query")) {
+    return PUGL_SUCCESS;
+  }
+
+  PuglX11GlTimer* const timer =
+    (PuglX11GlTimer*)puglCalloc(view->world, 1, sizeof(PuglX11GlTimer));
+  if (!timer) {
+    return PUGL_NO_MEMORY;
+  }
+
+  PFNGLGENQUERIESPROC gen_queries =
+    (PFNGLGENQUERIESPROC)glXGetProcAddress((const uint8_t*)"glGenQueries");
+
+  timer->begin_query =
+    (PFNGLBEGINQUERYPROC)glXGetProcAddress((const uint8_t*)"glBeginQuery");
+  timer->end_query =
+    (PFNGLENDQUERYPROC)glXGetProcAddress((const uint8_t*)"glEndQuery");
+  timer->get_query_iv = (PFNGLGETQUERYOBJECTIVPROC)glXGetProcAddress(
+    (const uint8_t*)"glGetQueryObjectiv");
+  timer->get_query_ui64v = (PFNGLGETQUERYOBJECTUI64VPROC)glXGetProcAddress(
+    (const uint8_t*)"glGetQueryObjectui64v");
+
+  if (!gen_queries || !timer->begin_query || !timer->end_query ||
+      !timer->get_query_iv || !timer->get_query_ui64v) {
+    puglFree(view->world, timer);
+    return PUGL_SUCCESS;
+  }
+
+  // The queries belong to the context, so are deleted along with it
+  gen_queries((GLsizei)PUGL_X11_GL_NUM_QUERIES, timer->queries);
+  surface->timer = timer;
+  return PUGL_SUCCESS;
+}
+
 static PuglStatus
 puglX11GlCreate(PuglView* view)
 {
@@ -134,6 +781,20 @@ puglX11GlCreate(PuglView* view)
   GLXFBConfig             fb_config = surface->fb_config;
   PuglStatus              st        = PUGL_SUCCESS;
 
+  // Get the context to share objects with, if any
+  GLXContext share_ctx = NULL;
+  if (view->shareView) {
+    const PuglX11GlSurface* const share_surface =
+      (const PuglX11GlSurface*)view->shareView->impl->surface;
+
+    if (view->shareView->backend != view->backend || !share_surface ||
+        !share_surface->ctx) {
+      return PUGL_CREATE_CONTEXT_FAILED;
+    }
+
+    share_ctx = share_surface->ctx;
+  }
+
   const int ctx_attrs[] = {
     GLX_CONTEXT_MAJOR_VERSION_ARB,
     view->hints[PUGL_CONTEXT_VERSION_MAJOR],
@@ -159,20 +820,38 @@ puglX11GlCreate(PuglView* view)
       (PFNGLXCREATECONTEXTATTRIBSARBPROC)glXGetProcAddress(
         (const uint8_t*)"glXCreateContextAttribsARB");
 
-    surface->ctx = create_context(display, fb_config, 0, True, ctx_attrs);
+    surface->ctx =
+      create_context(display, fb_config, share_ctx, True, ctx_attrs);
   }
 
   // If that failed, fall back to the legacy API
   if (!surface->ctx) {
     surface->ctx =
-      glXCreateNewContext(display, fb_config, GLX_RGBA_TYPE, 0, True);
+      glXCreateNewContext(display, fb_config, GLX_RGBA_TYPE, share_ctx, True);
   }
 
   if (!surface->ctx) {
     return PUGL_CREATE_CONTEXT_FAILED;
   }
 
+  // Check for extensions used for partial updates
+  surface->has_buffer_age = !!strstr(extensions, "GLX_EXT_buffer_age");
+  if (!!strstr(extensions, "GLX_MESA_copy_sub_buffer")) {
+    surface->copy_sub_buffer =
+      (PFNGLXCOPYSUBBUFFERMESAPROC)glXGetProcAddress(
+        (const uint8_t*)"glXCopySubBufferMESA");
+  }
+
+  // Check for extensions used for frame timing
+  if (!!strstr(extensions, "GLX_OML_sync_control")) {
+    surface->get_sync_values = (PFNGLXGETSYNCVALUESOMLPROC)glXGetProcAddress(
+      (const uint8_t*)"glXGetSyncValuesOML");
+    surface->wait_for_sbc = (PFNGLXWAITFORSBCOMLPROC)glXGetProcAddress(
+      (const uint8_t*)"glXWaitForSbcOML");
+  }
+
   // Set up the swap interval
+  unsigned int late_swaps_tear = 0u;
   if (!!strstr(extensions, "GLX_EXT_swap_control")) {
     PFNGLXSWAPINTERVALEXTPROC glXSwapIntervalEXT =
       (PFNGLXSWAPINTERVALEXTPROC)glXGetProcAddress(
@@ -183,28 +862,112 @@ puglX11GlCreate(PuglView* view)
       return st;
     }
 
+    // Adaptive swapping is requested with a negative swap interval
+    const bool adaptive =
+      view->hints[PUGL_ADAPTIVE_SWAP] == PUGL_TRUE &&
+      !!strstr(extensions, "GLX_EXT_swap_control_tear");
+
     // Set the swap interval if the user requested a specific value
-    if (view->hints[PUGL_SWAP_INTERVAL] != PUGL_DONT_CARE) {
-      glXSwapIntervalEXT(display, impl->win, view->hints[PUGL_SWAP_INTERVAL]);
+    const int interval = view->hints[PUGL_SWAP_INTERVAL];
+    if (interval != PUGL_DONT_CARE) {
+      glXSwapIntervalEXT(display, impl->win, adaptive ? -interval : interval);
+    } else if (adaptive) {
+      glXSwapIntervalEXT(display, impl->win, -1);
     }
 
     // Get the actual current swap interval
-    glXQueryDrawable(display,
-                     impl->win,
-                     GLX_SWAP_INTERVAL_EXT,
-                     (unsigned int*)&view->hints[PUGL_SWAP_INTERVAL]);
+    PUGL_X11_ROUND_TRIP(
+      view->world->impl,
+      glXQueryDrawable(display,
+                       impl->win,
+                       GLX_SWAP_INTERVAL_EXT,
+                       (unsigned int*)&view->hints[PUGL_SWAP_INTERVAL]));
+
+    // Get whether late swaps actually tear
+    if (adaptive) {
+      PUGL_X11_ROUND_TRIP(
+        view->world->impl,
+        glXQueryDrawable(
+          display, impl->win, GLX_LATE_SWAPS_TEAR_EXT, &late_swaps_tear));
+    }
+
+    // Remember the interval so that swaps can be coordinated with other views
+    const int actual = view->hints[PUGL_SWAP_INTERVAL];
+
+    surface->swap_interval    = glXSwapIntervalEXT;
+    surface->interval         = late_swaps_tear ? -actual : actual;
+    surface->current_interval = surface->interval;
 
     if ((st = puglX11GlLeave(view, NULL))) {
       return st;
     }
   }
 
-  return !glXGetConfig(display,
-                       impl->vi,
-                       GLX_DOUBLEBUFFER,
-                       &view->hints[PUGL_DOUBLE_BUFFER])
-           ? PUGL_SUCCESS
-           : PUGL_UNKNOWN_ERROR;
+  view->hints[PUGL_ADAPTIVE_SWAP] = late_swaps_tear ? PUGL_TRUE : PUGL_FALSE;
+
+  // Set up debug output and draw timing, which need the context to be current
+  const bool debug  = view->hints[PUGL_USE_DEBUG_CONTEXT] == PUGL_TRUE;
+  const bool timing = view->hints[PUGL_DRAW_TIMING] == PUGL_TRUE;
+  if (debug || timing) {
+    if ((st = puglX11GlEnter(view, NULL))) {
+      return st;
+    }
+
+    if (debug) {
+      puglX11GlSetupDebugOutput(view);
+    }
+
+    if (timing && (st = puglX11GlSetupTimer(view, surface))) {
+      return st;
+    }
+
+    if ((st = puglX11GlLeave(view, NULL))) {
+      return st;
+    }
+  }
+
+  view->hints[PUGL_DRAW_TIMING] = surface->timer ? PUGL_TRUE : PUGL_FALSE;
+
+  // Set up a render thread if requested and the world supports threads
+  if (view->hints[PUGL_RENDER_THREAD] == PUGL_TRUE &&
+      view->world->impl->threadSafe && !view->children.numViews) {
+    PuglX11GlRenderThread* const thread = (PuglX11GlRenderThread*)puglCalloc(
+      view->world, 1, sizeof(PuglX11GlRenderThread));
+    if (!thread) {
+      return PUGL_NO_MEMORY;
+    }
+
+    pthread_mutex_init(&thread->mutex, NULL);
+    pthread_cond_init(&thread->cond, NULL);
+    surface->render_thread = thread;
+    impl->drawFunc         = puglX11GlQueueDraw;
+  } else {
+    view->hints[PUGL_RENDER_THREAD] = PUGL_FALSE;
+  }
+
+  // Coordinate swaps with other views that wait for refreshes on this thread
+  PuglX11GlWorld* const gl_world = puglX11GlGetWorld(view);
+  if (gl_world && surface->swap_interval && surface->interval &&
+      !surface->render_thread) {
+    surface->synced = true;
+    ++gl_world->n_synced_views;
+  }
+
+  if (glXGetConfig(display,
+                   impl->vi,
+                   GLX_DOUBLEBUFFER,
+                   &view->hints[PUGL_DOUBLE_BUFFER])) {
+    return PUGL_UNKNOWN_ERROR;
+  }
+
+  /* Copy the hints used when presenting, so a render thread doesn't read
+     them.  A sub-buffer copy doesn't wait for a refresh like a swap does, so
+     it's only used for partial updates when swaps aren't synced anyway. */
+  surface->double_buffered = view->hints[PUGL_DOUBLE_BUFFER];
+  surface->copy_partial =
+    surface->copy_sub_buffer && !view->hints[PUGL_SWAP_INTERVAL];
+
+  return PUGL_SUCCESS;
 }
 
 static void
@@ -212,8 +975,25 @@ puglX11GlDestroy(PuglView* view)
 {
   PuglX11GlSurface* surface = (PuglX11GlSurface*)view->impl->surface;
   if (surface) {
+    if (surface->render_thread) {
+      puglX11GlStopRenderThread(surface->render_thread);
+      pthread_cond_destroy(&surface->render_thread->cond);
+      pthread_mutex_destroy(&surface->render_thread->mutex);
+      puglFree(view->world, surface->render_thread);
+      view->impl->drawFunc = NULL;
+    }
+
+    if (surface->synced) {
+      PuglX11GlWorld* const gl_world = (PuglX11GlWorld*)puglX11GetBackendData(
+        view->world, view->backend);
+
+      --gl_world->n_synced_views;
+    }
+
+    puglX11GlUnbind(view);
     glXDestroyContext(view->world->impl->display, surface->ctx);
-    free(surface);
+    puglFree(view->world, surface->timer);
+    puglFree(view->world, surface);
     view->impl->surface = NULL;
   }
 }
@@ -221,9 +1001,127 @@ puglX11GlDestroy(PuglView* view)
 PuglGlFunc
 puglGetProcAddress(const char* name)
 {
+#ifdef HAVE_EGL
+  const PuglGlFunc egl_func = puglX11EglGetProcAddress(name);
+  if (egl_func) {
+    return egl_func;
+  }
+#endif
+
   return glXGetProcAddress((const uint8_t*)name);
 }
 
+unsigned
+puglGetBufferAge(PuglView* view)
+{
+#ifdef HAVE_EGL
+  if (puglX11EglIsBackend(view->backend)) {
+    return puglX11EglGetBufferAge(view);
+  }
+#endif
+
+  const PuglX11GlSurface* surface = (PuglX11GlSurface*)view->impl->surface;
+  unsigned int            age     = 0u;
+
+  if (surface && surface->has_buffer_age) {
+    PUGL_X11_ROUND_TRIP(view->world->impl,
+                        glXQueryDrawable(view->world->impl->display,
+                                         view->impl->win,
+                                         GLX_BACK_BUFFER_AGE_EXT,
+                                         &age));
+  }
+
+  return age;
+}
+
+PuglStatus
+puglGetFrameTiming(PuglView* view, PuglFrameTiming* timing)
+{
+#ifdef HAVE_EGL
+  if (puglX11EglIsBackend(view->backend)) {
+    return PUGL_UNSUPPORTED;
+  }
+#endif
+
+  PuglX11GlSurface* const surface = (PuglX11GlSurface*)view->impl->surface;
+  Display* const          display = view->world->impl->display;
+  if (!surface || !surface->get_sync_values || !surface->wait_for_sbc) {
+    return PUGL_UNSUPPORTED;
+  }
+
+  // Get the number of completed swaps, then when the last one was shown
+  int64_t ust = 0;
+  int64_t msc = 0;
+  int64_t sbc = 0;
+  if (!surface->get_sync_values(display, view->impl->win, &ust, &msc, &sbc) ||
+      (sbc && !surface->wait_for_sbc(
+                display, view->impl->win, sbc, &ust, &msc, &sbc))) {
+    return PUGL_UNKNOWN_ERROR;
+  }
+
+  /* OML_sync_control doesn't specify the clock of the UST, but GLX
+     implementations on Linux use microseconds on CLOCK_MONOTONIC, the clock
+     used by puglGetTime().  A frame shown in the future means otherwise. */
+  const double time = ((double)ust / 1000000.0) - view->world->startTime;
+  if (time > puglGetTime(view->world) + 1.0) {
+    return PUGL_UNSUPPORTED;
+  }
+
+  // Count any extra refreshes between frames since the last query as missed
+  uint32_t missed = 0u;
+  if (surface->last_sbc && sbc > surface->last_sbc) {
+    const int     interval = view->hints[PUGL_SWAP_INTERVAL];
+    const int64_t expected =
+      (sbc - surface->last_sbc) * (interval > 1 ? interval : 1);
+    const int64_t elapsed = msc - surface->last_msc;
+
+    missed = elapsed > expected ? (uint32_t)(elapsed - expected) : 0u;
+  }
+
+  surface->last_msc = msc;
+  surface->last_sbc = sbc;
+
+  timing->time   = time;
+  timing->msc    = (uint64_t)msc;
+  timing->sbc    = (uint64_t)sbc;
+  timing->missed = missed;
+  return PUGL_SUCCESS;
+}
+
+PuglStatus
+puglGetDrawTiming(PuglView* view, PuglDrawTiming* timing)
+{
+#ifdef HAVE_EGL
+  if (puglX11EglIsBackend(view->backend)) {
+    return PUGL_UNSUPPORTED;
+  }
+#endif
+
+  const PuglX11GlSurface* const surface =
+    (const PuglX11GlSurface*)view->impl->surface;
+  if (!surface || !surface->timer) {
+    return PUGL_UNSUPPORTED;
+  }
+
+  if (!surface->timer->latest.frame) {
+    return PUGL_FAILURE;
+  }
+
+  *timing = surface->timer->latest;
+  return PUGL_SUCCESS;
+}
+
+PuglStatus
+puglSetShareView(PuglView* view, PuglView* shareView)
+{
+  if (view->impl->surface) {
+    return PUGL_FAILURE;
+  }
+
+  view->shareView = shareView;
+  return PUGL_SUCCESS;
+}
+
 PuglStatus
 puglEnterContext(PuglView* view)
 {
@@ -233,7 +1131,18 @@ puglEnterContext(PuglView* view)
 PuglStatus
 puglLeaveContext(PuglView* view)
 {
-  return view->backend->leave(view, NULL);
+  const PuglStatus st = view->backend->leave(view, NULL);
+  if (st) {
+    return st;
+  }
+
+#ifdef HAVE_EGL
+  if (puglX11EglIsBackend(view->backend)) {
+    return puglX11EglUnbind(view);
+  }
+#endif
+
+  return puglX11GlUnbind(view);
 }
 
 const PuglBackend*
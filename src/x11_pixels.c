@@ -0,0 +1,508 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "allocator.h"
+#include "types.h"
+#include "x11.h"
+
+#include "pugl/pixels.h"
+#include "pugl/pugl.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xresource.h>
+#include <X11/Xutil.h>
+
+#ifdef HAVE_XSHM
+#  include <X11/extensions/XShm.h>
+#  include <sys/ipc.h>
+#  include <sys/shm.h>
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+  PuglPixelBuffer buffer;
+  XImage*         image;
+  GC              gc;
+  PuglRect        exposed; ///< Region of the current expose
+  bool            drawing; ///< True while handling an expose
+  bool            drawn;   ///< True if the buffer was drawn during an expose
+#ifdef HAVE_XSHM
+  XShmSegmentInfo shmInfo;
+  unsigned long   putSerial; ///< Request number of a pending put, or 0
+  bool            shmImage;  ///< True if the image is in shared memory
+#endif
+} PuglX11PixelsSurface;
+
+#ifdef HAVE_XSHM
+
+/// Shared memory state for the display of a world
+typedef struct {
+  Display* display;
+  int      completionType; ///< Type of shared image completion events
+  bool     attachFailed;   ///< True if the server failed to attach a segment
+} PuglX11PixelsShm;
+
+/// A shared image completion event to wait for
+typedef struct {
+  Window window;
+  int    completionType;
+} PuglX11PixelsCompletion;
+
+/// Return the context used to find the shared memory state of a display
+static XContext
+puglX11PixelsShmContext(void)
+{
+  return XStringToContext("PuglX11PixelsShm");
+}
+
+static int
+puglX11ShmErrorHandler(Display* const display, XErrorEvent* const event)
+{
+  XPointer data = NULL;
+
+  (void)event;
+
+  if (!XFindContext(display,
+                    DefaultRootWindow(display),
+                    puglX11PixelsShmContext(),
+                    &data)) {
+    ((PuglX11PixelsShm*)(void*)data)->attachFailed = true;
+  }
+
+  return 0;
+}
+
+static void
+puglX11PixelsFreeShm(PuglWorld* const world, void* const data)
+{
+  PuglX11PixelsShm* const shm = (PuglX11PixelsShm*)data;
+
+  if (shm) {
+    XDeleteContext(shm->display,
+                   DefaultRootWindow(shm->display),
+                   puglX11PixelsShmContext());
+    puglFree(world, shm);
+  }
+}
+
+/// Return the shared memory state of the world, or null if unsupported
+static PuglX11PixelsShm*
+puglX11PixelsGetShm(PuglWorld* const world)
+{
+  const PuglBackend* const backend = puglPixelsBackend();
+  Display* const           display = world->impl->display;
+
+  PuglX11PixelsShm* shm =
+    (PuglX11PixelsShm*)puglX11GetBackendData(world, backend);
+  if (shm) {
+    return shm;
+  }
+
+  if (!PUGL_X11_ROUND_TRIP(world->impl, XShmQueryExtension(display)) ||
+      !(shm = (PuglX11PixelsShm*)puglCalloc(
+          world, 1, sizeof(PuglX11PixelsShm)))) {
+    return NULL;
+  }
+
+  // Associate the state with the display so the error handler can find it
+  shm->display        = display;
+  shm->completionType = XShmGetEventBase(display) + ShmCompletion;
+  if (XSaveContext(display,
+                   DefaultRootWindow(display),
+                   puglX11PixelsShmContext(),
+                   (XPointer)(void*)shm)) {
+    puglFree(world, shm);
+    return NULL;
+  }
+
+  if (puglX11SetBackendData(world, backend, shm, puglX11PixelsFreeShm)) {
+    puglX11PixelsFreeShm(world, shm);
+    return NULL;
+  }
+
+  return shm;
+}
+
+/// Return true if `event` is the shared image completion `arg`
+static Bool
+puglX11PixelsIsCompletion(Display* const display,
+                          XEvent* const  event,
+                          XPointer const arg)
+{
+  const PuglX11PixelsCompletion* const completion =
+    (const PuglX11PixelsCompletion*)(const void*)arg;
+
+  (void)display;
+
+  return event->type == completion->completionType &&
+         event->xany.window == completion->window;
+}
+
+/// Wait for the server to finish reading the image, if it hasn't already
+static void
+puglX11PixelsWaitForPut(PuglView* const             view,
+                        PuglX11PixelsSurface* const surface)
+{
+  if (!surface->putSerial) {
+    return;
+  }
+
+  Display* const          display    = view->world->impl->display;
+  PuglX11PixelsShm* const shm        = puglX11PixelsGetShm(view->world);
+  PuglX11PixelsCompletion completion = {view->impl->win, shm->completionType};
+  XEvent                  event;
+
+  // Discard any completions that have been received, without blocking
+  while (XCheckIfEvent(display,
+                       &event,
+                       puglX11PixelsIsCompletion,
+                       (XPointer)(void*)&completion)) {
+  }
+
+  /* The server reads the image while processing the put request, so if
+     anything since has been received, it's done.  Otherwise, the completion
+     for the put is the next one to arrive. */
+  if (LastKnownRequestProcessed(display) < surface->putSerial) {
+    XIfEvent(display,
+             &event,
+             puglX11PixelsIsCompletion,
+             (XPointer)(void*)&completion);
+  }
+
+  surface->putSerial = 0u;
+}
+
+/// Create an image in memory shared with the server, if possible
+static XImage*
+puglX11PixelsCreateShmImage(PuglView* const             view,
+                            PuglX11PixelsSurface* const surface,
+                            const PuglSpan              width,
+                            const PuglSpan              height)
+{
+  Display* const          display = view->world->impl->display;
+  XVisualInfo* const      vi      = view->impl->vi;
+  XShmSegmentInfo*        info    = &surface->shmInfo;
+  PuglX11PixelsShm* const shm     = puglX11PixelsGetShm(view->world);
+
+  if (!shm) {
+    return NULL;
+  }
+
+  XImage* const image = XShmCreateImage(display,
+                                        vi->visual,
+                                        (unsigned)vi->depth,
+                                        ZPixmap,
+                                        NULL,
+                                        info,
+                                        width,
+                                        height);
+  if (!image) {
+    return NULL;
+  }
+
+  const size_t size = (size_t)image->bytes_per_line * (size_t)image->height;
+  if ((info->shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600)) < 0) {
+    XDestroyImage(image);
+    return NULL;
+  }
+
+  info->shmaddr = image->data = (char*)shmat(info->shmid, NULL, 0);
+  info->readOnly = False;
+  if (info->shmaddr == (char*)-1) {
+    shmctl(info->shmid, IPC_RMID, NULL);
+    XDestroyImage(image);
+    return NULL;
+  }
+
+  // Attach the segment, which fails (asynchronously) on remote displays
+  XErrorHandler const oldHandler = XSetErrorHandler(puglX11ShmErrorHandler);
+  shm->attachFailed              = false;
+  XShmAttach(display, info);
+  PUGL_X11_ROUND_TRIP(view->world->impl, XSync(display, False));
+  XSetErrorHandler(oldHandler);
+
+  // Mark the segment for removal, which happens once both sides detach
+  shmctl(info->shmid, IPC_RMID, NULL);
+
+  if (shm->attachFailed) {
+    shmdt(info->shmaddr);
+    XDestroyImage(image);
+    return NULL;
+  }
+
+  return image;
+}
+
+#endif
+
+/// Destroy an image with pixel data allocated by the world
+static void
+puglX11PixelsDestroyImage(const PuglWorld* const world, XImage* const image)
+{
+  // Detach the data so Xlib doesn't free it with its own allocator
+  puglFree(world, image->data);
+  image->data = NULL;
+  XDestroyImage(image);
+}
+
+static void
+puglX11PixelsFreeImage(PuglView* const view)
+{
+  PuglX11PixelsSurface* const surface =
+    (PuglX11PixelsSurface*)view->impl->surface;
+
+  if (!surface->image) {
+    return;
+  }
+
+#ifdef HAVE_XSHM
+  if (surface->shmImage) {
+    Display* const display = view->world->impl->display;
+
+    XShmDetach(display, &surface->shmInfo);
+    PUGL_X11_ROUND_TRIP(view->world->impl, XSync(display, False));
+    XDestroyImage(surface->image);
+    shmdt(surface->shmInfo.shmaddr);
+    surface->putSerial = 0u;
+    surface->shmImage  = false;
+  } else {
+    puglX11PixelsDestroyImage(view->world, surface->image);
+  }
+#else
+  puglX11PixelsDestroyImage(view->world, surface->image);
+#endif
+
+  surface->image         = NULL;
+  surface->buffer.data   = NULL;
+  surface->buffer.width  = 0u;
+  surface->buffer.height = 0u;
+}
+
+/// Create the image to draw to, which replaces any existing one
+static PuglStatus
+puglX11PixelsCreateImage(PuglView* const view,
+                         const PuglSpan  width,
+                         const PuglSpan  height)
+{
+  Display* const              display = view->world->impl->display;
+  XVisualInfo* const          vi      = view->impl->vi;
+  PuglX11PixelsSurface* const surface =
+    (PuglX11PixelsSurface*)view->impl->surface;
+
+  puglX11PixelsFreeImage(view);
+
+#ifdef HAVE_XSHM
+  surface->image    = puglX11PixelsCreateShmImage(view, surface, width, height);
+  surface->shmImage = !!surface->image;
+#endif
+
+  if (!surface->image) {
+    const size_t stride = (size_t)width * 4u;
+    void* const  data   = puglCalloc(view->world, (size_t)height, stride);
+    if (!data) {
+      return PUGL_NO_MEMORY;
+    }
+
+    if (!(surface->image = XCreateImage(display,
+                                        vi->visual,
+                                        (unsigned)vi->depth,
+                                        ZPixmap,
+                                        0,
+                                        (char*)data,
+                                        width,
+                                        height,
+                                        32,
+                                        (int)stride))) {
+      puglFree(view->world, data);
+      return PUGL_CREATE_CONTEXT_FAILED;
+    }
+  }
+
+  if (surface->image->bits_per_pixel != 32) {
+    puglX11PixelsFreeImage(view);
+    return PUGL_BAD_CONFIGURATION;
+  }
+
+  surface->buffer.data   = (uint32_t*)(void*)surface->image->data;
+  surface->buffer.stride = (size_t)surface->image->bytes_per_line;
+  surface->buffer.width  = width;
+  surface->buffer.height = height;
+  return PUGL_SUCCESS;
+}
+
+static PuglStatus
+puglX11PixelsCreate(PuglView* view)
+{
+  PuglInternals* const impl    = view->impl;
+  Display* const       display = view->world->impl->display;
+  const XVisualInfo*   vi      = impl->vi;
+
+  // Only visuals with the same layout as native-endian ARGB32 are supported
+  const uint32_t one      = 1u;
+  const int      hostByte = *(const uint8_t*)&one ? LSBFirst : MSBFirst;
+  if ((vi->depth != 24 && vi->depth != 32) || vi->red_mask != 0xFF0000 ||
+      vi->green_mask != 0xFF00 || vi->blue_mask != 0xFF ||
+      ImageByteOrder(display) != hostByte) {
+    return PUGL_BAD_CONFIGURATION;
+  }
+
+  PuglX11PixelsSurface* const surface = (PuglX11PixelsSurface*)puglCalloc(
+    view->world, 1, sizeof(PuglX11PixelsSurface));
+  if (!surface) {
+    return PUGL_NO_MEMORY;
+  }
+
+  impl->surface = (PuglSurface*)surface;
+  surface->gc   = XCreateGC(display, impl->win, 0, NULL);
+  return PUGL_SUCCESS;
+}
+
+static void
+puglX11PixelsDestroy(PuglView* view)
+{
+  PuglInternals* const        impl    = view->impl;
+  PuglX11PixelsSurface* const surface = (PuglX11PixelsSurface*)impl->surface;
+
+  if (surface) {
+    puglX11PixelsFreeImage(view);
+    XFreeGC(view->world->impl->display, surface->gc);
+    puglFree(view->world, surface);
+    impl->surface = NULL;
+  }
+}
+
+static PuglStatus
+puglX11PixelsEnter(PuglView* view, const PuglExposeEvent* expose)
+{
+  PuglX11PixelsSurface* const surface =
+    (PuglX11PixelsSurface*)view->impl->surface;
+
+  if (expose) {
+#ifdef HAVE_XSHM
+    puglX11PixelsWaitForPut(view, surface);
+#endif
+
+    surface->exposed.x      = expose->x;
+    surface->exposed.y      = expose->y;
+    surface->exposed.width  = expose->width;
+    surface->exposed.height = expose->height;
+    surface->drawing        = true;
+    surface->drawn          = false;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static PuglStatus
+puglX11PixelsLeave(PuglView* view, const PuglExposeEvent* expose)
+{
+  PuglInternals* const        impl    = view->impl;
+  Display* const              display = view->world->impl->display;
+  PuglX11PixelsSurface* const surface = (PuglX11PixelsSurface*)impl->surface;
+  const PuglRect              damage  = surface->buffer.damage;
+
+  if (!expose || !surface->drawn || !damage.width || !damage.height) {
+    surface->drawing = false;
+    return PUGL_SUCCESS;
+  }
+
+  // Present only the damaged region of the image
+#ifdef HAVE_XSHM
+  if (surface->shmImage) {
+    surface->putSerial = NextRequest(display);
+    XShmPutImage(display,
+                 impl->win,
+                 surface->gc,
+                 surface->image,
+                 damage.x,
+                 damage.y,
+                 damage.x,
+                 damage.y,
+                 damage.width,
+                 damage.height,
+                 True);
+
+    surface->drawing = false;
+    return PUGL_SUCCESS;
+  }
+#endif
+
+  XPutImage(display,
+            impl->win,
+            surface->gc,
+            surface->image,
+            damage.x,
+            damage.y,
+            damage.x,
+            damage.y,
+            damage.width,
+            damage.height);
+
+  surface->drawing = false;
+  return PUGL_SUCCESS;
+}
+
+static void*
+puglX11PixelsGetContext(PuglView* view)
+{
+  PuglX11PixelsSurface* const surface =
+    (PuglX11PixelsSurface*)view->impl->surface;
+
+  if (!surface || !surface->drawing) {
+    return NULL;
+  }
+
+  // (Re)create the image now, since the view may have just been configured
+  PuglPixelBuffer* const buffer = &surface->buffer;
+  const PuglSpan         width  = view->frame.width;
+  const PuglSpan         height = view->frame.height;
+  if (!surface->image || buffer->width != width || buffer->height != height) {
+    if (!width || !height || puglX11PixelsCreateImage(view, width, height)) {
+      return NULL;
+    }
+
+    // The previous contents are gone, so everything must be drawn
+    surface->exposed.x      = 0;
+    surface->exposed.y      = 0;
+    surface->exposed.width  = width;
+    surface->exposed.height = height;
+  }
+
+  // Clip the damaged region to the buffer
+  const PuglRect exposed = surface->exposed;
+  const int      x0      = exposed.x > 0 ? exposed.x : 0;
+  const int      y0      = exposed.y > 0 ? exposed.y : 0;
+  const int      ex1     = exposed.x + (int)exposed.width;
+  const int      ey1     = exposed.y + (int)exposed.height;
+  const int      x1      = ex1 < (int)width ? ex1 : (int)width;
+  const int      y1      = ey1 < (int)height ? ey1 : (int)height;
+
+  if (x1 > x0 && y1 > y0) {
+    buffer->damage.x      = (PuglCoord)x0;
+    buffer->damage.y      = (PuglCoord)y0;
+    buffer->damage.width  = (PuglSpan)(x1 - x0);
+    buffer->damage.height = (PuglSpan)(y1 - y0);
+  } else {
+    buffer->damage.width  = 0u;
+    buffer->damage.height = 0u;
+  }
+
+  surface->drawn = true;
+  return buffer;
+}
+
+const PuglBackend*
+puglPixelsBackend(void)
+{
+  static const PuglBackend backend = {puglX11Configure,
+                                      puglX11PixelsCreate,
+                                      puglX11PixelsDestroy,
+                                      puglX11PixelsEnter,
+                                      puglX11PixelsLeave,
+                                      puglX11PixelsGetContext};
+
+  return &backend;
+}
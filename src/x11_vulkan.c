@@ -3,6 +3,7 @@
 
 #define VK_NO_PROTOTYPES 1
 
+#include "allocator.h"
 #include "attributes.h"
 #include "stub.h"
 #include "types.h"
@@ -16,41 +17,79 @@
 
 #include <dlfcn.h>
 
+#include <stddef.h>
 #include <stdint.h>
-#include <stdlib.h>
 
 struct PuglVulkanLoaderImpl {
+  PuglAllocator             allocator; ///< Allocator of the creating world
+  PuglWorld*                world;
   void*                     libvulkan;
   PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
   PFN_vkGetDeviceProcAddr   vkGetDeviceProcAddr;
+  size_t                    refs;
 };
 
+static void
+puglX11VulkanDetachLoader(PuglWorld* PUGL_UNUSED(world), void* const data)
+{
+  // The world is being freed, but the loader may still be in use
+  PuglVulkanLoader* const loader = (PuglVulkanLoader*)data;
+  if (loader) {
+    loader->world = NULL;
+  }
+}
+
 PuglVulkanLoader*
-puglNewVulkanLoader(PuglWorld* PUGL_UNUSED(world))
+puglNewVulkanLoader(PuglWorld* const world)
 {
-  PuglVulkanLoader* const loader =
-    (PuglVulkanLoader*)calloc(1, sizeof(PuglVulkanLoader));
+  // Share one loader between everything that uses Vulkan in the world
+  PuglVulkanLoader* loader =
+    (PuglVulkanLoader*)puglX11GetBackendData(world, puglVulkanBackend());
+  if (loader) {
+    ++loader->refs;
+    return loader;
+  }
 
-  if (!loader || !(loader->libvulkan = dlopen("libvulkan.so", RTLD_LAZY))) {
-    free(loader);
+  // Prefer the versioned runtime library, since the other is only for linking
+  if (!(loader = (PuglVulkanLoader*)puglCalloc(
+          world, 1, sizeof(PuglVulkanLoader))) ||
+      (!(loader->libvulkan = dlopen("libvulkan.so.1", RTLD_LAZY)) &&
+       !(loader->libvulkan = dlopen("libvulkan.so", RTLD_LAZY)))) {
+    puglFree(world, loader);
     return NULL;
   }
 
+  // The loader may outlive the world, so keep a copy of its allocator
+  loader->allocator = world->allocator;
+
   loader->vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)dlsym(
     loader->libvulkan, "vkGetInstanceProcAddr");
 
   loader->vkGetDeviceProcAddr =
     (PFN_vkGetDeviceProcAddr)dlsym(loader->libvulkan, "vkGetDeviceProcAddr");
 
+  loader->refs = 1u;
+  if (!puglX11SetBackendData(
+        world, puglVulkanBackend(), loader, puglX11VulkanDetachLoader)) {
+    loader->world = world; // Otherwise, this loader just isn't shared
+  }
+
   return loader;
 }
 
 void
 puglFreeVulkanLoader(PuglVulkanLoader* loader)
 {
-  if (loader) {
+  if (loader && !--loader->refs) {
+    if (loader->world) {
+      puglX11SetBackendData(
+        loader->world, puglVulkanBackend(), NULL, puglX11VulkanDetachLoader);
+    }
+
+    const PuglAllocator allocator = loader->allocator;
+
     dlclose(loader->libvulkan);
-    free(loader);
+    allocator.freeFunc(allocator.handle, loader);
   }
 }
 
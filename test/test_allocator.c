@@ -0,0 +1,207 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests custom allocators.
+
+  This creates a world with an allocator that counts allocations, uses it
+  with a view in ways that allocate memory, and checks that everything was
+  allocated by the allocator and freed when the world was freed.  The same is
+  then done with an allocator that fails after a given number of allocations,
+  increasing the limit until everything succeeds, to check that failures are
+  handled without crashing or leaking.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/pugl.h"
+#include "pugl/stub.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct {
+  size_t numAllocations; ///< Total number of allocations made
+  size_t numLive;        ///< Number of allocations not yet freed
+  size_t numAttempts;    ///< Number of allocations and reallocations tried
+  size_t maxAttempts;    ///< Number of attempts that succeed before failing
+} CountingAllocator;
+
+static bool
+shouldFail(CountingAllocator* const counter)
+{
+  return ++counter->numAttempts > counter->maxAttempts;
+}
+
+static void*
+countingCalloc(void* const handle, const size_t count, const size_t size)
+{
+  CountingAllocator* const counter = (CountingAllocator*)handle;
+  if (shouldFail(counter)) {
+    return NULL;
+  }
+
+  void* const ptr = calloc(count, size);
+
+  if (ptr) {
+    ++counter->numAllocations;
+    ++counter->numLive;
+  }
+
+  return ptr;
+}
+
+static void*
+countingRealloc(void* const handle, void* const ptr, const size_t size)
+{
+  CountingAllocator* const counter = (CountingAllocator*)handle;
+
+  if (ptr && !size) {
+    --counter->numLive;
+    free(ptr);
+    return NULL;
+  }
+
+  if (shouldFail(counter)) {
+    return NULL;
+  }
+
+  void* const newPtr = realloc(ptr, size);
+  if (newPtr && !ptr) {
+    ++counter->numAllocations;
+    ++counter->numLive;
+  }
+
+  return newPtr;
+}
+
+static void
+countingFree(void* const handle, void* const ptr)
+{
+  CountingAllocator* const counter = (CountingAllocator*)handle;
+
+  if (ptr) {
+    assert(counter->numLive > 0u);
+    --counter->numLive;
+    free(ptr);
+  }
+}
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  (void)view;
+  (void)event;
+  return PUGL_SUCCESS;
+}
+
+static bool
+onIdle(PuglWorld* const world, void* const data)
+{
+  (void)world;
+  (void)data;
+  return true;
+}
+
+static bool
+useWorld(const PuglAllocator* const allocator)
+{
+  PuglWorld* const world =
+    puglNewWorldWithAllocator(PUGL_PROGRAM, 0, allocator);
+  if (!world) {
+    return false;
+  }
+
+  PuglView* const view = puglNewView(world);
+  if (!view) {
+    puglFreeWorld(world);
+    return false;
+  }
+
+  puglSetClassName(world, "PuglTest");
+  puglSetWindowTitle(view, "Pugl Allocator Test");
+  puglSetBackend(view, puglStubBackend());
+  puglSetEventFunc(view, onEvent);
+  puglSetSizeHint(view, PUGL_DEFAULT_SIZE, 256, 256);
+
+  // Stop at the first failure (timers may be unsupported regardless)
+  const bool succeeded =
+    !puglRealize(view) && puglNewVirtualView(view) &&
+    !puglAddIdleTask(world, onIdle, NULL) &&
+    !puglSetClipboard(view, "text/plain", "Allocated", 10) &&
+    puglStartTimer(view, 1, 1.0) != PUGL_NO_MEMORY && !puglUpdate(world, 0.0);
+
+  puglFreeView(view);
+  puglFreeWorld(world);
+  return succeeded;
+}
+
+int
+main(int argc, char** argv)
+{
+  CountingAllocator counter   = {0u, 0u, 0u, SIZE_MAX};
+  PuglAllocator     allocator = {
+    countingCalloc, countingRealloc, countingFree, &counter};
+
+  PuglTestOptions opts = puglParseTestOptions(&argc, &argv);
+  (void)opts;
+
+  // Check that an incomplete allocator is rejected
+  const PuglAllocator incomplete = {countingCalloc, NULL, countingFree, NULL};
+  assert(!puglNewWorldWithAllocator(PUGL_PROGRAM, 0, &incomplete));
+
+  // Create a world, which is itself allocated with the allocator
+  PuglWorld* const world =
+    puglNewWorldWithAllocator(PUGL_PROGRAM, 0, &allocator);
+  assert(world);
+  assert(counter.numAllocations > 0u);
+
+  // Set up and realize a view
+  PuglView* const view = puglNewView(world);
+  puglSetClassName(world, "PuglTest");
+  puglSetWindowTitle(view, "Pugl Allocator Test");
+  puglSetBackend(view, puglStubBackend());
+  puglSetEventFunc(view, onEvent);
+  puglSetSizeHint(view, PUGL_DEFAULT_SIZE, 256, 256);
+  assert(!puglRealize(view));
+
+  // Do various things that allocate memory
+  PuglVirtualView* const child = puglNewVirtualView(view);
+  assert(child);
+  assert(!puglAddIdleTask(world, onIdle, NULL));
+  assert(!puglSetClipboard(view, "text/plain", "Allocated", 10));
+  puglStartTimer(view, 1, 1.0);
+  puglSetWindowTitle(view, "Pugl Allocator Test Again");
+  assert(!puglUpdate(world, 0.0));
+
+  const size_t numAllocations = counter.numAllocations;
+  assert(counter.numLive > 0u);
+
+  // Tear down, which must free everything allocated
+  puglStopTimer(view, 1);
+  puglFreeVirtualView(child);
+  puglFreeView(view);
+  puglFreeWorld(world);
+
+  assert(counter.numAllocations == numAllocations);
+  assert(!counter.numLive);
+
+  // Fail at every allocation in turn, which must not crash or leak
+  bool succeeded = false;
+  for (size_t maxAttempts = 0u; !succeeded; ++maxAttempts) {
+    CountingAllocator   failing          = {0u, 0u, 0u, maxAttempts};
+    const PuglAllocator failingAllocator = {
+      countingCalloc, countingRealloc, countingFree, &failing};
+
+    assert(maxAttempts <= counter.numAttempts);
+    succeeded = useWorld(&failingAllocator);
+    assert(!failing.numLive);
+  }
+
+  return 0;
+}
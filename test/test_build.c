@@ -7,10 +7,12 @@
 
 #define PUGL_DISABLE_DEPRECATED
 
-#include "pugl/cairo.h" // IWYU pragma: keep
-#include "pugl/gl.h"    // IWYU pragma: keep
-#include "pugl/pugl.h"  // IWYU pragma: keep
-#include "pugl/stub.h"  // IWYU pragma: keep
+#include "pugl/cairo.h"  // IWYU pragma: keep
+#include "pugl/gl.h"     // IWYU pragma: keep
+#include "pugl/pixels.h" // IWYU pragma: keep
+#include "pugl/pugl.h"   // IWYU pragma: keep
+#include "pugl/remote.h" // IWYU pragma: keep
+#include "pugl/stub.h"   // IWYU pragma: keep
 
 int
 main(void)
@@ -7,11 +7,12 @@
 
 #define PUGL_DISABLE_DEPRECATED
 
-#include "pugl/cairo.hpp" // IWYU pragma: keep
-#include "pugl/gl.hpp"    // IWYU pragma: keep
-#include "pugl/pugl.h"    // IWYU pragma: keep
-#include "pugl/pugl.hpp"  // IWYU pragma: keep
-#include "pugl/stub.hpp"  // IWYU pragma: keep
+#include "pugl/cairo.hpp"  // IWYU pragma: keep
+#include "pugl/gl.hpp"     // IWYU pragma: keep
+#include "pugl/pixels.hpp" // IWYU pragma: keep
+#include "pugl/pugl.h"     // IWYU pragma: keep
+#include "pugl/pugl.hpp"   // IWYU pragma: keep
+#include "pugl/stub.hpp"   // IWYU pragma: keep
 
 int
 main()
@@ -0,0 +1,156 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests retained Cairo layers.
+
+  This checks that layers are only drawn again after they are invalidated,
+  while every expose still composites them and dispatches the expose event.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/cairo.h"
+#include "pugl/pugl.h"
+
+#include <cairo.h>
+
+#include <assert.h>
+#include <stdio.h>
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  unsigned        numBackgroundDraws;
+  unsigned        numLabelDraws;
+  unsigned        numExposures;
+} PuglTest;
+
+static void
+onDrawBackground(PuglView* const view, void* const context)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+  cairo_t* const  cr   = (cairo_t*)context;
+
+  cairo_set_source_rgb(cr, 0.0, 0.0, 0.5);
+  cairo_paint(cr);
+  ++test->numBackgroundDraws;
+}
+
+static void
+onDrawLabels(PuglView* const view, void* const context)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+  cairo_t* const  cr   = (cairo_t*)context;
+
+  cairo_move_to(cr, 16.0, 32.0);
+  cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+  cairo_show_text(cr, "Pugl");
+  ++test->numLabelDraws;
+}
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    // Layers are drawn before the expose, which draws on top of them
+    cairo_t* const cr = (cairo_t*)puglGetContext(view);
+    assert(cr);
+
+    cairo_rectangle(cr, 64.0, 64.0, 32.0, 32.0);
+    cairo_set_source_rgb(cr, 0.0, 1.0, 0.0);
+    cairo_fill(cr);
+    ++test->numExposures;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+/// Redraw the view and wait until it has been exposed
+static void
+redraw(PuglTest* const test)
+{
+  const unsigned numExposures = test->numExposures;
+
+  assert(!puglPostRedisplay(test->view));
+  while (test->numExposures == numExposures) {
+    assert(!puglUpdate(test->world, -1.0));
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest test = {puglNewWorld(PUGL_PROGRAM, 0),
+                   NULL,
+                   puglParseTestOptions(&argc, &argv),
+                   0u,
+                   0u,
+                   0u};
+
+  // Layers can only be added to views that use the Cairo backend
+  test.view = puglNewView(test.world);
+  assert(puglAddCairoLayer(test.view, "background", onDrawBackground) ==
+         PUGL_BAD_BACKEND);
+
+  // Set up and realize view
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl Cairo Layers Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglCairoBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 256, 256);
+  assert(!puglRealize(test.view));
+
+  // Add layers and check that names are looked up
+  assert(!puglAddCairoLayer(test.view, "background", onDrawBackground));
+  assert(!puglAddCairoLayer(test.view, "labels", onDrawLabels));
+  assert(puglInvalidateCairoLayer(test.view, "missing") == PUGL_BAD_PARAMETER);
+  assert(puglRemoveCairoLayer(test.view, "missing") == PUGL_BAD_PARAMETER);
+
+  // Show the view, which draws every layer once
+  assert(!puglShow(test.view));
+  while (!test.numExposures) {
+    assert(!puglUpdate(test.world, -1.0));
+  }
+
+  assert(test.numBackgroundDraws == 1u);
+  assert(test.numLabelDraws == 1u);
+
+  // Redraw without invalidating, which only composites the layers
+  redraw(&test);
+  assert(test.numBackgroundDraws == 1u);
+  assert(test.numLabelDraws == 1u);
+
+  // Invalidate only the labels, which redraws only that layer
+  assert(!puglInvalidateCairoLayer(test.view, "labels"));
+  redraw(&test);
+  assert(test.numBackgroundDraws == 1u);
+  assert(test.numLabelDraws == 2u);
+
+  // Remove the background, after which it's never drawn again
+  assert(!puglRemoveCairoLayer(test.view, "background"));
+  assert(!puglInvalidateCairoLayer(test.view, "labels"));
+  redraw(&test);
+  assert(test.numBackgroundDraws == 1u);
+  assert(test.numLabelDraws == 3u);
+
+  if (test.opts.verbose) {
+    fprintf(stderr, "Drew %u exposures\n", test.numExposures);
+  }
+
+  // Tear down
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  return 0;
+}
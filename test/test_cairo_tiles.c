@@ -0,0 +1,153 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests drawing a Cairo view in tiles on several threads.
+
+  This checks that the tiles drawn for each expose exactly cover the exposed
+  region, and that the expose event is still dispatched afterwards.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/cairo.h"
+#include "pugl/pugl.h"
+
+#include <cairo.h>
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+static const unsigned numThreads = 4u;
+static const PuglSpan tileSize   = 64u;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  pthread_mutex_t mutex;
+  size_t          tileArea;
+  unsigned        numTiles;
+  unsigned        numExposures;
+  bool            tiled;
+} PuglTest;
+
+static void
+onDrawTile(PuglView* const              view,
+           void* const                  context,
+           const PuglExposeEvent* const tile)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+  cairo_t* const  cr   = (cairo_t*)context;
+
+  assert(cr);
+  assert(tile->width > 0u && tile->width <= tileSize);
+  assert(tile->height > 0u && tile->height <= tileSize);
+
+  cairo_rectangle(cr, tile->x, tile->y, tile->width, tile->height);
+  cairo_set_source_rgb(cr, 0.0, (tile->x + tile->y) % 2 ? 0.5 : 1.0, 0.0);
+  cairo_fill(cr);
+
+  pthread_mutex_lock(&test->mutex);
+  test->tileArea += (size_t)tile->width * tile->height;
+  ++test->numTiles;
+  pthread_mutex_unlock(&test->mutex);
+}
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    // All tiles for this expose have been drawn by now
+    const PuglExposeEvent* const expose = &event->expose;
+    if (test->tiled) {
+      assert(test->tileArea == (size_t)expose->width * expose->height);
+    }
+
+    assert(puglGetContext(view));
+
+    test->tileArea = 0u;
+    ++test->numExposures;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest test = {puglNewWorld(PUGL_PROGRAM, 0),
+                   NULL,
+                   puglParseTestOptions(&argc, &argv),
+                   PTHREAD_MUTEX_INITIALIZER,
+                   0u,
+                   0u,
+                   0u,
+                   false};
+
+  // Tiling can only be enabled for views that use the Cairo backend
+  test.view = puglNewView(test.world);
+  assert(puglSetCairoTileFunc(test.view, onDrawTile, numThreads, tileSize) ==
+         PUGL_BAD_BACKEND);
+
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl Cairo Tiles Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglCairoBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 300, 200);
+
+  // Enable tiling before realizing
+  assert(!puglSetCairoTileFunc(test.view, onDrawTile, numThreads, tileSize));
+  test.tiled = true;
+  assert(!puglShow(test.view));
+
+  // Drive event loop until the view gets exposed
+  while (!test.numExposures) {
+    assert(!puglUpdate(test.world, -1.0));
+  }
+
+  // Redraw a region that isn't aligned to tiles
+  const PuglRect rect     = {30, 50, 100, 70};
+  const unsigned numTiles = test.numTiles;
+  assert(numTiles > 0u);
+  assert(!puglPostRedisplayRect(test.view, rect));
+  while (test.numExposures < 2u) {
+    assert(!puglUpdate(test.world, -1.0));
+  }
+
+  assert(test.numTiles > numTiles);
+
+  // Disable tiling, after which exposes are drawn as usual
+  assert(!puglSetCairoTileFunc(test.view, NULL, 0u, 0u));
+  test.tiled    = false;
+  test.numTiles = 0u;
+  assert(!puglPostRedisplay(test.view));
+  while (test.numExposures < 3u) {
+    assert(!puglUpdate(test.world, -1.0));
+  }
+
+  assert(!test.numTiles);
+
+  if (test.opts.verbose) {
+    fprintf(stderr, "Drew %u exposures in tiles\n", test.numExposures);
+  }
+
+  // Tear down
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+  pthread_mutex_destroy(&test.mutex);
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests that the cursor can be changed rapidly, and measures how long it takes.
+
+  This switches between all cursors many times, as happens when the pointer is
+  moved over many widgets, so the time reported with -v is dominated by the
+  cost of switching to an already loaded cursor.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/pugl.h"
+#include "pugl/stub.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef __APPLE__
+static const double timeout = 1 / 60.0;
+#else
+static const double timeout = -1.0;
+#endif
+
+static const unsigned numCursors    = (unsigned)PUGL_CURSOR_UP_DOWN + 1u;
+static const unsigned numIterations = 10000u;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  bool            exposed;
+} PuglTest;
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    test->exposed = true;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglWorld* const      world = puglNewWorld(PUGL_PROGRAM, 0);
+  PuglView* const       view  = puglNewView(world);
+  const PuglTestOptions opts  = puglParseTestOptions(&argc, &argv);
+  PuglTest              test  = {world, view, opts, false};
+
+  // Set up and show view
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl Cursor Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglStubBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 512, 512);
+  assert(!puglShow(test.view));
+
+  // Drive event loop until the view gets exposed
+  while (!test.exposed) {
+    assert(!puglUpdate(test.world, timeout));
+  }
+
+  // Check that an invalid cursor is rejected
+  assert(puglSetCursor(test.view, (PuglCursor)numCursors));
+
+  // Set every cursor once, which may fail if the system doesn't support it
+  PuglStatus initialStatus[(unsigned)PUGL_CURSOR_UP_DOWN + 1u];
+  for (unsigned c = 0u; c < numCursors; ++c) {
+    initialStatus[c] = puglSetCursor(test.view, (PuglCursor)c);
+  }
+
+  // Switch between all cursors many times
+  const double startTime = puglGetTime(test.world);
+  for (unsigned i = 0u; i < numIterations; ++i) {
+    const unsigned c = i % numCursors;
+    assert(puglSetCursor(test.view, (PuglCursor)c) == initialStatus[c]);
+  }
+
+  const double endTime = puglGetTime(test.world);
+  assert(!puglUpdate(test.world, 0.0));
+
+  if (test.opts.verbose) {
+    const double duration = endTime - startTime;
+
+    fprintf(stderr,
+            "%u cursor changes in %f seconds (%f us per change)\n",
+            numIterations,
+            duration,
+            duration / (double)numIterations * 1e6);
+  }
+
+  // Tear down
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  return 0;
+}
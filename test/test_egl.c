@@ -0,0 +1,113 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests the EGL backends.
+
+  This draws a window with the EGL backend, then creates an offscreen context
+  that shares objects with it, and checks that a texture created offscreen is
+  available in the window's context.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/egl.h"
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  unsigned        numExposures;
+} PuglTest;
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    assert(puglGetBufferAge(view) <= test->numExposures);
+
+    glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    ++test->numExposures;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglWorld* const      world = puglNewWorld(PUGL_PROGRAM, 0);
+  PuglView* const       view  = puglNewView(world);
+  const PuglTestOptions opts  = puglParseTestOptions(&argc, &argv);
+  PuglTest              test  = {world, view, opts, 0u};
+
+  // Set up and show view
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl EGL Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglEglBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 256, 256);
+  assert(!puglShow(test.view));
+  assert(puglGetViewHint(test.view, PUGL_DOUBLE_BUFFER) == PUGL_TRUE);
+
+  // Drive event loop until the view has been exposed and redrawn
+  while (test.numExposures < 2u) {
+    if (test.numExposures) {
+      assert(!puglPostRedisplay(test.view));
+    }
+
+    assert(!puglUpdate(test.world, 0.01));
+  }
+
+  // Set up an offscreen view that shares with the first
+  PuglView* const offscreen = puglNewView(test.world);
+  puglSetHandle(offscreen, &test);
+  puglSetBackend(offscreen, puglEglOffscreenBackend());
+  puglSetEventFunc(offscreen, onEvent);
+  puglSetSizeHint(offscreen, PUGL_DEFAULT_SIZE, 64, 64);
+  assert(!puglSetShareView(offscreen, test.view));
+  assert(!puglRealize(offscreen));
+
+  // Create a texture offscreen
+  GLuint texture = 0u;
+  assert(!puglEnterContext(offscreen));
+  assert(glGetString(GL_VERSION));
+  if (test.opts.verbose) {
+    fprintf(stderr, "Offscreen OpenGL %s\n", glGetString(GL_VERSION));
+  }
+
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  assert(!puglLeaveContext(offscreen));
+  assert(texture);
+
+  // Check that the texture is available in the window's context
+  assert(!puglEnterContext(test.view));
+  assert(glIsTexture(texture) == GL_TRUE);
+  assert(!puglLeaveContext(test.view));
+
+  // Tear down
+  puglFreeView(offscreen);
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  return 0;
+}
@@ -0,0 +1,127 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests driving Pugl from an external event loop.
+
+  This runs a simple poll() loop with the prepare, check, and dispatch API
+  instead of puglUpdate(), and checks that exposes, redisplays, and sent
+  events are all dispatched.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/pugl.h"
+#include "pugl/stub.h"
+
+#include <poll.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static const uintptr_t clientId = 42u;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  size_t          numExposures;
+  size_t          numClientEvents;
+} PuglTest;
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    ++test->numExposures;
+  } else if (event->type == PUGL_CLIENT && event->client.data1 == clientId) {
+    ++test->numClientEvents;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+/// Run one iteration of an external event loop
+static void
+iterate(PuglWorld* const world)
+{
+  double timeout = 0.0;
+  assert(!puglPrepareUpdate(world, &timeout));
+
+  int          fds[4] = {-1, -1, -1, -1};
+  const size_t numFds = puglGetUpdateFds(world, fds, 4u);
+  assert(numFds >= 1u && numFds <= 4u);
+
+  struct pollfd pfds[4];
+  for (size_t i = 0u; i < numFds; ++i) {
+    assert(fds[i] >= 0);
+    pfds[i].fd      = fds[i];
+    pfds[i].events  = POLLIN;
+    pfds[i].revents = 0;
+  }
+
+  const int ms = timeout < 0.0 ? -1 : (int)(timeout * 1000.0);
+  assert(poll(pfds, (nfds_t)numFds, ms) >= 0);
+
+  if (puglCheckUpdate(world)) {
+    assert(!puglDispatchUpdate(world));
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest test = {puglNewWorld(PUGL_PROGRAM, 0),
+                   NULL,
+                   puglParseTestOptions(&argc, &argv),
+                   0u,
+                   0u};
+
+  // Set up view
+  test.view = puglNewView(test.world);
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl External Loop Test");
+  puglSetBackend(test.view, puglStubBackend());
+  puglSetHandle(test.view, &test);
+  puglSetEventFunc(test.view, onEvent);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 256, 256);
+
+  // Show the view and wait until it's exposed
+  assert(!puglShow(test.view));
+  while (!test.numExposures) {
+    iterate(test.world);
+  }
+
+  // Post a redisplay, which must wake the loop
+  const size_t numExposures = test.numExposures;
+  assert(!puglPostRedisplay(test.view));
+  while (test.numExposures == numExposures) {
+    iterate(test.world);
+  }
+
+  // Send a client event, which must also wake the loop
+  PuglEvent event    = {{PUGL_CLIENT, 0}};
+  event.client.data1 = clientId;
+  event.client.data2 = 0u;
+  assert(!puglSendEvent(test.view, &event));
+  while (!test.numClientEvents) {
+    iterate(test.world);
+  }
+
+  // Tear down
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  return 0;
+}
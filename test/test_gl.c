@@ -100,6 +100,11 @@ main(int argc, char** argv)
     puglUpdate(test.world, -1.0);
   }
 
+  // Check that frame timing is either available or unsupported
+  PuglFrameTiming  timing = {0.0, 0u, 0u, 0u};
+  const PuglStatus st     = puglGetFrameTiming(test.view, &timing);
+  assert(st == PUGL_SUCCESS || st == PUGL_UNSUPPORTED);
+
   // Tear down
   puglFreeView(test.view);
   puglFreeWorld(test.world);
@@ -0,0 +1,129 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests drawing partial updates based on the age of the back buffer.
+
+  This draws the whole view once, then redraws small regions of it, only
+  clearing the exposed region when the back buffer contents are known.  The
+  buffer age of each frame is printed when run with -v.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+static const unsigned numFrames = 16u;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  unsigned        numExposures;
+  unsigned        numPartialExposures;
+} PuglTest;
+
+static void
+onExpose(PuglTest* const test, const PuglExposeEvent* const expose)
+{
+  const PuglRect frame = puglGetFrame(test->view);
+  const unsigned age   = puglGetBufferAge(test->view);
+
+  // A buffer can't be older than the number of frames drawn so far
+  assert(age <= test->numExposures);
+
+  if (test->opts.verbose) {
+    fprintf(stderr, "Frame %u buffer age %u\n", test->numExposures, age);
+  }
+
+  if (age) {
+    // Only the exposed region needs to be redrawn
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(expose->x,
+              (int)frame.height - expose->y - (int)expose->height,
+              (int)expose->width,
+              (int)expose->height);
+  }
+
+  const float shade = (float)(test->numExposures % 8u) / 8.0f;
+  glClearColor(shade, 0.0f, 0.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glDisable(GL_SCISSOR_TEST);
+
+  ++test->numExposures;
+  if (expose->width < frame.width || expose->height < frame.height) {
+    ++test->numPartialExposures;
+  }
+}
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    onExpose(test, &event->expose);
+  }
+
+  return PUGL_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglWorld* const      world = puglNewWorld(PUGL_PROGRAM, 0);
+  PuglView* const       view  = puglNewView(world);
+  const PuglTestOptions opts  = puglParseTestOptions(&argc, &argv);
+  PuglTest              test  = {world, view, opts, 0u, 0u};
+
+  // Set up and show view
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl OpenGL Buffer Age Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglGlBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 256, 256);
+  assert(!puglShow(test.view));
+
+  // Drive event loop until the view gets exposed
+  while (!test.numExposures) {
+    assert(!puglUpdate(test.world, 0.01));
+  }
+
+  // Redraw a different small region of the view for every frame
+  for (unsigned i = 0u; i < numFrames; ++i) {
+    const PuglCoord offset       = (PuglCoord)((i % 8u) * 32u);
+    const PuglRect  rect         = {offset, offset, 32u, 32u};
+    const unsigned  numExposures = test.numExposures;
+
+    assert(!puglPostRedisplayRect(test.view, rect));
+    while (test.numExposures == numExposures) {
+      assert(!puglUpdate(test.world, 0.01));
+    }
+  }
+
+  if (test.opts.verbose) {
+    fprintf(stderr,
+            "%u of %u exposures were partial\n",
+            test.numPartialExposures,
+            test.numExposures);
+  }
+
+  // Tear down
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  return 0;
+}
@@ -0,0 +1,143 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests that framebuffer configurations are reused between views.
+
+  This wraps glXChooseFBConfig() and glXGetFBConfigAttrib() to count calls,
+  then realizes several views with the same hints, which should only choose a
+  configuration once, and a view with different hints, which should choose a
+  new one.
+*/
+
+#define _GNU_SOURCE
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+#include <GL/glx.h>
+
+#include <assert.h>
+#include <dlfcn.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NUM_VIEWS 4u
+
+typedef GLXFBConfig* (*ChooseFBConfigFunc)(Display*, int, const int*, int*);
+typedef int (*GetFBConfigAttribFunc)(Display*, GLXFBConfig, int, int*);
+
+static unsigned numConfigQueries = 0u;
+
+GLXFBConfig*
+glXChooseFBConfig(Display* const   display,
+                  const int        screen,
+                  const int* const attribList,
+                  int* const       nitems)
+{
+  static ChooseFBConfigFunc realChooseFBConfig = NULL;
+  if (!realChooseFBConfig) {
+    void* const sym = dlsym(RTLD_NEXT, "glXChooseFBConfig");
+    memcpy(&realChooseFBConfig, &sym, sizeof(sym));
+    assert(realChooseFBConfig);
+  }
+
+  ++numConfigQueries;
+  return realChooseFBConfig(display, screen, attribList, nitems);
+}
+
+int
+glXGetFBConfigAttrib(Display* const    display,
+                     const GLXFBConfig config,
+                     const int         attribute,
+                     int* const        value)
+{
+  static GetFBConfigAttribFunc realGetFBConfigAttrib = NULL;
+  if (!realGetFBConfigAttrib) {
+    void* const sym = dlsym(RTLD_NEXT, "glXGetFBConfigAttrib");
+    memcpy(&realGetFBConfigAttrib, &sym, sizeof(sym));
+    assert(realGetFBConfigAttrib);
+  }
+
+  ++numConfigQueries;
+  return realGetFBConfigAttrib(display, config, attribute, value);
+}
+
+typedef struct {
+  PuglWorld*      world;
+  PuglTestOptions opts;
+} PuglTest;
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static PuglView*
+createView(PuglTest* const test, const int depthBits)
+{
+  PuglView* const view = puglNewView(test->world);
+
+  puglSetWindowTitle(view, "Pugl OpenGL Config Test");
+  puglSetHandle(view, test);
+  puglSetBackend(view, puglGlBackend());
+  puglSetEventFunc(view, onEvent);
+  puglSetSizeHint(view, PUGL_DEFAULT_SIZE, 128, 128);
+  puglSetViewHint(view, PUGL_DEPTH_BITS, depthBits);
+  assert(!puglRealize(view));
+  return view;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest test = {puglNewWorld(PUGL_PROGRAM, 0),
+                   puglParseTestOptions(&argc, &argv)};
+
+  puglSetClassName(test.world, "PuglTest");
+
+  // Realize a first view, which must choose a configuration
+  PuglView* views[NUM_VIEWS] = {createView(&test, 0), NULL, NULL, NULL};
+  assert(numConfigQueries > 0u);
+
+  const unsigned firstQueries = numConfigQueries;
+  if (test.opts.verbose) {
+    fprintf(stderr, "First view made %u config queries\n", firstQueries);
+  }
+
+  // Realize more views with the same hints, which shouldn't make any queries
+  for (unsigned i = 1u; i < NUM_VIEWS - 1u; ++i) {
+    views[i] = createView(&test, 0);
+    assert(numConfigQueries == firstQueries);
+    for (int h = 0; h < PUGL_NUM_VIEW_HINTS; ++h) {
+      assert(puglGetViewHint(views[i], (PuglViewHint)h) ==
+             puglGetViewHint(views[0], (PuglViewHint)h));
+    }
+  }
+
+  // Realize a view with different hints, which must choose a new configuration
+  views[NUM_VIEWS - 1u] = createView(&test, 24);
+  assert(numConfigQueries > firstQueries);
+
+  // Tear down
+  for (unsigned i = 0u; i < NUM_VIEWS; ++i) {
+    puglFreeView(views[i]);
+  }
+
+  puglFreeWorld(test.world);
+
+  return 0;
+}
@@ -0,0 +1,118 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests measuring the time taken to draw OpenGL frames.
+
+  This draws several frames with the draw timing hint set, and checks that
+  timings are eventually available if the hint is supported.  A debug context
+  is also requested, and any messages from it are logged via the world.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+static const unsigned maxFrames = 100u;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  unsigned        numExposures;
+} PuglTest;
+
+static PuglTestOptions testOpts;
+
+static void
+onLog(PuglWorld* const world, const PuglLogLevel level, const char* const msg)
+{
+  (void)world;
+
+  if (testOpts.verbose) {
+    fprintf(stderr, "Log (%d): %s\n", (int)level, msg);
+  }
+}
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    glClearColor(0.2f, 0.0f, 0.2f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    ++test->numExposures;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglWorld* const      world = puglNewWorld(PUGL_PROGRAM, 0);
+  PuglView* const       view  = puglNewView(world);
+  const PuglTestOptions opts  = puglParseTestOptions(&argc, &argv);
+  PuglTest              test  = {world, view, opts, 0u};
+
+  // Set up and show view
+  testOpts = opts;
+  puglSetLogFunc(test.world, onLog);
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl OpenGL Draw Timing Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglGlBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetViewHint(test.view, PUGL_USE_DEBUG_CONTEXT, PUGL_TRUE);
+  puglSetViewHint(test.view, PUGL_DRAW_TIMING, PUGL_TRUE);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 256, 256);
+  assert(!puglShow(test.view));
+
+  // Nothing has been measured yet
+  PuglDrawTiming timing = {0.0, 0.0, 0u};
+  PuglStatus     st     = puglGetDrawTiming(test.view, &timing);
+  if (puglGetViewHint(test.view, PUGL_DRAW_TIMING) != PUGL_TRUE) {
+    assert(st == PUGL_UNSUPPORTED);
+  } else {
+    assert(st == PUGL_FAILURE);
+
+    // Draw frames until one has been measured
+    while (test.numExposures < maxFrames &&
+           (st = puglGetDrawTiming(test.view, &timing))) {
+      assert(st == PUGL_FAILURE);
+      assert(!puglPostRedisplay(test.view));
+      assert(!puglUpdate(test.world, 0.01));
+    }
+
+    assert(!st);
+    assert(timing.frame >= 1u);
+    assert(timing.cpuTime >= 0.0);
+    assert(timing.gpuTime >= 0.0);
+
+    if (test.opts.verbose) {
+      fprintf(stderr,
+              "Frame %u: %f ms CPU, %f ms GPU\n",
+              (unsigned)timing.frame,
+              timing.cpuTime * 1000.0,
+              timing.gpuTime * 1000.0);
+    }
+  }
+
+  // Tear down
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  return 0;
+}
@@ -0,0 +1,132 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests getting the timing of shown OpenGL frames.
+
+  This requests adaptive swapping, and checks that the hint is set to whether
+  it's actually used.  Several frames are then drawn, and if frame timing is
+  supported, the timing of each must be no earlier than the last, and on the
+  same clock as puglGetTime().
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+static const unsigned numFrames = 8u;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  unsigned        numExposures;
+} PuglTest;
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    glClearColor(0.2f, 0.0f, 0.2f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    ++test->numExposures;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static void
+checkTiming(const PuglTest* const        test,
+            const PuglFrameTiming* const last,
+            const PuglFrameTiming* const timing)
+{
+  if (test->opts.verbose) {
+    fprintf(stderr,
+            "Frame %u shown at %f (refresh %u, %u missed)\n",
+            (unsigned)timing->sbc,
+            timing->time,
+            (unsigned)timing->msc,
+            timing->missed);
+  }
+
+  // Frames were shown after the world was created, and before now
+  assert(timing->time >= 0.0);
+  assert(timing->time <= puglGetTime(test->world));
+
+  // Counters and times never go backwards, and later frames are shown later
+  assert(timing->sbc >= last->sbc);
+  assert(timing->msc >= last->msc);
+  assert(timing->time >= last->time);
+  if (timing->sbc > last->sbc) {
+    assert(timing->time > last->time);
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglWorld* const      world = puglNewWorld(PUGL_PROGRAM, 0);
+  PuglView* const       view  = puglNewView(world);
+  const PuglTestOptions opts  = puglParseTestOptions(&argc, &argv);
+  PuglTest              test  = {world, view, opts, 0u};
+
+  // Set up and show view
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl OpenGL Frame Timing Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglGlBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetViewHint(test.view, PUGL_DOUBLE_BUFFER, PUGL_TRUE);
+  puglSetViewHint(test.view, PUGL_SWAP_INTERVAL, 1);
+  puglSetViewHint(test.view, PUGL_ADAPTIVE_SWAP, PUGL_TRUE);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 256, 256);
+  assert(!puglShow(test.view));
+
+  // Check that the adaptive swap hint was set to whether it's actually used
+  const int adaptive = puglGetViewHint(test.view, PUGL_ADAPTIVE_SWAP);
+  assert(adaptive == PUGL_TRUE || adaptive == PUGL_FALSE);
+
+  // Get the initial timing, before any frames have been shown
+  PuglFrameTiming last = {0.0, 0u, 0u, 0u};
+  PuglStatus      st   = puglGetFrameTiming(test.view, &last);
+  if (st) {
+    assert(st == PUGL_UNSUPPORTED);
+  } else {
+    // Draw frames, checking the timing after each one
+    while (test.numExposures < numFrames) {
+      const unsigned numExposures = test.numExposures;
+
+      assert(!puglPostRedisplay(test.view));
+      while (test.numExposures == numExposures) {
+        assert(!puglUpdate(test.world, 0.1));
+      }
+
+      PuglFrameTiming timing = {0.0, 0u, 0u, 0u};
+      assert(!puglGetFrameTiming(test.view, &timing));
+      checkTiming(&test, &last, &timing);
+      last = timing;
+    }
+
+    // Some frames have been shown (the latest may still be pending)
+    assert(last.sbc > 0u);
+  }
+
+  // Tear down
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  return 0;
+}
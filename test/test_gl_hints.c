@@ -59,6 +59,9 @@ main(void)
   assert(!puglSetViewHint(view, PUGL_DOUBLE_BUFFER, PUGL_DONT_CARE));
   assert(!puglSetViewHint(view, PUGL_REFRESH_RATE, PUGL_DONT_CARE));
 
+  // Request adaptive swapping, which may not be supported
+  assert(!puglSetViewHint(view, PUGL_ADAPTIVE_SWAP, PUGL_TRUE));
+
   // Realize view and print all hints for debugging convenience
   assert(!puglRealize(view));
   printViewHints(view);
@@ -81,6 +84,10 @@ main(void)
   assert(puglGetViewHint(view, PUGL_IGNORE_KEY_REPEAT) != PUGL_DONT_CARE);
   assert(puglGetViewHint(view, PUGL_REFRESH_RATE) != PUGL_DONT_CARE);
 
+  // Check that adaptive swapping is set to whether it's actually enabled
+  const int adaptiveSwap = puglGetViewHint(view, PUGL_ADAPTIVE_SWAP);
+  assert(adaptiveSwap == PUGL_TRUE || adaptiveSwap == PUGL_FALSE);
+
   // Tear down
   puglFreeView(view);
   puglFreeWorld(world);
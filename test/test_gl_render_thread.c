@@ -0,0 +1,132 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests drawing an OpenGL view on a render thread.
+
+  This checks that exposures are handled on a thread other than the one
+  running the event loop, that the context can still be entered manually
+  between frames, and that drawing continues afterwards.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+static const unsigned numFrames = 8u;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  pthread_t       mainThread;
+  pthread_mutex_t mutex;
+  unsigned        numExposures;
+  bool            exposedOnMainThread;
+} PuglTest;
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    glClearColor(0.0f, 0.2f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    pthread_mutex_lock(&test->mutex);
+    if (pthread_equal(pthread_self(), test->mainThread)) {
+      test->exposedOnMainThread = true;
+    }
+
+    ++test->numExposures;
+    pthread_mutex_unlock(&test->mutex);
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static unsigned
+getNumExposures(PuglTest* const test)
+{
+  pthread_mutex_lock(&test->mutex);
+  const unsigned numExposures = test->numExposures;
+  pthread_mutex_unlock(&test->mutex);
+  return numExposures;
+}
+
+/// Redraw the view and wait until the render thread has drawn it
+static void
+drawFrame(PuglTest* const test)
+{
+  const unsigned expected = getNumExposures(test) + 1u;
+
+  assert(!puglPostRedisplay(test->view));
+  while (getNumExposures(test) < expected) {
+    assert(!puglUpdate(test->world, 0.01));
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest test = {puglNewWorld(PUGL_PROGRAM, PUGL_WORLD_THREADS),
+                   NULL,
+                   puglParseTestOptions(&argc, &argv),
+                   pthread_self(),
+                   PTHREAD_MUTEX_INITIALIZER,
+                   0u,
+                   false};
+
+  // Set up and show view
+  test.view = puglNewView(test.world);
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl OpenGL Render Thread Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglGlBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetViewHint(test.view, PUGL_RENDER_THREAD, PUGL_TRUE);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 256, 256);
+  assert(!puglShow(test.view));
+  assert(puglGetViewHint(test.view, PUGL_RENDER_THREAD) == PUGL_TRUE);
+
+  // Draw several frames
+  for (unsigned i = 0u; i < numFrames; ++i) {
+    drawFrame(&test);
+  }
+
+  // Enter the context manually, which must stop the render thread
+  assert(!puglEnterContext(test.view));
+  assert(glGetString(GL_VERSION));
+  assert(!puglLeaveContext(test.view));
+
+  // Draw several more frames, which must restart the render thread
+  for (unsigned i = 0u; i < numFrames; ++i) {
+    drawFrame(&test);
+  }
+
+  assert(!test.exposedOnMainThread);
+  if (test.opts.verbose) {
+    fprintf(stderr, "Drew %u frames on a render thread\n", test.numExposures);
+  }
+
+  // Tear down while the render thread is still running
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+  pthread_mutex_destroy(&test.mutex);
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+// Tests that OpenGL objects can be shared between views
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+  PuglWorld*      world;
+  PuglTestOptions opts;
+} PuglTest;
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static PuglView*
+createView(PuglTest* const test, const char* const title)
+{
+  PuglView* const view = puglNewView(test->world);
+
+  puglSetWindowTitle(view, title);
+  puglSetHandle(view, test);
+  puglSetBackend(view, puglGlBackend());
+  puglSetEventFunc(view, onEvent);
+  puglSetSizeHint(view, PUGL_DEFAULT_SIZE, 256, 256);
+  return view;
+}
+
+static bool
+isTexture(PuglView* const view, const GLuint texture)
+{
+  assert(!puglEnterContext(view));
+  const bool result = glIsTexture(texture) == GL_TRUE;
+  assert(!puglLeaveContext(view));
+  return result;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest test = {puglNewWorld(PUGL_PROGRAM, 0),
+                   puglParseTestOptions(&argc, &argv)};
+
+  puglSetClassName(test.world, "PuglTest");
+
+  PuglView* const firstView    = createView(&test, "Pugl Share Test 1");
+  PuglView* const secondView   = createView(&test, "Pugl Share Test 2");
+  PuglView* const unsharedView = createView(&test, "Pugl Unshared Test");
+
+  // Realize the first view and create a texture in it
+  assert(!puglRealize(firstView));
+  assert(puglSetShareView(firstView, NULL) == PUGL_FAILURE);
+
+  GLuint texture = 0u;
+  assert(!puglEnterContext(firstView));
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  assert(!puglLeaveContext(firstView));
+  assert(texture);
+
+  // Realize the other views, one sharing with the first and one not
+  assert(!puglSetShareView(secondView, firstView));
+  assert(!puglRealize(secondView));
+  assert(!puglRealize(unsharedView));
+
+  // Check that the texture is only available in the shared view
+  assert(isTexture(firstView, texture));
+  assert(isTexture(secondView, texture));
+  assert(!isTexture(unsharedView, texture));
+
+  // Tear down
+  puglFreeView(unsharedView);
+  puglFreeView(secondView);
+  puglFreeView(firstView);
+  puglFreeWorld(test.world);
+
+  return 0;
+}
@@ -0,0 +1,169 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests how many OpenGL context switches are made when drawing several views.
+
+  This wraps glXMakeCurrent() to count calls, then draws several views at once
+  for a number of frames, and finally redraws a single view many times.  The
+  average number of switches per frame is printed when run with -v.
+*/
+
+#define _GNU_SOURCE
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/gl.h"
+#include "pugl/pugl.h"
+
+#include <GL/glx.h>
+
+#include <assert.h>
+#include <dlfcn.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NUM_VIEWS 4u
+
+static const unsigned numFrames = 32u;
+
+typedef Bool (*MakeCurrentFunc)(Display*, GLXDrawable, GLXContext);
+
+static unsigned numSwitches = 0u;
+
+Bool
+glXMakeCurrent(Display* const    display,
+               const GLXDrawable drawable,
+               const GLXContext  ctx)
+{
+  static MakeCurrentFunc realMakeCurrent = NULL;
+  if (!realMakeCurrent) {
+    void* const sym = dlsym(RTLD_NEXT, "glXMakeCurrent");
+    memcpy(&realMakeCurrent, &sym, sizeof(sym));
+    assert(realMakeCurrent);
+  }
+
+  ++numSwitches;
+  return realMakeCurrent(display, drawable, ctx);
+}
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       views[NUM_VIEWS];
+  PuglTestOptions opts;
+  unsigned        numExposures[NUM_VIEWS];
+} PuglTest;
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    for (unsigned i = 0u; i < NUM_VIEWS; ++i) {
+      if (test->views[i] == view) {
+        glClearColor(0.0f, 0.0f, (float)i / (float)NUM_VIEWS, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        ++test->numExposures[i];
+      }
+    }
+  }
+
+  return PUGL_SUCCESS;
+}
+
+/// Redraw the first `numViews` views and return the number of switches made
+static unsigned
+drawFrame(PuglTest* const test, const unsigned numViews)
+{
+  unsigned expected[NUM_VIEWS] = {0u, 0u, 0u, 0u};
+  for (unsigned i = 0u; i < numViews; ++i) {
+    expected[i] = test->numExposures[i] + 1u;
+    assert(!puglPostRedisplay(test->views[i]));
+  }
+
+  const unsigned startSwitches = numSwitches;
+  for (unsigned i = 0u; i < numViews; ++i) {
+    while (test->numExposures[i] < expected[i]) {
+      assert(!puglUpdate(test->world, 0.01));
+    }
+  }
+
+  return numSwitches - startSwitches;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest test = {puglNewWorld(PUGL_PROGRAM, 0),
+                   {NULL, NULL, NULL, NULL},
+                   puglParseTestOptions(&argc, &argv),
+                   {0u, 0u, 0u, 0u}};
+
+  // Set up and show views
+  puglSetClassName(test.world, "PuglTest");
+  for (unsigned i = 0u; i < NUM_VIEWS; ++i) {
+    PuglView* const view = puglNewView(test.world);
+
+    test.views[i] = view;
+    puglSetWindowTitle(view, "Pugl OpenGL Switch Test");
+    puglSetHandle(view, &test);
+    puglSetBackend(view, puglGlBackend());
+    puglSetEventFunc(view, onEvent);
+    puglSetSizeHint(view, PUGL_DEFAULT_SIZE, 128, 128);
+    puglSetPosition(view, (int)(i * 160u), 0);
+    assert(!puglShow(view));
+  }
+
+  // Drive event loop until every view has been exposed
+  for (unsigned i = 0u; i < NUM_VIEWS; ++i) {
+    while (!test.numExposures[i]) {
+      assert(!puglUpdate(test.world, 0.01));
+    }
+  }
+
+  // Draw all views, which should take at most one switch per view
+  unsigned totalSwitches = 0u;
+  for (unsigned f = 0u; f < numFrames; ++f) {
+    const unsigned frameSwitches = drawFrame(&test, NUM_VIEWS);
+    assert(frameSwitches <= NUM_VIEWS);
+    totalSwitches += frameSwitches;
+  }
+
+  if (test.opts.verbose) {
+    fprintf(stderr,
+            "%f switches per frame with %u views\n",
+            (double)totalSwitches / (double)numFrames,
+            NUM_VIEWS);
+  }
+
+  // Draw one view repeatedly, which should only need to switch once
+  totalSwitches = 0u;
+  for (unsigned f = 0u; f < numFrames; ++f) {
+    totalSwitches += drawFrame(&test, 1u);
+  }
+
+  assert(totalSwitches <= 1u);
+  if (test.opts.verbose) {
+    fprintf(stderr,
+            "%f switches per frame with 1 view\n",
+            (double)totalSwitches / (double)numFrames);
+  }
+
+  // Tear down
+  for (unsigned i = 0u; i < NUM_VIEWS; ++i) {
+    puglFreeView(test.views[i]);
+  }
+
+  puglFreeWorld(test.world);
+
+  return 0;
+}
@@ -0,0 +1,96 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests idle tasks.
+
+  This checks that queued idle tasks are run in turn by puglUpdate() without
+  blocking, even with an infinite timeout, and are removed when finished.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/pugl.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+  unsigned numCalls;  ///< Number of times the task was called
+  unsigned numChunks; ///< Number of chunks of work to do
+} Task;
+
+static unsigned totalCalls = 0u;
+
+static bool
+runTask(PuglWorld* const world, void* const data)
+{
+  Task* const task = (Task*)data;
+
+  (void)world;
+
+  ++task->numCalls;
+  ++totalCalls;
+  return task->numCalls < task->numChunks;
+}
+
+static bool
+neverRun(PuglWorld* const world, void* const data)
+{
+  (void)world;
+  (void)data;
+
+  assert(false);
+  return false;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglWorld* const world = puglNewWorld(PUGL_PROGRAM, 0);
+  PuglTestOptions  opts  = puglParseTestOptions(&argc, &argv);
+
+  (void)opts;
+
+  Task shortTask = {0u, 3u};
+  Task longTask  = {0u, 10u};
+
+  // Check bad parameters and removing unknown tasks
+  assert(puglSetIdleBudget(world, -1.0) == PUGL_BAD_PARAMETER);
+  assert(puglRemoveIdleTask(world, runTask, &shortTask) == PUGL_FAILURE);
+
+  // Add a task and immediately remove it, so it never runs
+  assert(!puglAddIdleTask(world, neverRun, NULL));
+  assert(!puglRemoveIdleTask(world, neverRun, NULL));
+
+  // Run one task per update, so the order of calls can be checked
+  assert(!puglSetIdleBudget(world, 0.0));
+  assert(!puglAddIdleTask(world, runTask, &shortTask));
+  assert(!puglAddIdleTask(world, runTask, &longTask));
+
+  // Update with an infinite timeout until both tasks are finished
+  while (longTask.numCalls < longTask.numChunks) {
+    const unsigned calls = totalCalls;
+    puglUpdate(world, -1.0);
+    assert(totalCalls == calls + 1u);
+
+    // The tasks are called in turn until the short one is finished
+    if (totalCalls <= 2u * shortTask.numChunks) {
+      assert(shortTask.numCalls == (totalCalls + 1u) / 2u);
+      assert(longTask.numCalls == totalCalls / 2u);
+    }
+  }
+
+  // Both tasks did all their work, and were removed when finished
+  assert(shortTask.numCalls == shortTask.numChunks);
+  assert(longTask.numCalls == longTask.numChunks);
+  assert(totalCalls == shortTask.numChunks + longTask.numChunks);
+  assert(puglRemoveIdleTask(world, runTask, &shortTask) == PUGL_FAILURE);
+  assert(puglRemoveIdleTask(world, runTask, &longTask) == PUGL_FAILURE);
+
+  puglFreeWorld(world);
+  return 0;
+}
@@ -15,11 +15,13 @@
 #endif
 
 #include "../src/implementation.c" // IWYU pragma: keep
+#include "../src/virtual.c"        // IWYU pragma: keep
 
 #if defined(_WIN32)
-#  include "../src/win.c"      // IWYU pragma: keep
-#  include "../src/win.h"      // IWYU pragma: keep
-#  include "../src/win_stub.c" // IWYU pragma: keep
+#  include "../src/win.c"        // IWYU pragma: keep
+#  include "../src/win.h"        // IWYU pragma: keep
+#  include "../src/win_pixels.c" // IWYU pragma: keep
+#  include "../src/win_stub.c"   // IWYU pragma: keep
 #  if defined(WITH_CAIRO)
 #    include "../src/win_cairo.c" // IWYU pragma: keep
 #  endif
@@ -31,19 +33,33 @@
 #  endif
 
 #else
-#  include "../src/x11.c"      // IWYU pragma: keep
-#  include "../src/x11_stub.c" // IWYU pragma: keep
+#  include "../src/remote.c"     // IWYU pragma: keep
+#  include "../src/x11.c"        // IWYU pragma: keep
+#  include "../src/x11_pixels.c" // IWYU pragma: keep
+#  include "../src/x11_stub.c"   // IWYU pragma: keep
 #  if defined(WITH_CAIRO)
 #    include "../src/x11_cairo.c" // IWYU pragma: keep
 #  endif
 #  if defined(WITH_OPENGL)
 #    include "../src/x11_gl.c" // IWYU pragma: keep
 #  endif
+#  if defined(WITH_EGL)
+#    include "../src/x11_egl.c" // IWYU pragma: keep
+#  endif
 #  if defined(WITH_VULKAN)
 #    include "../src/x11_vulkan.c" // IWYU pragma: keep
 #  endif
 #endif
 
+#if defined(WITH_CAIRO)
+#  include "../src/cairo_layers.c" // IWYU pragma: keep
+#endif
+
+#if defined(WITH_VULKAN)
+#  include "../src/vulkan_functions.c" // IWYU pragma: keep
+#  include "../src/vulkan_swapchain.c" // IWYU pragma: keep
+#endif
+
 #if defined(__clang__)
 #  pragma clang diagnostic pop
 #elif defined(__GNUC__)
@@ -0,0 +1,209 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests copying a large amount of data from one view to another.
+
+  The data is much larger than the maximum request size of the window system,
+  so on X11 it must be transferred incrementally.  The throughput of the
+  transfer is printed when run with -v.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/pugl.h"
+#include "pugl/stub.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uintptr_t copierTimerId = 1u;
+static const uintptr_t pasterTimerId = 2u;
+static const size_t    dataSize      = 64u * 1024u * 1024u;
+
+typedef enum {
+  START,
+  COPIED,
+  PASTED,
+  RECEIVED_OFFER,
+  FINISHED,
+} State;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       copierView;
+  PuglView*       pasterView;
+  PuglTestOptions opts;
+  uint8_t*        data;
+  double          pasteTime;
+  double          receiveTime;
+  State           state;
+  bool            copierStarted;
+  bool            pasterStarted;
+} PuglTest;
+
+static PuglStatus
+onCopierEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Copier Event: ", true);
+  }
+
+  switch (event->type) {
+  case PUGL_EXPOSE:
+    if (!test->copierStarted) {
+      // Start timer on first expose
+      assert(!puglStartTimer(view, copierTimerId, 1 / 15.0));
+      test->copierStarted = true;
+    }
+    break;
+
+  case PUGL_TIMER:
+    assert(event->timer.id == copierTimerId);
+
+    if (test->state < COPIED) {
+      assert(!puglSetClipboard(
+        view, "application/octet-stream", test->data, dataSize));
+
+      test->state = COPIED;
+    }
+
+    break;
+
+  default:
+    break;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static PuglStatus
+onPasterEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Paster Event: ", true);
+  }
+
+  switch (event->type) {
+  case PUGL_EXPOSE:
+    if (!test->pasterStarted) {
+      // Start timer on first expose
+      assert(!puglStartTimer(view, pasterTimerId, 1 / 60.0));
+      test->pasterStarted = true;
+    }
+    break;
+
+  case PUGL_TIMER:
+    assert(event->timer.id == pasterTimerId);
+    if (test->state == COPIED) {
+      test->state     = PASTED;
+      test->pasteTime = puglGetTime(test->world);
+      assert(!puglPaste(view));
+    }
+    break;
+
+  case PUGL_DATA_OFFER:
+    if (test->state == PASTED) {
+      test->state = RECEIVED_OFFER;
+
+      assert(puglGetNumClipboardTypes(view) == 1u);
+      assert(!puglAcceptOffer(view, &event->offer, 0));
+    }
+    break;
+
+  case PUGL_DATA:
+    if (test->state == RECEIVED_OFFER) {
+      size_t            len  = 0;
+      const void* const data = puglGetClipboard(view, 0, &len);
+
+      // Check that the offered data is what we copied earlier
+      assert(data);
+      assert(len == dataSize);
+      assert(!memcmp(data, test->data, dataSize));
+
+      test->receiveTime = puglGetTime(test->world);
+      test->state       = FINISHED;
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest app = {puglNewWorld(PUGL_PROGRAM, 0),
+                  NULL,
+                  NULL,
+                  puglParseTestOptions(&argc, &argv),
+                  (uint8_t*)malloc(dataSize),
+                  0.0,
+                  0.0,
+                  START,
+                  false,
+                  false};
+
+  // Fill the data with a pattern that will reveal misplaced chunks
+  assert(app.data);
+  for (size_t i = 0u; i < dataSize; ++i) {
+    app.data[i] = (uint8_t)((i * 31u + (i >> 16u)) & 0xFFu);
+  }
+
+  // Set up copier view
+  app.copierView = puglNewView(app.world);
+  puglSetClassName(app.world, "PuglTest");
+  puglSetWindowTitle(app.copierView, "Pugl Large Copy Test");
+  puglSetBackend(app.copierView, puglStubBackend());
+  puglSetHandle(app.copierView, &app);
+  puglSetEventFunc(app.copierView, onCopierEvent);
+  puglSetSizeHint(app.copierView, PUGL_DEFAULT_SIZE, 256, 256);
+
+  // Set up paster view
+  app.pasterView = puglNewView(app.world);
+  puglSetWindowTitle(app.pasterView, "Pugl Large Paste Test");
+  puglSetBackend(app.pasterView, puglStubBackend());
+  puglSetHandle(app.pasterView, &app);
+  puglSetEventFunc(app.pasterView, onPasterEvent);
+  puglSetSizeHint(app.pasterView, PUGL_DEFAULT_SIZE, 256, 256);
+
+  // Create and show both views
+  assert(!puglShow(app.copierView));
+  assert(!puglShow(app.pasterView));
+
+  // Run until the test is finished
+  while (app.state != FINISHED) {
+    assert(!puglUpdate(app.world, 1 / 60.0));
+  }
+
+  if (app.opts.verbose) {
+    const double duration = app.receiveTime - app.pasteTime;
+
+    fprintf(stderr,
+            "Transferred %zu bytes in %f seconds (%f MiB/s)\n",
+            dataSize,
+            duration,
+            (double)dataSize / (1024.0 * 1024.0) / duration);
+  }
+
+  puglFreeView(app.copierView);
+  puglFreeView(app.pasterView);
+  puglFreeWorld(app.world);
+  free(app.data);
+
+  return 0;
+}
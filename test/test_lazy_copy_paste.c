@@ -0,0 +1,161 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+// Tests that offered clipboard data is only provided when it is pasted
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/pugl.h"
+#include "pugl/stub.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static const uintptr_t timerId = 1u;
+
+static const char* const offeredTypes[] = {"text/plain",
+                                           "application/x-pugl-test"};
+
+static const char* const offeredData[] = {"Offered Text", "Offered Data"};
+
+typedef enum {
+  START,
+  EXPOSED,
+  PASTED,
+  RECEIVED_OFFER,
+  FINISHED,
+} State;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  unsigned        numProvided[2];
+  State           state;
+} PuglTest;
+
+static const void*
+provideData(PuglView* const view, const uint32_t typeIndex, size_t* const len)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  assert(typeIndex < 2u);
+  ++test->numProvided[typeIndex];
+
+  *len = strlen(offeredData[typeIndex]) + 1;
+  return offeredData[typeIndex];
+}
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  switch (event->type) {
+  case PUGL_EXPOSE:
+    if (test->state < EXPOSED) {
+      // Start timer on first expose
+      assert(!puglStartTimer(view, timerId, 1 / 60.0));
+      test->state = EXPOSED;
+    }
+    break;
+
+  case PUGL_TIMER:
+    assert(event->timer.id == timerId);
+
+    if (test->state == EXPOSED) {
+      assert(!puglOfferClipboard(view, offeredTypes, 2u, provideData));
+
+      // Check that offering data didn't request it
+      assert(!test->numProvided[0]);
+      assert(!test->numProvided[1]);
+
+      test->state = PASTED;
+      assert(!puglPaste(view));
+    }
+    break;
+
+  case PUGL_DATA_OFFER:
+    if (test->state == PASTED) {
+      test->state = RECEIVED_OFFER;
+
+      // Accept the data as the second offered type
+      const uint32_t numTypes = puglGetNumClipboardTypes(view);
+      for (uint32_t t = 0u; t < numTypes; ++t) {
+        if (!strcmp(puglGetClipboardType(view, t), offeredTypes[1])) {
+          assert(!puglAcceptOffer(view, &event->offer, t));
+          return PUGL_SUCCESS;
+        }
+      }
+
+      assert(false);
+    }
+    break;
+
+  case PUGL_DATA:
+    if (test->state == RECEIVED_OFFER) {
+      // Check that only the accepted type was provided
+      assert(!test->numProvided[0]);
+      assert(test->numProvided[1] == 1u);
+
+      size_t      len  = 0;
+      const char* data = (const char*)puglGetClipboard(
+        view, event->data.typeIndex, &len);
+
+      // Check that the data is what was offered
+      assert(data);
+      assert(len == strlen(offeredData[1]) + 1);
+      assert(!strcmp(data, offeredData[1]));
+
+      test->state = FINISHED;
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest app = {puglNewWorld(PUGL_PROGRAM, 0),
+                  NULL,
+                  puglParseTestOptions(&argc, &argv),
+                  {0u, 0u},
+                  START};
+
+  // Set up view
+  app.view = puglNewView(app.world);
+  puglSetClassName(app.world, "PuglTest");
+  puglSetWindowTitle(app.view, "Pugl Lazy Copy/Paste Test");
+  puglSetBackend(app.view, puglStubBackend());
+  puglSetHandle(app.view, &app);
+  puglSetEventFunc(app.view, onEvent);
+  puglSetSizeHint(app.view, PUGL_DEFAULT_SIZE, 512, 512);
+
+  // Create and show window
+  assert(!puglRealize(app.view));
+  assert(!puglShow(app.view));
+
+  // Run until the test is finished
+  while (app.state != FINISHED) {
+    assert(!puglUpdate(app.world, 1 / 15.0));
+  }
+
+  puglFreeView(app.view);
+  puglFreeWorld(app.world);
+
+  return 0;
+}
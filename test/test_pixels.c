@@ -0,0 +1,154 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests the pixels backend.
+
+  This checks that the pixel buffer covers the view, that only the exposed
+  region is damaged, and that the contents of the buffer persist between
+  exposes.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/pixels.h"
+#include "pugl/pugl.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static const uint32_t backgroundColor = 0xFF204080u;
+static const uint32_t exposeColor     = 0xFF80FF40u;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  PuglRect        damage;
+  unsigned        numExposures;
+} PuglTest;
+
+static uint32_t*
+getRow(const PuglPixelBuffer* const buffer, const PuglCoord y)
+{
+  uint8_t* const row = (uint8_t*)buffer->data + ((size_t)y * buffer->stride);
+
+  return (uint32_t*)(void*)row;
+}
+
+static void
+onExpose(PuglView* const view, const PuglExposeEvent* const event)
+{
+  PuglTest* const        test   = (PuglTest*)puglGetHandle(view);
+  PuglPixelBuffer* const buffer = (PuglPixelBuffer*)puglGetContext(view);
+  const PuglRect         frame  = puglGetFrame(view);
+
+  assert(buffer);
+  assert(buffer->data);
+  assert(buffer->width == frame.width);
+  assert(buffer->height == frame.height);
+  assert(buffer->stride >= (size_t)buffer->width * 4u);
+
+  // The damaged region covers the expose, and is within the buffer
+  const PuglRect damage = buffer->damage;
+  assert(damage.x <= event->x && damage.y <= event->y);
+  assert(damage.x + damage.width <= buffer->width);
+  assert(damage.y + damage.height <= buffer->height);
+
+  if (!test->numExposures) {
+    // Fill the whole buffer on the first expose
+    assert(damage.width == buffer->width && damage.height == buffer->height);
+    for (PuglCoord y = 0; y < (PuglCoord)buffer->height; ++y) {
+      uint32_t* const row = getRow(buffer, y);
+      for (PuglSpan x = 0u; x < buffer->width; ++x) {
+        row[x] = backgroundColor;
+      }
+    }
+  } else {
+    // Pixels outside the damaged region keep their colour from before
+    if (damage.x > 0 || damage.y > 0) {
+      assert(buffer->data[0] == backgroundColor);
+    }
+
+    // Fill only the damaged region
+    for (PuglCoord y = damage.y; y < damage.y + damage.height; ++y) {
+      uint32_t* const row = getRow(buffer, y);
+      for (PuglCoord x = damage.x; x < damage.x + damage.width; ++x) {
+        row[x] = exposeColor;
+      }
+    }
+  }
+
+  test->damage = damage;
+  ++test->numExposures;
+}
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    onExpose(view, &event->expose);
+  }
+
+  return PUGL_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest test = {puglNewWorld(PUGL_PROGRAM, 0),
+                   NULL,
+                   puglParseTestOptions(&argc, &argv),
+                   {0, 0, 0u, 0u},
+                   0u};
+
+  // Set up view
+  test.view = puglNewView(test.world);
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl Pixels Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglPixelsBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 256, 192);
+
+  // Show the view and wait until it's drawn
+  assert(!puglShow(test.view));
+  while (!test.numExposures) {
+    assert(!puglUpdate(test.world, -1.0));
+  }
+
+  // The buffer is only available while handling an expose
+  assert(!puglGetContext(test.view));
+
+  // Redraw a region that doesn't include the top left pixel
+  const PuglRect rect = {64, 32, 100, 50};
+  assert(!puglPostRedisplayRect(test.view, rect));
+  while (test.numExposures < 2u) {
+    assert(!puglUpdate(test.world, -1.0));
+  }
+
+  assert(test.damage.x <= rect.x);
+  assert(test.damage.y <= rect.y);
+  assert(test.damage.x + test.damage.width >= rect.x + rect.width);
+  assert(test.damage.y + test.damage.height >= rect.y + rect.height);
+
+  if (test.opts.verbose) {
+    fprintf(stderr, "Drew %u exposures\n", test.numExposures);
+  }
+
+  // Tear down
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  return 0;
+}
@@ -0,0 +1,192 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests remote views.
+
+  This runs a guest in a child process, and checks that its frames are shown
+  in the host view, that input events are forwarded to it in its own
+  coordinates, and that it is disconnected when the host is freed.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/pixels.h"
+#include "pugl/pugl.h"
+#include "pugl/remote.h"
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static const uint32_t firstColor  = 0xFF204080u;
+static const uint32_t secondColor = 0xFF80FF40u;
+
+static const PuglRect remoteFrame = {32, 16, 64u, 48u};
+
+// A point in the middle of the remote frame
+static const PuglCoord checkX = 64;
+static const PuglCoord checkY = 40;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglRemoteHost* host;
+  PuglTestOptions opts;
+  uint32_t        color; ///< Colour of the remote frame in the view
+} PuglTest;
+
+static uint32_t*
+getPixel(const PuglPixelBuffer* const buffer,
+         const PuglCoord              x,
+         const PuglCoord              y)
+{
+  uint8_t* const row = (uint8_t*)buffer->data + ((size_t)y * buffer->stride);
+
+  return (uint32_t*)(void*)row + x;
+}
+
+static PuglStatus
+onGuestEvent(PuglRemoteGuest* const guest, const PuglEvent* const event)
+{
+  uint32_t* const color = (uint32_t*)puglGetRemoteHandle(guest);
+
+  if (event->type == PUGL_CONFIGURE) {
+    assert(event->configure.width == remoteFrame.width);
+    assert(event->configure.height == remoteFrame.height);
+  } else if (event->type == PUGL_BUTTON_PRESS) {
+    // Events are relative to the remote view
+    assert(event->button.x == 8.0);
+    assert(event->button.y == 4.0);
+    *color = secondColor;
+    puglPostRemoteRedisplay(guest);
+  } else if (event->type == PUGL_EXPOSE) {
+    const PuglPixelBuffer* const buffer = puglGetRemoteBuffer(guest);
+    const PuglRect               damage = buffer->damage;
+
+    assert(buffer->width == remoteFrame.width);
+    assert(buffer->height == remoteFrame.height);
+    for (PuglCoord y = damage.y; y < damage.y + damage.height; ++y) {
+      for (PuglCoord x = damage.x; x < damage.x + damage.width; ++x) {
+        *getPixel(buffer, x, y) = *color;
+      }
+    }
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static int
+runGuest(const int socket)
+{
+  uint32_t               color = firstColor;
+  PuglRemoteGuest* const guest = puglNewRemoteGuest(socket);
+  PuglStatus             st    = PUGL_SUCCESS;
+
+  puglSetRemoteHandle(guest, &color);
+  puglSetRemoteEventFunc(guest, onGuestEvent);
+
+  // Run until the host disconnects
+  while (!(st = puglUpdateRemoteGuest(guest, -1.0))) {
+  }
+
+  puglFreeRemoteGuest(guest);
+  return st == PUGL_FAILURE ? 0 : 1;
+}
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    PuglPixelBuffer* const buffer = (PuglPixelBuffer*)puglGetContext(view);
+    assert(buffer);
+
+    // Draw the guest's latest frame, and check the middle of it
+    assert(!puglDrawRemote(test->host, buffer));
+    test->color = *getPixel(buffer, checkX, checkY);
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static void
+update(PuglTest* const test)
+{
+  assert(!puglUpdate(test->world, 0.0));
+  assert(!puglUpdateRemoteHost(test->host, 0.01));
+}
+
+int
+main(int argc, char** argv)
+{
+  int sockets[2] = {-1, -1};
+  assert(!socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+
+  // Start the guest
+  const pid_t pid = fork();
+  assert(pid >= 0);
+  if (!pid) {
+    close(sockets[0]);
+    return runGuest(sockets[1]);
+  }
+
+  close(sockets[1]);
+
+  PuglTest test = {puglNewWorld(PUGL_PROGRAM, 0),
+                   NULL,
+                   NULL,
+                   puglParseTestOptions(&argc, &argv),
+                   0u};
+
+  // Set up view
+  test.view = puglNewView(test.world);
+  test.host = puglNewRemoteHost(test.view, sockets[0]);
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl Remote Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglPixelsBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 128, 128);
+
+  // Show the view and wait until the first frame from the guest is drawn
+  assert(!puglShow(test.view));
+  assert(!puglSetRemoteFrame(test.host, remoteFrame));
+  while (test.color != firstColor) {
+    update(&test);
+  }
+
+  // Click in the remote view and wait until the guest redraws in response
+  PuglEvent press     = {{PUGL_BUTTON_PRESS, 0}};
+  press.button.x      = remoteFrame.x + 8.0;
+  press.button.y      = remoteFrame.y + 4.0;
+  press.button.button = 1u;
+  assert(!puglSendRemoteEvent(test.host, &press));
+  while (test.color != secondColor) {
+    update(&test);
+  }
+
+  // Tear down, which disconnects the guest so it exits cleanly
+  puglFreeRemoteHost(test.host);
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  int status = 0;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && !WEXITSTATUS(status));
+
+  return 0;
+}
@@ -0,0 +1,195 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests pasting the same clipboard contents from another view several times.
+
+  The paster view prefetches the clipboard, and the clipboard contents don't
+  change between pastes, so pastes after the first may be completed from a
+  cache.  The time taken by each paste is printed when run with -v.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/pugl.h"
+#include "pugl/stub.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const uintptr_t copierTimerId = 1u;
+static const uintptr_t pasterTimerId = 2u;
+static const unsigned  numPastes     = 4u;
+
+typedef enum {
+  START,
+  COPIED,
+  PASTED,
+  RECEIVED_OFFER,
+  RECEIVED_DATA,
+  FINISHED,
+} State;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       copierView;
+  PuglView*       pasterView;
+  PuglTestOptions opts;
+  double          pasteTime;
+  unsigned        numPasted;
+  State           state;
+  bool            copierStarted;
+  bool            pasterStarted;
+} PuglTest;
+
+static PuglStatus
+onCopierEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Copier Event: ", true);
+  }
+
+  switch (event->type) {
+  case PUGL_EXPOSE:
+    if (!test->copierStarted) {
+      // Start timer on first expose
+      assert(!puglStartTimer(view, copierTimerId, 1 / 15.0));
+      test->copierStarted = true;
+    }
+    break;
+
+  case PUGL_TIMER:
+    assert(event->timer.id == copierTimerId);
+
+    if (test->state < COPIED) {
+      puglSetClipboard(
+        view, "text/plain", "Copied Text", strlen("Copied Text") + 1);
+
+      test->state = COPIED;
+    }
+
+    break;
+
+  default:
+    break;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static PuglStatus
+onPasterEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Paster Event: ", true);
+  }
+
+  switch (event->type) {
+  case PUGL_EXPOSE:
+    if (!test->pasterStarted) {
+      // Start timer on first expose
+      assert(!puglStartTimer(view, pasterTimerId, 1 / 60.0));
+      test->pasterStarted = true;
+    }
+    break;
+
+  case PUGL_TIMER:
+    assert(event->timer.id == pasterTimerId);
+    if (test->state == COPIED || test->state == RECEIVED_DATA) {
+      test->state     = PASTED;
+      test->pasteTime = puglGetTime(test->world);
+      assert(!puglPaste(view));
+    }
+    break;
+
+  case PUGL_DATA_OFFER:
+    if (test->state == PASTED) {
+      test->state = RECEIVED_OFFER;
+
+      assert(!puglAcceptOffer(view, &event->offer, 0));
+    }
+    break;
+
+  case PUGL_DATA:
+    if (test->state == RECEIVED_OFFER) {
+      size_t      len  = 0;
+      const char* text = (const char*)puglGetClipboard(view, 0, &len);
+
+      // Check that the offered data is what was copied
+      assert(text);
+      assert(!strcmp(text, "Copied Text"));
+
+      if (test->opts.verbose) {
+        fprintf(stderr,
+                "Paste %u took %f seconds\n",
+                test->numPasted,
+                puglGetTime(test->world) - test->pasteTime);
+      }
+
+      test->state = (++test->numPasted == numPastes) ? FINISHED : RECEIVED_DATA;
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest app = {puglNewWorld(PUGL_PROGRAM, 0),
+                  NULL,
+                  NULL,
+                  puglParseTestOptions(&argc, &argv),
+                  0.0,
+                  0u,
+                  START,
+                  false,
+                  false};
+
+  // Set up copier view
+  app.copierView = puglNewView(app.world);
+  puglSetClassName(app.world, "PuglTest");
+  puglSetWindowTitle(app.copierView, "Pugl Copy Test");
+  puglSetBackend(app.copierView, puglStubBackend());
+  puglSetHandle(app.copierView, &app);
+  puglSetEventFunc(app.copierView, onCopierEvent);
+  puglSetSizeHint(app.copierView, PUGL_DEFAULT_SIZE, 256, 256);
+
+  // Set up paster view
+  app.pasterView = puglNewView(app.world);
+  puglSetWindowTitle(app.pasterView, "Pugl Repeated Paste Test");
+  puglSetBackend(app.pasterView, puglStubBackend());
+  puglSetHandle(app.pasterView, &app);
+  puglSetEventFunc(app.pasterView, onPasterEvent);
+  puglSetViewHint(app.pasterView, PUGL_PREFETCH_CLIPBOARD, PUGL_TRUE);
+  puglSetSizeHint(app.pasterView, PUGL_DEFAULT_SIZE, 256, 256);
+
+  // Create and show both views
+  assert(!puglShow(app.copierView));
+  assert(!puglShow(app.pasterView));
+
+  // Run until the test is finished
+  while (app.state != FINISHED) {
+    assert(!puglUpdate(app.world, 1 / 60.0));
+  }
+
+  puglFreeView(app.copierView);
+  puglFreeView(app.pasterView);
+  puglFreeWorld(app.world);
+
+  return 0;
+}
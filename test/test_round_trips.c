@@ -0,0 +1,123 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests that common operations don't make synchronous requests to X.
+
+  This uses the internal X11 round trip counter to check that redrawing
+  doesn't wait for the server, and the request serial numbers from Xlib to
+  check that setting and getting the clipboard doesn't either.  The number of
+  round trips made by each update is printed when run with -v.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+#include "x11.h"
+
+#include "pugl/pugl.h"
+#include "pugl/stub.h"
+
+#include <X11/Xlib.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+static const unsigned numIterations = 16u;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  size_t          numExposures;
+} PuglTest;
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    ++test->numExposures;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static void
+update(PuglTest* const test)
+{
+  assert(!puglUpdate(test->world, 0.0));
+
+  if (test->opts.verbose) {
+    fprintf(stderr,
+            "Update made %zu round trips\n",
+            puglX11GetNumRoundTrips(test->world));
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglWorld* const      world = puglNewWorld(PUGL_PROGRAM, 0);
+  PuglView* const       view  = puglNewView(world);
+  const PuglTestOptions opts  = puglParseTestOptions(&argc, &argv);
+  PuglTest              test  = {world, view, opts, 0u};
+
+  Display* const display = (Display*)puglGetNativeWorld(world);
+
+  // Set up and show view
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl Round Trip Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglStubBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 256, 256);
+  assert(!puglShow(test.view));
+
+  // Drive event loop until the view gets exposed
+  while (!test.numExposures) {
+    update(&test);
+  }
+
+  // Set the clipboard once, which may intern the type
+  const char* const text = "Copied Text";
+  assert(!puglSetClipboard(test.view, "text/plain", text, strlen(text) + 1));
+  update(&test);
+
+  for (unsigned i = 0u; i < numIterations; ++i) {
+    /* Set and get the clipboard again, and check that the server hasn't
+       replied to any request made meanwhile, since no events are read here
+       unless Xlib waits for a reply. */
+    const unsigned long nextRequest = XNextRequest(display);
+    assert(!puglSetClipboard(test.view, "text/plain", text, strlen(text) + 1));
+
+    size_t            len  = 0u;
+    const char* const data = (const char*)puglGetClipboard(view, 0u, &len);
+    assert(data);
+    assert(len == strlen(text) + 1);
+    assert(!strcmp(data, text));
+    assert(LastKnownRequestProcessed(display) < nextRequest);
+
+    // Redraw the view, and check that the updates didn't need round trips
+    const size_t numExposures = test.numExposures;
+    assert(!puglPostRedisplay(test.view));
+    while (test.numExposures == numExposures) {
+      update(&test);
+      assert(!puglX11GetNumRoundTrips(test.world));
+    }
+  }
+
+  // Tear down
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  return 0;
+}
@@ -254,6 +254,14 @@ puglViewHintString(const PuglViewHint hint)
     return "Ignore key repeat";
   case PUGL_REFRESH_RATE:
     return "Refresh rate";
+  case PUGL_PREFETCH_CLIPBOARD:
+    return "Prefetch clipboard";
+  case PUGL_ADAPTIVE_SWAP:
+    return "Adaptive swap";
+  case PUGL_RENDER_THREAD:
+    return "Render thread";
+  case PUGL_DRAW_TIMING:
+    return "Draw timing";
   case PUGL_NUM_VIEW_HINTS:
     break;
   }
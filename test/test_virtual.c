@@ -0,0 +1,177 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests virtual views.
+
+  This checks that virtual views receive configure, map, and unmap events when
+  they are changed, and that exposing the parent exposes the visible virtual
+  views in their own coordinates.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/pugl.h"
+#include "pugl/stub.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __APPLE__
+static const double timeout = 1 / 60.0;
+#else
+static const double timeout = -1.0;
+#endif
+
+typedef struct {
+  PuglRect        frame;        ///< Last configured frame
+  PuglExposeEvent lastExpose;   ///< Last expose event
+  unsigned        numExposures; ///< Number of exposes received
+  bool            mapped;       ///< True if mapped
+} VirtualState;
+
+typedef struct {
+  PuglWorld*      world;
+  PuglView*       view;
+  PuglTestOptions opts;
+  unsigned        numExposures;
+} PuglTest;
+
+static PuglStatus
+onVirtualEvent(PuglVirtualView* const view, const PuglEvent* const event)
+{
+  VirtualState* const state = (VirtualState*)puglGetVirtualHandle(view);
+
+  switch (event->type) {
+  case PUGL_CONFIGURE:
+    state->frame.x      = event->configure.x;
+    state->frame.y      = event->configure.y;
+    state->frame.width  = event->configure.width;
+    state->frame.height = event->configure.height;
+    break;
+  case PUGL_MAP:
+    state->mapped = true;
+    break;
+  case PUGL_UNMAP:
+    state->mapped = false;
+    break;
+  case PUGL_EXPOSE:
+    state->lastExpose = event->expose;
+    ++state->numExposures;
+    break;
+  default:
+    break;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE) {
+    ++test->numExposures;
+  }
+
+  return PUGL_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglTest test = {puglNewWorld(PUGL_PROGRAM, 0),
+                   NULL,
+                   puglParseTestOptions(&argc, &argv),
+                   0u};
+
+  VirtualState left  = {{0, 0, 0u, 0u}, {PUGL_NOTHING, 0, 0, 0, 0u, 0u}, 0u, 0};
+  VirtualState right = {{0, 0, 0u, 0u}, {PUGL_NOTHING, 0, 0, 0, 0u, 0u}, 0u, 0};
+
+  // Set up view
+  test.view = puglNewView(test.world);
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl Virtual Test");
+  puglSetBackend(test.view, puglStubBackend());
+  puglSetHandle(test.view, &test);
+  puglSetEventFunc(test.view, onEvent);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 256, 256);
+
+  // Set up virtual views
+  PuglVirtualView* const leftView  = puglNewVirtualView(test.view);
+  PuglVirtualView* const rightView = puglNewVirtualView(test.view);
+  assert(leftView);
+  assert(rightView);
+  assert(puglGetVirtualParent(leftView) == test.view);
+  assert(!puglGetVirtualVisible(leftView));
+
+  puglSetVirtualHandle(leftView, &left);
+  puglSetVirtualHandle(rightView, &right);
+  assert(puglGetVirtualHandle(leftView) == &left);
+  assert(!puglSetVirtualEventFunc(leftView, onVirtualEvent));
+  assert(!puglSetVirtualEventFunc(rightView, onVirtualEvent));
+
+  // Setting the frame sends a configure event immediately
+  const PuglRect leftFrame  = {0, 0, 128u, 256u};
+  const PuglRect rightFrame = {128, 64, 128u, 128u};
+  assert(!puglSetVirtualFrame(leftView, leftFrame));
+  assert(!puglSetVirtualFrame(rightView, rightFrame));
+  assert(right.frame.x == rightFrame.x && right.frame.y == rightFrame.y);
+  assert(right.frame.width == rightFrame.width);
+  assert(right.frame.height == rightFrame.height);
+  assert(puglGetVirtualFrame(rightView).x == rightFrame.x);
+
+  // Showing sends a map event, but only the visible view is drawn
+  assert(!puglShowVirtualView(rightView));
+  assert(right.mapped && !left.mapped);
+  assert(puglGetVirtualVisible(rightView));
+
+  // Show the parent and wait until both it and the virtual view are drawn
+  assert(!puglShow(test.view));
+  while (!test.numExposures || !right.numExposures) {
+    assert(!puglUpdate(test.world, timeout));
+  }
+
+  assert(!left.numExposures);
+  assert(right.lastExpose.x >= 0 && right.lastExpose.y >= 0);
+  assert(right.lastExpose.x + right.lastExpose.width <= rightFrame.width);
+  assert(right.lastExpose.y + right.lastExpose.height <= rightFrame.height);
+
+  // Redisplaying part of the virtual view exposes it in its own coordinates
+  const PuglRect rect = {16, 8, 32u, 24u};
+  right.numExposures  = 0u;
+  assert(!puglPostVirtualRedisplayRect(rightView, rect));
+  while (!right.numExposures) {
+    assert(!puglUpdate(test.world, timeout));
+  }
+
+  assert(right.lastExpose.x <= rect.x && right.lastExpose.y <= rect.y);
+  assert(right.lastExpose.x + right.lastExpose.width >= rect.x + rect.width);
+  assert(right.lastExpose.y + right.lastExpose.height >= rect.y + rect.height);
+
+  // Hiding sends an unmap event
+  assert(!puglHideVirtualView(rightView));
+  assert(!right.mapped);
+  assert(!puglGetVirtualVisible(rightView));
+  assert(puglGrabVirtualFocus(rightView) == PUGL_FAILURE);
+
+  if (test.opts.verbose) {
+    fprintf(stderr, "Drew %u exposures\n", test.numExposures);
+  }
+
+  // Tear down, freeing one virtual view explicitly and one with the parent
+  puglFreeVirtualView(leftView);
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  return 0;
+}
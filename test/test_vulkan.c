@@ -185,6 +185,24 @@ main(int argc, char** argv)
   assert(puglGetInstanceProcAddrFunc(loader));
   assert(puglGetDeviceProcAddrFunc(loader));
 
+  // Check that the loader is shared by the world
+  PuglVulkanLoader* const sharedLoader = puglNewVulkanLoader(world);
+  assert(sharedLoader);
+#if !defined(_WIN32) && !defined(__APPLE__)
+  assert(sharedLoader == loader);
+#endif
+  puglFreeVulkanLoader(sharedLoader);
+  assert(puglGetInstanceProcAddrFunc(loader));
+
+  // Load global and instance function tables
+  PuglVulkanInstanceFunctions vk;
+  assert(!puglLoadVulkanInstanceFunctions(loader, VK_NULL_HANDLE, &vk));
+  assert(vk.vkCreateInstance);
+  assert(!vk.vkEnumeratePhysicalDevices);
+  assert(!puglLoadVulkanInstanceFunctions(loader, test.instance, &vk));
+  assert(vk.vkEnumeratePhysicalDevices);
+  assert(vk.vkDestroySurfaceKHR);
+
   // Show view and drive event loop until the view gets exposed
   puglShow(test.view);
   while (!test.exposed) {
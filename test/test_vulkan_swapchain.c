@@ -0,0 +1,321 @@
+// Copyright 2022 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Tests the Vulkan swapchain helper.
+
+  This draws several frames with empty submissions, then checks that the
+  swapchain is recreated after the view is resized or the swap interval is
+  changed.  It works with any Vulkan implementation that can present to a
+  window, including software ones like lavapipe.
+*/
+
+#undef NDEBUG
+
+#include "test_utils.h"
+
+#include "pugl/pugl.h"
+#include "pugl/vulkan.h"
+
+#include <vulkan/vulkan_core.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Vulkan allocation callbacks which can be used for debugging
+#define ALLOC_VK NULL
+
+// Helper macro for counted array arguments to make clang-format behave
+#define COUNTED(count, ...) count, __VA_ARGS__
+
+static const unsigned numFrames = 8u;
+
+typedef struct {
+  PuglWorld*                       world;
+  PuglView*                        view;
+  PuglSwapchain*                   swapchain;
+  VkInstance                       instance;
+  VkSurfaceKHR                     surface;
+  VkPhysicalDevice                 physicalDevice;
+  VkDevice                         device;
+  VkQueue                          queue;
+  const PuglVulkanDeviceFunctions* vk;
+  PuglTestOptions                  opts;
+  unsigned                         numRecreations;
+  unsigned                         numFramesDrawn;
+} PuglTest;
+
+static void
+onExpose(PuglTest* const test)
+{
+  PuglSwapchainImage image;
+  VkResult           r = puglAcquireSwapchainImage(test->swapchain, &image);
+  if (r == VK_NOT_READY) {
+    return;
+  }
+
+  assert(!r);
+  assert(image.image);
+  assert(image.imageView);
+  assert(image.extent.width > 0u && image.extent.height > 0u);
+  assert(image.imageIndex < image.numImages);
+  assert(image.frameIndex < 2u);
+  if (image.recreated) {
+    ++test->numRecreations;
+  }
+
+  // Submit nothing but the synchronization that a real frame would use
+  const VkPipelineStageFlags waitStage =
+    VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+  const VkSubmitInfo submitInfo = {
+    VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    NULL,
+    COUNTED(1u, &image.imageAvailable, &waitStage),
+    COUNTED(0u, NULL),
+    COUNTED(1u, &image.renderFinished),
+  };
+
+  assert(!test->vk->vkQueueSubmit(test->queue, 1u, &submitInfo, image.fence));
+  assert(!puglPresentSwapchainImage(test->swapchain, &image));
+  ++test->numFramesDrawn;
+}
+
+static PuglStatus
+onEvent(PuglView* const view, const PuglEvent* const event)
+{
+  PuglTest* const test = (PuglTest*)puglGetHandle(view);
+
+  if (test->opts.verbose) {
+    printEvent(event, "Event: ", true);
+  }
+
+  if (event->type == PUGL_EXPOSE && test->swapchain) {
+    onExpose(test);
+  }
+
+  return PUGL_SUCCESS;
+}
+
+static VkResult
+createInstance(PuglTest* const test)
+{
+  const VkApplicationInfo appInfo = {
+    VK_STRUCTURE_TYPE_APPLICATION_INFO,
+    NULL,
+    "Pugl Vulkan Swapchain Test",
+    VK_MAKE_VERSION(0, 1, 0),
+    "Pugl Vulkan Test Engine",
+    VK_MAKE_VERSION(0, 1, 0),
+    VK_MAKE_VERSION(1, 0, 0),
+  };
+
+  uint32_t           nExtensions = 0;
+  const char* const* extensions  = puglGetInstanceExtensions(&nExtensions);
+
+  const VkInstanceCreateInfo createInfo = {
+    VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+    NULL,
+    0,
+    &appInfo,
+    COUNTED(0, NULL),
+    COUNTED(nExtensions, extensions),
+  };
+
+  return vkCreateInstance(&createInfo, ALLOC_VK, &test->instance);
+}
+
+static VkResult
+createDevice(PuglTest* const test)
+{
+  // Use the first device with a queue family that can draw and present
+  uint32_t nDevices = 0u;
+  VkResult r        = VK_SUCCESS;
+  if ((r = vkEnumeratePhysicalDevices(test->instance, &nDevices, NULL))) {
+    return r;
+  }
+
+  VkPhysicalDevice* const devices =
+    (VkPhysicalDevice*)calloc(nDevices, sizeof(VkPhysicalDevice));
+
+  vkEnumeratePhysicalDevices(test->instance, &nDevices, devices);
+
+  uint32_t family = UINT32_MAX;
+  for (uint32_t d = 0u; d < nDevices && family == UINT32_MAX; ++d) {
+    uint32_t nFamilies = 0u;
+    vkGetPhysicalDeviceQueueFamilyProperties(devices[d], &nFamilies, NULL);
+
+    VkQueueFamilyProperties* const families = (VkQueueFamilyProperties*)calloc(
+      nFamilies, sizeof(VkQueueFamilyProperties));
+
+    vkGetPhysicalDeviceQueueFamilyProperties(devices[d], &nFamilies, families);
+
+    for (uint32_t f = 0u; f < nFamilies; ++f) {
+      VkBool32 supported = VK_FALSE;
+      vkGetPhysicalDeviceSurfaceSupportKHR(
+        devices[d], f, test->surface, &supported);
+
+      if (supported && (families[f].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+        test->physicalDevice = devices[d];
+        family               = f;
+        break;
+      }
+    }
+
+    free(families);
+  }
+
+  free(devices);
+  if (family == UINT32_MAX) {
+    return VK_ERROR_FEATURE_NOT_PRESENT;
+  }
+
+  const float       priority   = 1.0f;
+  const char* const extensions = "VK_KHR_swapchain";
+
+  const VkDeviceQueueCreateInfo queueInfo = {
+    VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+    NULL,
+    0,
+    family,
+    COUNTED(1u, &priority),
+  };
+
+  const VkDeviceCreateInfo createInfo = {
+    VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+    NULL,
+    0,
+    COUNTED(1u, &queueInfo),
+    COUNTED(0u, NULL),
+    COUNTED(1u, &extensions),
+    NULL,
+  };
+
+  if (!(r = vkCreateDevice(
+          test->physicalDevice, &createInfo, ALLOC_VK, &test->device))) {
+    vkGetDeviceQueue(test->device, family, 0u, &test->queue);
+  }
+
+  return r;
+}
+
+/// Redraw the view until at least the given number of frames are drawn
+static void
+drawFrames(PuglTest* const test, const unsigned count)
+{
+  const unsigned target = test->numFramesDrawn + count;
+
+  while (test->numFramesDrawn < target) {
+    assert(!puglPostRedisplay(test->view));
+    assert(!puglUpdate(test->world, 0.01));
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  PuglWorld* const        world  = puglNewWorld(PUGL_PROGRAM, 0);
+  PuglView* const         view   = puglNewView(world);
+  PuglVulkanLoader* const loader = puglNewVulkanLoader(world);
+  const PuglTestOptions   opts   = puglParseTestOptions(&argc, &argv);
+
+  PuglTest test = {world,
+                   view,
+                   NULL,
+                   VK_NULL_HANDLE,
+                   VK_NULL_HANDLE,
+                   VK_NULL_HANDLE,
+                   VK_NULL_HANDLE,
+                   VK_NULL_HANDLE,
+                   NULL,
+                   opts,
+                   0u,
+                   0u};
+
+  // Create Vulkan instance
+  assert(loader);
+  assert(!createInstance(&test));
+
+  // Create window
+  puglSetClassName(test.world, "PuglTest");
+  puglSetWindowTitle(test.view, "Pugl Vulkan Swapchain Test");
+  puglSetHandle(test.view, &test);
+  puglSetBackend(test.view, puglVulkanBackend());
+  puglSetEventFunc(test.view, onEvent);
+  puglSetViewHint(test.view, PUGL_RESIZABLE, PUGL_TRUE);
+  puglSetViewHint(test.view, PUGL_SWAP_INTERVAL, 1);
+  puglSetSizeHint(test.view, PUGL_DEFAULT_SIZE, 256, 256);
+  assert(!puglRealize(test.view));
+
+  // Create Vulkan surface, device, and swapchain
+  assert(!puglCreateSurface(puglGetInstanceProcAddrFunc(loader),
+                            test.view,
+                            test.instance,
+                            ALLOC_VK,
+                            &test.surface));
+
+  assert(!createDevice(&test));
+
+  // Load device functions to call the driver directly
+  PuglVulkanDeviceFunctions vk;
+  assert(!puglLoadVulkanDeviceFunctions(loader, test.device, &vk));
+  assert(vk.vkQueueSubmit);
+  assert(vk.vkCreateSwapchainKHR);
+  test.vk = &vk;
+
+  const PuglSwapchainInfo info = {
+    puglGetInstanceProcAddrFunc(loader),
+    test.instance,
+    test.physicalDevice,
+    test.device,
+    test.queue,
+    test.surface,
+    ALLOC_VK,
+    {VK_FORMAT_UNDEFINED, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR},
+    0u,
+    2u,
+  };
+
+  assert(!puglCreateSwapchain(test.view, &info, &test.swapchain));
+  assert(puglGetSwapchainFormat(test.swapchain).format != VK_FORMAT_UNDEFINED);
+
+  // Show view and draw several frames, which creates the swapchain once
+  assert(!puglShow(test.view));
+  drawFrames(&test, numFrames);
+  assert(test.numRecreations == 1u);
+  assert(puglGetViewHint(test.view, PUGL_SWAP_INTERVAL) == 1);
+
+  // Resize the view, which must recreate the swapchain
+  assert(!puglSetSize(test.view, 384u, 320u));
+  drawFrames(&test, numFrames);
+  assert(test.numRecreations >= 2u);
+
+  // Disable vertical sync, which must recreate the swapchain with a new mode
+  const unsigned numRecreations = test.numRecreations;
+  assert(!puglSetViewHint(test.view, PUGL_SWAP_INTERVAL, 0));
+  drawFrames(&test, numFrames);
+  assert(test.numRecreations > numRecreations);
+  assert(puglGetViewHint(test.view, PUGL_SWAP_INTERVAL) == 0 ||
+         puglGetViewHint(test.view, PUGL_SWAP_INTERVAL) == 1);
+
+  if (test.opts.verbose) {
+    fprintf(stderr,
+            "Drew %u frames with %u swapchain recreations\n",
+            test.numFramesDrawn,
+            test.numRecreations);
+  }
+
+  // Tear down
+  puglDestroySwapchain(test.swapchain);
+  vk.vkDestroyDevice(test.device, ALLOC_VK);
+  vkDestroySurfaceKHR(test.instance, test.surface, ALLOC_VK);
+  vkDestroyInstance(test.instance, ALLOC_VK);
+  puglFreeVulkanLoader(loader);
+  puglFreeView(test.view);
+  puglFreeWorld(test.world);
+
+  return 0;
+}